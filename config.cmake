@@ -111,24 +111,193 @@ config_string(
   KernelBootThreadTimeSlice BOOT_THREAD_TIME_SLICE
   "Number of milliseconds until the boot thread is preempted." DEFAULT 5 UNQUOTE
   DEPENDS "KernelIsMCS" UNDEF_DISABLED)
+config_option(
+  KernelReleaseQueueHeap RELEASE_QUEUE_HEAP
+  "Keep the MCS release queue in a pairing heap ordered by release time instead of a sorted \
+    list. Inserting a thread into the release queue takes constant time rather than time linear \
+    in the number of waiting threads, and removal takes amortised logarithmic time. Threads with \
+    equal release times are not guaranteed to be released in insertion order. This option is \
+    not verified."
+  DEFAULT OFF
+  DEPENDS "KernelIsMCS;NOT KernelVerificationBuild"
+  DEFAULT_DISABLED OFF)
+
+config_option(
+  KernelIPCQueuePriorityRuns IPC_QUEUE_PRIORITY_RUNS
+  "Link the first and last thread of each run of equal priority threads in MCS endpoint and \
+    notification queues. Blocking on an endpoint or notification then takes time linear in the \
+    number of distinct priorities queued, rather than in the number of queued threads, and \
+    dequeueing stays constant time. This option is not verified."
+  DEFAULT OFF
+  DEPENDS "KernelIsMCS;NOT KernelVerificationBuild"
+  DEFAULT_DISABLED OFF)
+
+config_option(
+  KernelEndpointBadgeIndex ENDPOINT_BADGE_INDEX
+  "Keep threads blocked sending with a badge in a kernel-wide hash table indexed by endpoint \
+    and badge. seL4_CNode_CancelBadgedSends then only visits the senders with the cancelled \
+    badge, instead of the whole send queue, and is preemptible. This adds two words to each TCB, \
+    which doubles the size of TCB objects on AArch64 together with \
+    KernelBenchmarksTrackUtilisation. This option is not verified."
+  DEFAULT OFF
+  DEPENDS "NOT KernelVerificationBuild"
+  DEFAULT_DISABLED OFF)
 config_string(
   KernelRetypeFanOutLimit RETYPE_FAN_OUT_LIMIT
   "Maximum number of objects that can be created in a single Retype() invocation." DEFAULT 256
   UNQUOTE)
+config_option(
+  KernelFastRevoke FAST_REVOKE
+  "Remove children of a revoked capability that are not final capabilities and have no \
+    architecture specific state by unlinking runs of them from the derivation tree, without \
+    finalising each of them. Also provide seL4_TCB_GetRevokeProgress, which returns how many \
+    capabilities a thread has removed in the revoke it is performing. The progress is kept in \
+    the TCB, which adds two words to each TCB. This doubles the size of TCB objects on AArch64 \
+    together with KernelBenchmarksTrackUtilisation. This option is not verified."
+  DEFAULT OFF
+  DEPENDS "NOT KernelVerificationBuild"
+  DEFAULT_DISABLED OFF)
+config_option(
+  KernelCapLookupCache CAP_LOOKUP_CACHE
+  "Give each node a small cache of the slots that capability pointers were last resolved to \
+    in the CSpace of the invoking thread, so that repeated lookups in deep CSpaces do not walk \
+    every CNode level. The cache is flushed whenever a CNode capability is added to, moved \
+    between or removed from slots. With KernelBenchmarksTrackUtilisation, the hits and misses \
+    of each node are reported with its utilisation. This option is not verified."
+  DEFAULT OFF
+  DEPENDS "NOT KernelVerificationBuild"
+  DEFAULT_DISABLED OFF)
+config_string(
+  KernelCapLookupCacheBits CAP_LOOKUP_CACHE_BITS
+  "Log2 of the number of entries in the capability lookup cache of each node."
+  DEFAULT 5 UNQUOTE
+  DEPENDS "KernelCapLookupCache" UNDEF_DISABLED)
+config_option(
+  KernelBulkRetype BULK_RETYPE
+  "Allow Retype() to create more than KernelRetypeFanOutLimit objects in one invocation. \
+    Such invocations link the new caps in a single pass and are preemptible, continuing \
+    after the objects already created when restarted. The progress of a preempted retype is \
+    kept in the TCB, which adds six words to each TCB. This doubles the size of TCB objects \
+    on AArch64, and on x86_64 together with KernelBenchmarksTrackUtilisation and either \
+    KernelEndpointBadgeIndex or KernelFastRevoke. This option is not verified."
+  DEFAULT OFF
+  DEPENDS "NOT KernelVerificationBuild"
+  DEFAULT_DISABLED OFF)
 config_string(
   KernelMaxNumWorkUnitsPerPreemption MAX_NUM_WORK_UNITS_PER_PREEMPTION
   "Maximum number of work units (delete/revoke iterations) until the kernel checks for\
     pending interrupts (and preempts the currently running syscall if interrupts are pending)."
   DEFAULT 100
   UNQUOTE)
+config_option(
+  KernelPreemptionTimeBudget PREEMPTION_TIME_BUDGET
+  "Check for pending interrupts in long running operations once a time budget has passed \
+    since kernel entry or the last check, rather than after KernelMaxNumWorkUnitsPerPreemption \
+    work units. This bounds interrupt latency independently of the cost of each work unit, \
+    at the cost of reading the timer at every preemption point. With \
+    KernelBenchmarksTrackUtilisation, the longest time between checks is reported. \
+    This option is not verified."
+  DEFAULT OFF
+  DEPENDS "KernelIsMCS;NOT KernelVerificationBuild"
+  DEFAULT_DISABLED OFF)
+config_string(
+  KernelPreemptionTimeBudgetUs PREEMPTION_TIME_BUDGET_US
+  "Time in microseconds after which the kernel checks for pending interrupts in long \
+    running operations."
+  DEFAULT 10 UNQUOTE
+  DEPENDS "KernelPreemptionTimeBudget" UNDEF_DISABLED)
+config_option(
+  KernelUntypedBackgroundReset UNTYPED_BACKGROUND_RESET
+  "Provide the seL4_Untyped_QueueReset invocation, which queues an untyped object without \
+    children to be cleared by the kernel whenever a node is about to switch to its idle \
+    thread. Clearing stops when an interrupt is pending or another node waits for the kernel \
+    lock, and a later seL4_Untyped_Retype only clears what is left. This option is not verified."
+  DEFAULT OFF
+  DEPENDS "NOT KernelVerificationBuild"
+  DEFAULT_DISABLED OFF)
 config_string(
   KernelResetChunkBits RESET_CHUNK_BITS
   "Maximum size in bits of chunks of memory to zero before checking a preemption point." DEFAULT 8
   UNQUOTE)
+config_option(
+  KernelFastClearMemory FAST_CLEAR_MEMORY
+  "Clear memory with architecture specific instructions where the CPU provides them: \
+    DC ZVA on AArch64 and rep stosb on x86 CPUs with enhanced rep stosb, both probed at boot, \
+    and cbo.zero on RISC-V with KernelRiscvZicboz. On x86-64, untyped memory is reset with \
+    non-temporal stores that do not fill the cache. With KernelEnableBenchmarks, \
+    seL4_BenchmarkClearMemory times each method. This option is not verified."
+  DEFAULT OFF
+  DEPENDS "NOT KernelVerificationBuild"
+  DEFAULT_DISABLED OFF)
 config_string(KernelMaxNumBootinfoUntypedCaps MAX_NUM_BOOTINFO_UNTYPED_CAPS
               "Max number of bootinfo untyped caps" DEFAULT 230 UNQUOTE)
 config_option(KernelFastpath FASTPATH "Enable IPC fastpath" DEFAULT ON)
 
+config_string(
+  KernelFastpathLookupMaxDepth FASTPATH_LOOKUP_MAX_DEPTH
+  "Maximum number of CNodes the fastpath resolves a capability pointer through. Deeper \
+    lookups are left to the slowpath. Setting this also removes the branch on an empty \
+    guard from each level of the fastpath lookup. This option is not verified."
+  DEFAULT 8 UNQUOTE
+  DEPENDS "KernelFastpath;NOT KernelVerificationBuild" UNDEF_DISABLED)
+
+config_option(
+  KernelBatchInvocation BATCH_INVOCATION
+  "Add the seL4_BatchInvoke system call, which performs a batch of capability invocations \
+    held in the IPC buffer with a single kernel entry. Records are performed in order with \
+    preemption points between them and the batch stops at the first record that fails. \
+    This is not verified."
+  DEFAULT OFF
+  DEPENDS "NOT KernelVerificationBuild"
+  DEFAULT_DISABLED OFF)
+
+config_option(
+  KernelFrameRangeInvocations FRAME_RANGE_INVOCATIONS
+  "Add the MapFrames and UnmapFrames page table invocations, which map or unmap a run of \
+    small frame capabilities from a CNode window at consecutive virtual addresses covered by \
+    a single page table. The table is walked once and TLB and cache maintenance is done once \
+    for the whole run. Supported on AArch64, x86_64 and RISC-V. This is not verified."
+  DEFAULT OFF
+  DEPENDS "NOT KernelVerificationBuild;KernelSel4ArchAarch64 OR KernelSel4ArchX86_64 OR KernelArchRiscV"
+  DEFAULT_DISABLED OFF)
+
+config_option(
+  KernelTLBBatching TLB_BATCHING
+  "Defer the TLB invalidations of pages that are unmapped during a capability invocation \
+    and issue them together when the invocation completes, as a range invalidation where \
+    possible. Supported on AArch64 and x86_64. This is not verified."
+  DEFAULT OFF
+  DEPENDS "NOT KernelVerificationBuild;KernelSel4ArchAarch64 OR KernelSel4ArchX86_64"
+  DEFAULT_DISABLED OFF)
+
+config_string(
+  KernelTLBFlushASIDThreshold TLB_FLUSH_ASID_THRESHOLD
+  "Number of pages above which a range TLB invalidation is replaced by an invalidation \
+    of the whole address space. With KernelArmTLBIRange, ranges that can be encoded in \
+    TLBI range operations are never replaced."
+  DEFAULT 64 UNQUOTE
+  DEPENDS "KernelTLBBatching" UNDEF_DISABLED)
+
+config_option(
+  KernelArmTLBIRange ARM_TLBI_RANGE
+  "Use the TLBI range operations of ARMv8.4 (FEAT_TLBIRANGE) for range TLB invalidations. \
+    Only enable this for CPUs that implement the feature."
+  DEFAULT OFF
+  DEPENDS "KernelTLBBatching;KernelSel4ArchAarch64;NOT KernelArmHypervisorSupport"
+  DEFAULT_DISABLED OFF)
+
+config_option(
+  KernelFPULazySwitch FPU_LAZY_SWITCH
+  "Switch the FPU state of threads lazily. A context switch to a thread that does not own \
+    the FPU leaves the FPU disabled, and the state is switched when the thread first uses \
+    the FPU. Where the hardware tracks whether the FPU state was modified, unmodified state \
+    is not saved. Supported on AArch64 without hypervisor support, on x86_64 without VT-x, \
+    and on RISC-V. This is not verified."
+  DEFAULT OFF
+  DEPENDS
+    "NOT KernelVerificationBuild;KernelHaveFPU;KernelSel4ArchAarch64 OR KernelSel4ArchX86_64 OR KernelArchRiscV;NOT KernelArmHypervisorSupport;NOT KernelVTX"
+  DEFAULT_DISABLED OFF)
+
 config_option(KernelExceptionFastpath EXCEPTION_FASTPATH "Enable exception fastpath" DEFAULT OFF
               DEPENDS "NOT KernelVerificationBuild; KernelSel4ArchAarch64")
 
@@ -157,6 +326,15 @@ else()
   config_set(KernelEnableSMPSupport ENABLE_SMP_SUPPORT OFF)
 endif()
 
+config_option(
+  KernelFastpathCrossCore FASTPATH_CROSS_CORE
+  "Allow the IPC fastpath to deliver a message to a thread with affinity to another \
+    core. The receiving thread is placed in the ready queue of its own core and a \
+    single reschedule IPI is sent if required, instead of falling back to the slowpath."
+  DEFAULT OFF
+  DEPENDS "KernelFastpath;KernelEnableSMPSupport;NOT KernelIsMCS;NOT KernelVerificationBuild"
+  DEFAULT_DISABLED OFF)
+
 config_string(
   KernelStackBits
   KERNEL_STACK_BITS
@@ -237,6 +415,68 @@ else()
   config_set(KernelLogBuffer KERNEL_LOG_BUFFER OFF)
 endif()
 
+config_option(
+  KernelBenchmarksEntryHistograms BENCHMARK_ENTRY_HISTOGRAMS
+  "Instead of logging a record for every kernel entry, keep log2 histograms of kernel entry \
+    latency in the log buffer. Histograms are keyed on syscall number, cap type, invocation \
+    label and fastpath or slowpath, so memory use stays constant and tracking can run \
+    indefinitely. Histograms are read with seL4_BenchmarkGetHistogram or directly from the \
+    log buffer."
+  DEFAULT OFF
+  DEPENDS "KernelBenchmarksTrackKernelEntries"
+  DEFAULT_DISABLED OFF)
+
+config_option(
+  KernelBenchmarksLockContention BENCHMARK_LOCK_CONTENTION
+  "Count, for each node, the cycles spent waiting for and holding the kernel lock and the \
+    number of times it is taken, by kernel entry type, as well as the cycles spent servicing \
+    remote calls while waiting. The counters are read with seL4_BenchmarkGetLockContention."
+  DEFAULT OFF
+  DEPENDS "KernelEnableBenchmarks;KernelEnableSMPSupport"
+  DEFAULT_DISABLED OFF)
+
+config_option(
+  KernelBenchmarksFastpathExits BENCHMARK_FASTPATH_EXITS
+  "Count, for each node, the times each check of the fastpath fails and sends a kernel \
+    entry to the slowpath. The counters are read with seL4_BenchmarkGetFastpathExits."
+  DEFAULT OFF
+  DEPENDS "KernelEnableBenchmarks;KernelFastpath"
+  DEFAULT_DISABLED OFF)
+
+config_option(
+  KernelBenchmarksVCPUSwitch BENCHMARK_VCPU_SWITCH
+  "Count, for each VCPU, the times its state is loaded, saved and re-enabled, the VGIC \
+    list registers and system registers moved, and the cycles spent switching to it. \
+    The counters are read with seL4_BenchmarkGetVCPUSwitchStats."
+  DEFAULT OFF
+  DEPENDS "KernelEnableBenchmarks;KernelArmHypervisorSupport"
+  DEFAULT_DISABLED OFF)
+
+config_option(
+  KernelLogBufferPerNode LOG_BUFFER_PER_NODE
+  "Give each node its own kernel log buffer and log index, so that nodes log without \
+    sharing any state. The buffer of a node is set with seL4_BenchmarkSetNodeLogBuffer and \
+    accessed through the kernel window, so it cannot be a device frame. Trace point records \
+    include their start time so that the logs of all nodes can be merged with \
+    tools/merge_log_buffers.py."
+  DEFAULT OFF
+  DEPENDS
+    "KernelLogBuffer;KernelEnableSMPSupport;NOT KernelBenchmarksEntryHistograms;KernelSel4ArchAarch64 OR KernelSel4ArchX86_64 OR KernelSel4ArchRiscV64"
+  DEFAULT_DISABLED OFF)
+
+config_option(
+  KernelFineGrainedLocking FINE_GRAINED_LOCKING
+  "Allow the IPC fastpath to run concurrently on different cores. The fastpath takes \
+    the big kernel lock in shared mode and protects endpoint queues with per-object \
+    locks, so that independent IPC between threads on different cores does not \
+    serialise. All other kernel entries, and any fastpath that falls back to the \
+    slowpath, take the big kernel lock exclusively. This is experimental and not \
+    supported with MCS or with benchmarks that keep global per-entry state."
+  DEFAULT OFF
+  DEPENDS
+    "KernelEnableSMPSupport;KernelFastpath;NOT KernelIsMCS;NOT KernelVerificationBuild;KernelBenchmarksNone OR KernelBenchmarksGeneric"
+  DEFAULT_DISABLED OFF)
+
 config_string(
   KernelMaxNumTracePoints
   MAX_NUM_TRACE_POINTS
@@ -41,11 +41,24 @@
  */
 #define irq_remote_call_ipi        0
 #define irq_reschedule_ipi         1
+#ifdef CONFIG_ARM_VCPU_INJECT_FASTPATH
+/* Load the IRQs injected by other cores into the VGIC of the current VCPU */
+#define irq_vcpu_inject_ipi        2
+#endif
 #endif /* ENABLE_SMP_SUPPORT */
 
 word_t PURE getRestartPC(tcb_t *thread);
 void setNextPC(tcb_t *thread, word_t v);
 
+#ifdef CONFIG_FAST_CLEAR_MEMORY
+#define DCZID_DZP     BIT(4)
+#define DCZID_BS_MASK MASK(4)
+
+/* Log2 of the number of bytes DC ZVA clears, or 0 if it is prohibited. This
+ * is probed at boot and the same on all cores. */
+extern word_t armKSDCZVABlockBits;
+#endif
+
 static inline word_t getProcessorID(void)
 {
     word_t processor_id;
@@ -256,6 +269,53 @@ static inline void invalidateLocalTLB_VAASID(word_t mva_plus_asid)
     isb();
 }
 
+#ifdef CONFIG_TLB_BATCHING
+/* TLBI range operand fields for the 4K translation granule */
+#define TLBI_RANGE_TG_4K            (1ul << 46)
+#define TLBI_RANGE_SCALE_SHIFT      44
+#define TLBI_RANGE_NUM_SHIFT        39
+#define TLBI_RANGE_NUM_BITS         5
+/* A run of fewer pages than this can be invalidated with one operation per scale */
+#define TLBI_RANGE_MAX_PAGES        BIT(4 * TLBI_RANGE_NUM_BITS + 1)
+
+/* Invalidate a run of pages given in the same format as for
+ * invalidateLocalTLB_VAASID, with a single barrier for the whole run. */
+static inline void invalidateLocalTLB_RangeVAASID(word_t mva_plus_asid, word_t pages)
+{
+    dsb();
+#ifdef CONFIG_ARM_TLBI_RANGE
+    assert(pages < TLBI_RANGE_MAX_PAGES);
+
+    /* A range operation covers (NUM + 1) * 2^(5 * SCALE + 1) pages, so an odd
+     * page has to be invalidated on its own. The rest is covered with at most
+     * one range operation per scale. */
+    if (pages & 1) {
+        asm volatile("tlbi vae1, %0" : : "r"(mva_plus_asid));
+        mva_plus_asid++;
+        pages--;
+    }
+    for (word_t scale = 0; pages > 0; scale++) {
+        word_t shift = TLBI_RANGE_NUM_BITS * scale + 1;
+        word_t num = (pages >> shift) & MASK(TLBI_RANGE_NUM_BITS);
+        if (num != 0) {
+            /* tlbi rvae1, which older assemblers do not accept by name */
+            asm volatile("sys #0, c8, c6, #1, %0" : : "r"(mva_plus_asid | TLBI_RANGE_TG_4K |
+                                                         (scale << TLBI_RANGE_SCALE_SHIFT) |
+                                                         ((num - 1) << TLBI_RANGE_NUM_SHIFT)));
+            mva_plus_asid += num << shift;
+            pages -= num << shift;
+        }
+    }
+#else
+    for (word_t i = 0; i < pages; i++) {
+        asm volatile("tlbi vae1, %0" : : "r"(mva_plus_asid + i));
+    }
+#endif
+    dsb();
+    isb();
+}
+#endif /* CONFIG_TLB_BATCHING */
+
 /* Invalidate all stage 1 and stage 2 translations used at
  * EL1 with the current VMID which is specified by vttbr_el2 */
 static inline void invalidateLocalTLB_VMALLS12E1(void)
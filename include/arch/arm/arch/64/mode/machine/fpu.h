@@ -110,6 +110,15 @@ static inline void enableFpuEL01(void)
      */
 }
 
+#ifdef CONFIG_FPU_LAZY_SWITCH
+/* The architecture does not track whether the FPU state was modified, so
+ * loaded state is always saved. */
+static inline bool_t isFpuStateDirty(tcb_t *thread)
+{
+    return true;
+}
+#endif
+
 /* Enable the FPU to be used without faulting.
  * Required even if the kernel attempts to use the FPU. */
 /** MODIFIES: phantom_machine_state */
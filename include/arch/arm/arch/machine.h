@@ -46,9 +46,25 @@ void cleanInvalidateL1Caches(void);
 /* Cleaning memory before user-level access. Does not flush cache. */
 static inline void clearMemory(word_t *ptr, word_t bits)
 {
+#if defined(CONFIG_ARCH_AARCH64) && defined(CONFIG_FAST_CLEAR_MEMORY)
+    /* DC ZVA zeroes whole cache lines without reading them first */
+    if (likely(armKSDCZVABlockBits != 0 && bits >= armKSDCZVABlockBits)) {
+        for (word_t p = (word_t)ptr; p < (word_t)ptr + BIT(bits); p += BIT(armKSDCZVABlockBits)) {
+            asm volatile("dc zva, %0" :: "r"(p) : "memory");
+        }
+        return;
+    }
+#endif
     memzero(ptr, BIT(bits));
 }
 
+/* Cleaning memory that the kernel does not expect to access soon. Does not
+ * flush cache. */
+static inline void clearMemory_NT(word_t *ptr, word_t bits)
+{
+    clearMemory(ptr, bits);
+}
+
 /* Cleaning memory before page table walker access */
 static inline void clearMemory_PT(word_t *ptr, word_t bits)
 {
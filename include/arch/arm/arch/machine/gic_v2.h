@@ -265,6 +265,16 @@ static inline uint32_t get_gic_vcpu_ctrl_eisr1(void)
     return gic_vcpu_ctrl->eisr1;
 }
 
+static inline uint32_t get_gic_vcpu_ctrl_elrsr0(void)
+{
+    return gic_vcpu_ctrl->elsr0;
+}
+
+static inline uint32_t get_gic_vcpu_ctrl_elrsr1(void)
+{
+    return gic_vcpu_ctrl->elsr1;
+}
+
 static inline uint32_t get_gic_vcpu_ctrl_misr(void)
 {
     return gic_vcpu_ctrl->misr;
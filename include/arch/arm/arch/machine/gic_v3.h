@@ -438,6 +438,20 @@ static inline uint32_t get_gic_vcpu_ctrl_eisr1(void)
     return 0;
 }
 
+static inline uint32_t get_gic_vcpu_ctrl_elrsr0(void)
+{
+    uint64_t reg;
+    MRS(ICH_ELRSR_EL2, reg);
+    /* 64 bit register read, top 32 bits reserved */
+    return reg;
+}
+
+/* Note: as for the EISR, a GICv3 has at most 16 list registers */
+static inline uint32_t get_gic_vcpu_ctrl_elrsr1(void)
+{
+    return 0;
+}
+
 static inline uint32_t get_gic_vcpu_ctrl_misr(void)
 {
     uint64_t reg;
@@ -30,6 +30,13 @@ static inline void invalidateTranslationASIDLocal(hw_asid_t hw_asid)
 #endif
 }
 
+#if defined(CONFIG_TLB_BATCHING) && !defined(CONFIG_ARM_HYPERVISOR_SUPPORT)
+static inline void invalidateTranslationRangeLocal(vptr_t vptr, word_t pages)
+{
+    invalidateLocalTLB_RangeVAASID(vptr, pages);
+}
+#endif
+
 static inline void invalidateTranslationAllLocal(void)
 {
     invalidateLocalTLB();
@@ -47,6 +54,14 @@ static inline void invalidateTranslationASID(hw_asid_t hw_asid)
     SMP_COND_STATEMENT(doRemoteInvalidateTranslationASID(hw_asid, MASK(CONFIG_MAX_NUM_NODES)));
 }
 
+#if defined(CONFIG_TLB_BATCHING) && !defined(CONFIG_ARM_HYPERVISOR_SUPPORT)
+static inline void invalidateTranslationRange(vptr_t vptr, word_t pages)
+{
+    invalidateTranslationRangeLocal(vptr, pages);
+    SMP_COND_STATEMENT(doRemoteInvalidateTranslationRange(vptr, pages, MASK(CONFIG_MAX_NUM_NODES)));
+}
+#endif
+
 static inline void invalidateTranslationAll(void)
 {
     invalidateTranslationAllLocal();
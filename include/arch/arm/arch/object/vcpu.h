@@ -12,6 +12,9 @@
 
 #include <api/failures.h>
 #include <linker.h>
+#ifdef CONFIG_BENCHMARK_VCPU_SWITCH
+#include <sel4/benchmark_vcpu_switch_types.h>
+#endif
 
 #define HCR_RW       BIT(31)     /* Execution state control        */
 #define HCR_TRVM     BIT(30)     /* trap reads of VM controls      */
@@ -87,6 +90,16 @@ struct vcpu {
      */
     struct vTimer virtTimer;
 #endif
+#ifdef CONFIG_BENCHMARK_VCPU_SWITCH
+    /* Costs of switching to and from this VCPU, see
+     * enum benchmark_vcpu_switch_stat */
+    uint64_t switchStats[BENCHMARK_VCPU_SWITCH_NUM_STATS];
+#endif
+#if defined(CONFIG_ARM_VCPU_INJECT_FASTPATH) && defined(ENABLE_SMP_SUPPORT)
+    /* List registers injected into vgic.lr by other cores, which the core of
+     * this VCPU has yet to load into its VGIC if this VCPU is loaded there. */
+    word_t pendingLRs;
+#endif
 };
 typedef struct vcpu vcpu_t;
 compile_assert(vcpu_size_correct, sizeof(struct vcpu) <= BIT(VCPU_SIZE_BITS))
@@ -121,23 +134,40 @@ exception_t decodeARMVCPUInvocation(
     word_t *buffer
 );
 
+#ifdef CONFIG_ARM_VCPU_INJECT_FASTPATH
+/* Maximum number of IRQs injected by an InjectIRQs invocation */
+#define VCPU_INJECT_IRQS_MAX 3
+#endif
+
 void vcpu_restore(vcpu_t *cpu);
 void vcpu_switch(vcpu_t *cpu);
 void vcpu_flush(void);
 void vcpu_flush_if_current(tcb_t *tptr);
 #ifdef ENABLE_SMP_SUPPORT
 void handleVCPUInjectInterruptIPI(vcpu_t *vcpu, unsigned long index, virq_t virq);
+#ifdef CONFIG_ARM_VCPU_INJECT_FASTPATH
+void handleVCPUInjectPendingIPI(void);
+#endif
 #endif /* ENABLE_SMP_SUPPORT */
+#ifdef CONFIG_ARM_VCPU_INJECT_FASTPATH
+word_t vcpu_decode_virqs(vcpu_t *vcpu, word_t count, const word_t *mrs, word_t *indexes, virq_t *virqs);
+#endif
 
 exception_t decodeVCPUWriteReg(cap_t cap, word_t length, word_t *buffer);
 exception_t decodeVCPUReadReg(cap_t cap, word_t length, bool_t call, word_t *buffer);
 exception_t decodeVCPUInjectIRQ(cap_t cap, word_t length, word_t *buffer);
+#ifdef CONFIG_ARM_VCPU_INJECT_FASTPATH
+exception_t decodeVCPUInjectIRQs(cap_t cap, word_t length, word_t *buffer);
+#endif
 exception_t decodeVCPUSetTCB(cap_t cap);
 exception_t decodeVCPUAckVPPI(cap_t cap, word_t length, word_t *buffer);
 
 exception_t invokeVCPUWriteReg(vcpu_t *vcpu, word_t field, word_t value);
 exception_t invokeVCPUReadReg(vcpu_t *vcpu, word_t field, bool_t call);
 exception_t invokeVCPUInjectIRQ(vcpu_t *vcpu, unsigned long index, virq_t virq);
+#ifdef CONFIG_ARM_VCPU_INJECT_FASTPATH
+exception_t invokeVCPUInjectIRQs(vcpu_t *vcpu, word_t count, const word_t *indexes, const virq_t *virqs);
+#endif
 exception_t invokeVCPUSetTCB(vcpu_t *vcpu, tcb_t *tcb);
 exception_t invokeVCPUAckVPPI(vcpu_t *vcpu, VPPIEventIRQ_t vppi);
 static word_t vcpu_hw_read_reg(word_t reg_index);
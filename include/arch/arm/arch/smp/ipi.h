@@ -14,6 +14,9 @@ typedef enum {
     IpiRemoteCall_InvalidateTranslationSingle,
     IpiRemoteCall_InvalidateTranslationASID,
     IpiRemoteCall_InvalidateTranslationAll,
+#if defined(CONFIG_TLB_BATCHING) && !defined(CONFIG_ARM_HYPERVISOR_SUPPORT)
+    IpiRemoteCall_InvalidateTranslationRange,
+#endif
     IpiRemoteCall_switchFpuOwner,
     IpiRemoteCall_MaskPrivateInterrupt,
 #ifdef CONFIG_ARM_GIC_V3_SUPPORT
@@ -37,6 +37,13 @@ static inline void doRemoteInvalidateTranslationAll(word_t mask)
     doRemoteMaskOp0Arg(IpiRemoteCall_InvalidateTranslationAll, mask);
 }
 
+#if defined(CONFIG_TLB_BATCHING) && !defined(CONFIG_ARM_HYPERVISOR_SUPPORT)
+static inline void doRemoteInvalidateTranslationRange(vptr_t vptr, word_t pages, word_t mask)
+{
+    doRemoteMaskOp2Arg(IpiRemoteCall_InvalidateTranslationRange, vptr, pages, mask);
+}
+#endif
+
 static inline void doRemoteMaskPrivateInterrupt(word_t cpu, word_t disable, word_t irq)
 {
     doRemoteOp2Arg(IpiRemoteCall_MaskPrivateInterrupt, disable, irq, cpu);
@@ -149,9 +149,25 @@ void setNextPC(tcb_t *thread, word_t v);
 /* Cleaning memory before user-level access. Does not flush cache. */
 static inline void clearMemory(void *ptr, unsigned int bits)
 {
+#if defined(CONFIG_FAST_CLEAR_MEMORY) && defined(CONFIG_RISCV_ZICBOZ)
+    if (likely(bits >= CONFIG_RISCV_CBOZ_BLOCK_BITS)) {
+        for (word_t p = (word_t)ptr; p < (word_t)ptr + BIT(bits); p += BIT(CONFIG_RISCV_CBOZ_BLOCK_BITS)) {
+            /* cbo.zero, encoded for assemblers without Zicboz */
+            asm volatile(".insn i 0x0f, 2, x0, %0, 4" :: "r"(p) : "memory");
+        }
+        return;
+    }
+#endif
     memzero(ptr, BIT(bits));
 }
 
+/* Cleaning memory that the kernel does not expect to access soon. Does not
+ * flush cache. */
+static inline void clearMemory_NT(void *ptr, unsigned int bits)
+{
+    clearMemory(ptr, bits);
+}
+
 static inline void write_satp(word_t value)
 {
     asm volatile("csrw satp, %0" :: "rK"(value));
@@ -169,9 +169,24 @@ static inline bool_t isFpuEnable(void)
     return isFPUEnabled[CURRENT_CPU_INDEX()];
 }
 
+#ifdef CONFIG_FPU_LAZY_SWITCH
+/* The FS field saved on kernel entry is dirty if the thread has written to the
+ * FPU registers since its state was loaded. */
+static inline bool_t isFpuStateDirty(tcb_t *thread)
+{
+    return (getRegister(thread, SSTATUS) & SSTATUS_FS) == SSTATUS_FS_DIRTY;
+}
+#endif
+
 static inline void set_tcb_fs_state(tcb_t *tcb, bool_t enabled)
 {
     word_t sstatus = getRegister(tcb, SSTATUS);
+#ifdef CONFIG_FPU_LAZY_SWITCH
+    /* Keep the dirty state until the FPU state has been saved */
+    if (enabled && (sstatus & SSTATUS_FS) == SSTATUS_FS_DIRTY) {
+        return;
+    }
+#endif
     sstatus &= ~SSTATUS_FS;
     if (enabled) {
         sstatus |= SSTATUS_FS_CLEAN;
@@ -198,6 +198,15 @@ static inline void invalidateLocalTranslationSingleASID(vptr_t vptr, asid_t asid
     invalidateLocalPCID(INVPCID_TYPE_ADDR, (void *)vptr, asid);
 }
 
+#ifdef CONFIG_TLB_BATCHING
+static inline void invalidateLocalTranslationRangeASID(vptr_t vptr, word_t pages, asid_t asid)
+{
+    for (word_t i = 0; i < pages; i++) {
+        invalidateLocalPCID(INVPCID_TYPE_ADDR, (void *)(vptr + (i << seL4_PageBits)), asid);
+    }
+}
+#endif
+
 static inline void invalidateLocalTranslationAll(void)
 {
     invalidateLocalPCID(INVPCID_TYPE_ALL_GLOBAL, (void *)0, 0);
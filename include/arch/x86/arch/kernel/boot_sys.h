@@ -19,6 +19,7 @@ typedef struct boot_state {
     uint32_t     num_drhu; /* number of IOMMUs */
     paddr_t      drhu_list[MAX_NUM_DRHU]; /* list of physical addresses of the IOMMUs */
     acpi_rmrr_list_t rmrr_list;
+    acpi_drhd_list_t drhd_list;
     acpi_rsdp_t  acpi_rsdp; /* copy of the rsdp */
     paddr_t      mods_end_paddr; /* physical address where boot modules end */
     paddr_t      boot_module_start; /* physical address of first boot module */
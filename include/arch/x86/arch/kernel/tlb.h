@@ -26,6 +26,14 @@ static inline void invalidateTranslationSingleASID(vptr_t vptr, asid_t asid, wor
     SMP_COND_STATEMENT(doRemoteInvalidateTranslationSingleASID(vptr, asid, mask));
 }
 
+#ifdef CONFIG_TLB_BATCHING
+static inline void invalidateTranslationRangeASID(vptr_t vptr, word_t pages, asid_t asid, word_t mask)
+{
+    invalidateLocalTranslationRangeASID(vptr, pages, asid);
+    SMP_COND_STATEMENT(doRemoteInvalidateTranslationRangeASID(vptr, pages, asid, mask));
+}
+#endif
+
 static inline void invalidateTranslationAll(word_t mask)
 {
     invalidateLocalTranslationAll();
@@ -360,9 +360,33 @@ static inline void x86_load_fsgs_base(tcb_t *thread, cpu_id_t cpu)
 /* Cleaning memory before user-level access. Does not flush cache. */
 static inline void clearMemory(void *ptr, unsigned int bits)
 {
+#ifdef CONFIG_FAST_CLEAR_MEMORY
+    if (likely(x86KSEnhancedRepStos)) {
+        word_t count = BIT(bits);
+        asm volatile("rep stosb" : "+D"(ptr), "+c"(count) : "a"(0) : "memory");
+        return;
+    }
+#endif
     memzero(ptr, BIT(bits));
 }
 
+/* Cleaning memory that the kernel does not expect to access soon. Does not
+ * flush cache. */
+static inline void clearMemory_NT(void *ptr, unsigned int bits)
+{
+#if defined(CONFIG_FAST_CLEAR_MEMORY) && defined(CONFIG_ARCH_X86_64)
+    /* Non-temporal stores bypass the cache, so clearing large regions does
+     * not evict the working set. They are weakly ordered and have to be
+     * fenced before the memory is used. */
+    for (word_t *p = ptr; p < (word_t *)ptr + BIT(bits) / sizeof(word_t); p++) {
+        asm volatile("movnti %1, %0" : "=m"(*p) : "r"((word_t)0));
+    }
+    asm volatile("sfence" ::: "memory");
+#else
+    clearMemory(ptr, bits);
+#endif
+}
+
 /* Initialises MSRs required to setup sysenter and sysexit */
 void init_sysenter_msrs(void);
 
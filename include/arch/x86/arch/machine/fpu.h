@@ -79,6 +79,15 @@ static inline void loadFpuState(const tcb_t *thread)
     }
 }
 
+#ifdef CONFIG_FPU_LAZY_SWITCH
+/* The architecture does not report whether the FPU state was modified. With
+ * XSAVEOPT and XSAVES, unmodified state components are not written back. */
+static inline bool_t isFpuStateDirty(tcb_t *thread)
+{
+    return true;
+}
+#endif
+
 /* Reset the FPU registers into their initial blank state. */
 static inline void finit(void)
 {
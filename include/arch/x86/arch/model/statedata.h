@@ -74,8 +74,11 @@ extern user_fpu_state_t x86KSnullFpuState ALIGN(MIN_FPU_ALIGNMENT);
 extern uint32_t x86KSnumDrhu;
 extern vtd_rte_t *x86KSvtdRootTable;
 extern uint32_t x86KSnumIOPTLevels;
+extern uint32_t x86KSnumIOSuperPageLevels;
 extern uint32_t x86KSnumIODomainIDBits;
 extern uint32_t x86KSFirstValidIODomain;
+extern acpi_drhd_list_t x86KSvtdDrhdList;
+extern vtd_inv_queue_t *x86KSvtdInvQueues;
 #endif
 
 #ifdef CONFIG_PRINTING
@@ -92,4 +95,8 @@ extern word_t x86KSAllocatedIOPorts[NUM_IO_PORTS / CONFIG_WORD_SIZE];
 extern uint32_t x86KStscMhz;
 extern uint32_t x86KSapicRatio;
 #endif
+#ifdef CONFIG_FAST_CLEAR_MEMORY
+/* Whether the CPU has enhanced rep movsb/stosb, probed at boot */
+extern bool_t x86KSEnhancedRepStos;
+#endif
 
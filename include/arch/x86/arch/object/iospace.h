@@ -33,6 +33,20 @@ struct lookupIOPTSlot_ret {
 };
 typedef struct lookupIOPTSlot_ret lookupIOPTSlot_ret_t;
 
+/* Invalidation descriptor of the VT-d invalidation queue */
+typedef struct vtd_inv_desc {
+    uint64_t lo;
+    uint64_t hi;
+} vtd_inv_desc_t;
+
+/* Invalidation queue of an IOMMU */
+typedef struct vtd_inv_queue {
+    vtd_inv_desc_t *desc;
+    word_t tail;
+    /* written by the IOMMU when it completes an invalidation wait descriptor */
+    volatile uint32_t status;
+} vtd_inv_queue_t;
+
 cap_t master_iospace_cap(void);
 exception_t decodeX86IOPTInvocation(word_t invLabel, word_t length, cte_t *slot, cap_t cap, word_t  *buffer);
 exception_t decodeX86IOMapInvocation(word_t length, cte_t *slot, cap_t cap, word_t *buffer);
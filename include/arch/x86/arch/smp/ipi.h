@@ -18,6 +18,9 @@ typedef enum {
     IpiRemoteCall_InvalidateTranslationSingle,
     IpiRemoteCall_InvalidateTranslationSingleASID,
     IpiRemoteCall_InvalidateTranslationAll,
+#ifdef CONFIG_TLB_BATCHING
+    IpiRemoteCall_InvalidateTranslationRangeASID,
+#endif
     IpiRemoteCall_switchFpuOwner,
     IpiNumArchRemoteCall
 } IpiRemoteCall_t;
@@ -40,6 +40,13 @@ static inline void doRemoteInvalidateTranslationAll(word_t mask)
     doRemoteMaskOp0Arg(IpiRemoteCall_InvalidateTranslationAll, mask);
 }
 
+#ifdef CONFIG_TLB_BATCHING
+static inline void doRemoteInvalidateTranslationRangeASID(vptr_t vptr, word_t pages, asid_t asid, word_t mask)
+{
+    doRemoteMaskOp3Arg(IpiRemoteCall_InvalidateTranslationRangeASID, vptr, pages, asid, mask);
+}
+#endif
+
 #ifdef CONFIG_VTX
 static inline void doRemoteClearCurrentVCPU(word_t cpu)
 {
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <config.h>
+#include <model/statedata.h>
 #include <arch/benchmark.h>
 #include <machine/io.h>
 #include <sel4/arch/constants.h>
@@ -21,6 +22,13 @@ exception_t handle_SysBenchmarkFinalizeLog(void);
 #ifdef CONFIG_KERNEL_LOG_BUFFER
 exception_t handle_SysBenchmarkSetLogBuffer(void);
 #endif /* CONFIG_KERNEL_LOG_BUFFER */
+#ifdef CONFIG_LOG_BUFFER_PER_NODE
+/* Stop logging to the given frame, which is being deleted. */
+void benchmark_release_log_buffer(word_t frame_pptr);
+#endif /* CONFIG_LOG_BUFFER_PER_NODE */
+#ifdef CONFIG_BENCHMARK_ENTRY_HISTOGRAMS
+exception_t handle_SysBenchmarkGetHistogram(void);
+#endif /* CONFIG_BENCHMARK_ENTRY_HISTOGRAMS */
 #ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
 exception_t handle_SysBenchmarkGetThreadUtilisation(void);
 exception_t handle_SysBenchmarkResetThreadUtilisation(void);
@@ -29,6 +37,21 @@ exception_t handle_SysBenchmarkDumpAllThreadsUtilisation(void);
 exception_t handle_SysBenchmarkResetAllThreadsUtilisation(void);
 #endif /* CONFIG_DEBUG_BUILD */
 #endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
+#ifdef CONFIG_BENCHMARK_LOCK_CONTENTION
+exception_t handle_SysBenchmarkGetLockContention(void);
+exception_t handle_SysBenchmarkResetLockContention(void);
+#endif /* CONFIG_BENCHMARK_LOCK_CONTENTION */
+#ifdef CONFIG_FAST_CLEAR_MEMORY
+exception_t handle_SysBenchmarkClearMemory(void);
+#endif /* CONFIG_FAST_CLEAR_MEMORY */
+#ifdef CONFIG_BENCHMARK_FASTPATH_EXITS
+exception_t handle_SysBenchmarkGetFastpathExits(void);
+exception_t handle_SysBenchmarkResetFastpathExits(void);
+#endif /* CONFIG_BENCHMARK_FASTPATH_EXITS */
+#ifdef CONFIG_BENCHMARK_VCPU_SWITCH
+exception_t handle_SysBenchmarkGetVCPUSwitchStats(void);
+exception_t handle_SysBenchmarkResetVCPUSwitchStats(void);
+#endif /* CONFIG_BENCHMARK_VCPU_SWITCH */
 #endif /* CONFIG_ENABLE_BENCHMARKS */
 
 #if CONFIG_MAX_NUM_TRACE_POINTS > 0
@@ -37,8 +60,15 @@ exception_t handle_SysBenchmarkResetAllThreadsUtilisation(void);
 
 #define MAX_LOG_SIZE (seL4_LogBufferSize / sizeof(benchmark_tracepoint_log_entry_t))
 
+#ifdef CONFIG_LOG_BUFFER_PER_NODE
+#define TRACE_POINT_ENTRIES NODE_STATE(ksEntries)
+#define TRACE_POINT_STARTED NODE_STATE(ksStarted)
+#else
 extern timestamp_t ksEntries[CONFIG_MAX_NUM_TRACE_POINTS];
 extern bool_t ksStarted[CONFIG_MAX_NUM_TRACE_POINTS];
+#define TRACE_POINT_ENTRIES ksEntries
+#define TRACE_POINT_STARTED ksStarted
+#endif /* CONFIG_LOG_BUFFER_PER_NODE */
 extern timestamp_t ksExit;
 extern seL4_Word ksLogIndex;
 extern seL4_Word ksLogIndexFinalized;
@@ -46,29 +76,38 @@ extern paddr_t ksUserLogBuffer;
 
 static inline void trace_point_start(word_t id)
 {
-    ksEntries[id] = timestamp();
-    ksStarted[id] = true;
+    TRACE_POINT_ENTRIES[id] = timestamp();
+    TRACE_POINT_STARTED[id] = true;
 }
 
 static inline void trace_point_stop(word_t id)
 {
-    benchmark_tracepoint_log_entry_t *ksLog = (benchmark_tracepoint_log_entry_t *) KS_LOG_PPTR;
+    benchmark_tracepoint_log_entry_t *ksLog = (benchmark_tracepoint_log_entry_t *) KS_LOG_BUFFER_PPTR;
+#ifdef CONFIG_LOG_BUFFER_PER_NODE
+    /* ksExit is shared by all nodes */
+    timestamp_t stop_time = timestamp();
+#else
     ksExit = timestamp();
+    timestamp_t stop_time = ksExit;
+#endif
 
-    if (likely(ksUserLogBuffer != 0)) {
-        if (likely(ksStarted[id])) {
-            ksStarted[id] = false;
-            if (likely(ksLogIndex < MAX_LOG_SIZE)) {
-                ksLog[ksLogIndex] = (benchmark_tracepoint_log_entry_t) {
-                    id, ksExit - ksEntries[id]
+    if (likely(KS_LOG_BUFFER_SET)) {
+        if (likely(TRACE_POINT_STARTED[id])) {
+            TRACE_POINT_STARTED[id] = false;
+            if (likely(KS_LOG_INDEX < MAX_LOG_SIZE)) {
+                ksLog[KS_LOG_INDEX] = (benchmark_tracepoint_log_entry_t) {
+                    id, stop_time - TRACE_POINT_ENTRIES[id],
+#ifdef CONFIG_LOG_BUFFER_PER_NODE
+                    TRACE_POINT_ENTRIES[id]
+#endif
                 };
             }
             /* increment the log index even if we have exceeded the log size
              * this is so we can tell if we need a bigger log */
-            ksLogIndex++;
+            KS_LOG_INDEX++;
         }
         /* If this fails integer overflow has occurred. */
-        assert(ksLogIndex > 0);
+        assert(KS_LOG_INDEX > 0);
     }
 }
 
@@ -19,6 +19,21 @@
 #define TRACK_KERNEL_ENTRIES 1
 extern kernel_entry_t ksKernelEntry;
 #ifdef CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES
+#ifdef CONFIG_BENCHMARK_ENTRY_HISTOGRAMS
+/**
+ *  Calculate the maximum number of histograms that can be kept,
+ *  limited by the log buffer size. This is also the number of ksLog entries.
+ *
+ */
+#define MAX_LOG_SIZE (seL4_LogBufferSize / \
+             sizeof(benchmark_track_histogram_t))
+
+/**
+ * @brief Clear all histograms, must be called whenever the log buffer changes
+ *
+ */
+void benchmark_track_reset_histograms(void);
+#else
 /**
  *  Calculate the maximum number of kernel entries that can be tracked,
  *  limited by the log buffer size. This is also the number of ksLog entries.
@@ -26,6 +41,7 @@ extern kernel_entry_t ksKernelEntry;
  */
 #define MAX_LOG_SIZE (seL4_LogBufferSize / \
              sizeof(benchmark_track_kernel_entry_t))
+#endif /* CONFIG_BENCHMARK_ENTRY_HISTOGRAMS */
 
 extern timestamp_t ksEnter;
 extern seL4_Word ksLogIndex;
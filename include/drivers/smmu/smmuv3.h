@@ -0,0 +1,228 @@
+/*
+ * Copyright 2026, UNSW
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#pragma once
+
+#include <plat/machine/devices_gen.h>
+
+/* The SMMUv3 register space is made of two 64K pages, both mapped by the
+ * hardware generator at SMMU_PPTR. Page 1 holds the event and PRI queue
+ * indexes. */
+#define SMMU_PAGE_64KB                           0x10000
+#define SMMU_PAGE1(reg)                          (SMMU_PAGE_64KB + (reg))
+
+/*page 0 registers*/
+#define SMMU_IDR0                                0x000
+#define SMMU_IDR1                                0x004
+#define SMMU_IDR5                                0x014
+#define SMMU_CR0                                 0x020
+#define SMMU_CR0ACK                              0x024
+#define SMMU_CR1                                 0x028
+#define SMMU_CR2                                 0x02c
+#define SMMU_GBPA                                0x044
+#define SMMU_IRQ_CTRL                            0x050
+#define SMMU_GERROR                              0x060
+#define SMMU_GERRORN                             0x064
+#define SMMU_STRTAB_BASE                         0x080
+#define SMMU_STRTAB_BASE_CFG                     0x088
+#define SMMU_CMDQ_BASE                           0x090
+#define SMMU_CMDQ_PROD                           0x098
+#define SMMU_CMDQ_CONS                           0x09c
+#define SMMU_EVENTQ_BASE                         0x0a0
+/*page 1 registers*/
+#define SMMU_EVENTQ_PROD                         SMMU_PAGE1(0x0a8)
+#define SMMU_EVENTQ_CONS                         SMMU_PAGE1(0x0ac)
+
+/*SMMU_IDR0*/
+#define IDR0_S2P                                 BIT(0)
+#define IDR0_S1P                                 BIT(1)
+#define IDR0_COHACC                              BIT(4)
+#define IDR0_VMID16                              BIT(18)
+#define IDR0_ST_LEVEL_VAL(v)                     (((v) >> 27) & 0x3)
+#define IDR0_ST_LEVEL_2LVL                       1
+
+/*SMMU_IDR1*/
+#define IDR1_SIDSIZE_VAL(v)                      ((v) & 0x3f)
+#define IDR1_EVENTQS_VAL(v)                      (((v) >> 16) & 0x1f)
+#define IDR1_CMDQS_VAL(v)                        (((v) >> 21) & 0x1f)
+#define IDR1_QUEUES_PRESET                       BIT(29)
+#define IDR1_TABLES_PRESET                       BIT(30)
+
+/*SMMU_IDR5*/
+#define IDR5_OAS_VAL(v)                          ((v) & 0x7)
+#define IDR5_GRAN4K                              BIT(4)
+
+/*SMMU_CR0 and SMMU_CR0ACK*/
+#define CR0_SMMUEN                               BIT(0)
+#define CR0_EVENTQEN                             BIT(2)
+#define CR0_CMDQEN                               BIT(3)
+
+/*SMMU_CR1, memory attributes of the SMMU table and queue accesses*/
+#define CR1_TABLE_SH_SET(v)                      ((v) << 10)
+#define CR1_TABLE_OC_SET(v)                      ((v) << 8)
+#define CR1_TABLE_IC_SET(v)                      ((v) << 6)
+#define CR1_QUEUE_SH_SET(v)                      ((v) << 4)
+#define CR1_QUEUE_OC_SET(v)                      ((v) << 2)
+#define CR1_QUEUE_IC_SET(v)                      ((v) << 0)
+#define CR1_CACHE_NC                             0
+#define CR1_CACHE_WB                             1
+#define CR1_SH_OSH                               2
+#define CR1_SH_ISH                               3
+
+/*SMMU_CR2*/
+#define CR2_RECINVSID                            BIT(1)
+#define CR2_PTM                                  BIT(2)
+
+/*SMMU_GBPA*/
+#define GBPA_ABORT                               BIT(20)
+#define GBPA_UPDATE                              BIT(31)
+
+/*SMMU_GERROR and SMMU_GERRORN*/
+#define GERROR_CMDQ_ERR                          BIT(0)
+
+/*SMMU_STRTAB_BASE*/
+#define STRTAB_BASE_RA                           BIT(62)
+#define STRTAB_BASE_ADDR_MASK                    0x000fffffffffffc0ull
+
+/*SMMU_STRTAB_BASE_CFG*/
+#define STRTAB_BASE_CFG_LOG2SIZE_SET(v)          (v)
+#define STRTAB_BASE_CFG_SPLIT_SET(v)             ((v) << 6)
+#define STRTAB_BASE_CFG_FMT_LINEAR               (0 << 16)
+#define STRTAB_BASE_CFG_FMT_2LVL                 (1 << 16)
+
+/*SMMU_CMDQ_BASE and SMMU_EVENTQ_BASE*/
+#define Q_BASE_RWA                               BIT(62)
+#define Q_BASE_ADDR_MASK                         0x000fffffffffffe0ull
+#define Q_BASE_LOG2SIZE_SET(v)                   (v)
+
+/*queue indexes, the bit above the index is the wrap flag*/
+#define Q_IDX(log2size, p)                       ((p) & MASK(log2size))
+#define Q_WRP(log2size, p)                       ((p) & BIT(log2size))
+#define Q_PTR(log2size, p)                       ((p) & MASK((log2size) + 1))
+#define Q_OVF                                    BIT(31)
+#define CMDQ_CONS_ERR_VAL(v)                     (((v) >> 24) & 0x7f)
+
+/*sizes of the queues used by the kernel, in log2 number of entries*/
+#define SMMU_CMDQ_LOG2SIZE                       8
+#define SMMU_EVTQ_LOG2SIZE                       7
+
+/*commands, each is two double words*/
+#define CMD_DWORDS                               2
+#define CMD_OP(op)                               ((uint64_t)(op))
+#define CMD_CFGI_STE                             0x03
+#define CMD_CFGI_ALL                             0x04
+#define CMD_CFGI_CD_ALL                          0x06
+#define CMD_TLBI_NH_ASID                         0x11
+#define CMD_TLBI_NH_VA                           0x12
+#define CMD_TLBI_S12_VMALL                       0x28
+#define CMD_TLBI_S2_IPA                          0x2a
+#define CMD_TLBI_NSNH_ALL                        0x30
+#define CMD_SYNC                                 0x46
+
+#define CMD_0_SID_SET(v)                         ((uint64_t)(v) << 32)
+#define CMD_0_VMID_SET(v)                        (((uint64_t)(v) & 0xffff) << 32)
+#define CMD_0_ASID_SET(v)                        (((uint64_t)(v) & 0xffff) << 48)
+#define CMD_1_LEAF                               BIT(0)
+#define CMD_1_ADDR_SET(v)                        ((uint64_t)(v) & 0x000ffffffffff000ull)
+#define CMD_1_RANGE_ALL                          0x1f
+#define CMD_SYNC_0_CS_NONE                       (0 << 12)
+
+/*stream table entries, each is eight double words*/
+#define STE_DWORDS                               8
+#define STE_SIZE_BITS                            6
+/*each level 2 stream table covers 64 SIDs, that is one 4K page*/
+#define STRTAB_SPLIT                             6
+#define STRTAB_L1_DESC_SPAN_SET(v)               (v)
+#define STRTAB_L1_DESC_L2PTR_MASK                0x000fffffffffffc0ull
+
+#define STE_0_V                                  BIT(0)
+#define STE_0_CFG_SET(v)                         ((uint64_t)(v) << 1)
+#define STE_0_CFG_ABORT                          0
+#define STE_0_CFG_S1_TRANS                       5
+#define STE_0_CFG_S2_TRANS                       6
+#define STE_0_S1CTXPTR_MASK                      0x000fffffffffffc0ull
+
+#define STE_1_S1CIR_SET(v)                       ((uint64_t)(v) << 2)
+#define STE_1_S1COR_SET(v)                       ((uint64_t)(v) << 4)
+#define STE_1_S1CSH_SET(v)                       ((uint64_t)(v) << 6)
+#define STE_1_STRW_NSEL1                         (0ull << 30)
+#define STE_1_SHCFG_INCOMING                     (1ull << 44)
+
+#define STE_2_S2VMID_SET(v)                      ((uint64_t)(v) & 0xffff)
+#define STE_2_S2T0SZ_SET(v)                      ((uint64_t)(v) << 32)
+#define STE_2_S2SL0_SET(v)                       ((uint64_t)(v) << 38)
+#define STE_2_S2IR0_SET(v)                       ((uint64_t)(v) << 40)
+#define STE_2_S2OR0_SET(v)                       ((uint64_t)(v) << 42)
+#define STE_2_S2SH0_SET(v)                       ((uint64_t)(v) << 44)
+#define STE_2_S2TG_4K                            (0ull << 46)
+#define STE_2_S2PS_SET(v)                        ((uint64_t)(v) << 48)
+#define STE_2_S2AA64                             BIT(51)
+#define STE_2_S2PTW                              BIT(54)
+#define STE_2_S2R                                BIT(58)
+#define STE_3_S2TTB_MASK                         0x000ffffffffffff0ull
+
+/*context descriptors, each is eight double words*/
+#define CD_DWORDS                                8
+#define CD_SIZE_BITS                             6
+
+#define CD_0_T0SZ_SET(v)                         ((uint64_t)(v))
+#define CD_0_TG0_4K                              (0ull << 6)
+#define CD_0_IR0_SET(v)                          ((uint64_t)(v) << 8)
+#define CD_0_OR0_SET(v)                          ((uint64_t)(v) << 10)
+#define CD_0_SH0_SET(v)                          ((uint64_t)(v) << 12)
+#define CD_0_EPD1                                BIT(30)
+#define CD_0_V                                   BIT(31)
+#define CD_0_IPS_SET(v)                          ((uint64_t)(v) << 32)
+#define CD_0_AA64                                BIT(41)
+#define CD_0_R                                   BIT(45)
+#define CD_0_A                                   BIT(46)
+#define CD_0_ASET                                BIT(47)
+#define CD_0_ASID_SET(v)                         (((uint64_t)(v) & 0xffff) << 48)
+#define CD_1_TTB0_MASK                           0x000ffffffffffff0ull
+
+/*cacheability and shareability encodings used by the STE and the CD*/
+#define SMMU_CACHE_NC                            0
+#define SMMU_CACHE_WBWA                          1
+#define SMMU_SH_OSH                              2
+#define SMMU_SH_ISH                              3
+
+/*the MAIR of the CD, configured according to the MAIR values in cores*/
+#define CD_MAIR_ATTR_DEVICE_nGnRnE               0x00ull
+#define CD_MAIR_ATTR_DEVICE_nGnRE                0x04ull
+#define CD_MAIR_ATTR_DEVICE_GRE                  0x0cull
+#define CD_MAIR_ATTR_NC                          0x44ull
+#define CD_MAIR_ATTR_CACHE                       0xffull
+#define CD_MAIR_VALUE                            (CD_MAIR_ATTR_DEVICE_nGnRnE | \
+                                                  CD_MAIR_ATTR_DEVICE_nGnRE << 8 | \
+                                                  CD_MAIR_ATTR_DEVICE_GRE << 16 | \
+                                                  CD_MAIR_ATTR_NC << 24 | \
+                                                  CD_MAIR_ATTR_CACHE << 32)
+
+/*the default virtual address bits of the stage 1 translation*/
+#define SMMU_VA_DEFAULT_BITS                     48
+
+/*events, each is four double words*/
+#define EVT_DWORDS                               4
+#define EVT_0_TYPE_VAL(v)                        ((v) & 0xff)
+#define EVT_0_SID_VAL(v)                         ((v) >> 32)
+
+/*the kernel loops N times before declaring a command queue operation failure*/
+#define CMDQ_POLL_LOOP                           100000
+
+void smmu_cb_assign_vspace(word_t cb, vspace_root_t *vspace, asid_t asid);
+void smmu_sid_bind_cb(word_t sid, word_t cb);
+void plat_smmu_init(void);
+void smmu_tlb_invalidate_all(void);
+void smmu_tlb_invalidate_cb(int cb, asid_t asid);
+void smmu_tlb_invalidate_cb_va(int cb, asid_t asid, vptr_t vaddr);
+void smmu_cb_disable(word_t cb, asid_t asid);
+void smmu_sid_unbind(word_t sid);
+void smmu_read_fault_state(uint32_t *status, uint32_t *syndrome_0, uint32_t *syndrome_1);
+void smmu_clear_fault_state(void);
+void smmu_cb_read_fault_state(int cb, uint32_t *status, word_t *address);
+void smmu_cb_clear_fault_state(int cb);
+void smmu_tlb_batch_begin(void);
+void smmu_tlb_batch_end(void);
@@ -10,6 +10,28 @@
 #include <object/reply.h>
 #include <object/notification.h>
 #endif
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+#include <kernel/cspace.h>
+#endif
+#ifdef CONFIG_BENCHMARK_FASTPATH_EXITS
+#include <sel4/benchmark_fastpath_exit_types.h>
+
+/* Count a fallback to the slowpath by the check that failed */
+#define FASTPATH_EXIT(reason) NODE_STATE(benchmark_fastpath_exits)[BENCHMARK_FASTPATH_EXIT_ ## reason]++
+/* For a check that combines two conditions, cond telling which one failed */
+#define FASTPATH_EXIT_EITHER(cond, reason, other) \
+    NODE_STATE(benchmark_fastpath_exits)[(cond) ? BENCHMARK_FASTPATH_EXIT_ ## reason : BENCHMARK_FASTPATH_EXIT_ ## other]++
+/* A failed lookup has already been counted by lookup_fp() */
+#define FASTPATH_EXIT_CAP(cap) do { \
+        if (!cap_capType_equals(cap, cap_null_cap)) { \
+            FASTPATH_EXIT(CAP_TYPE); \
+        } \
+    } while (0)
+#else
+#define FASTPATH_EXIT(reason)
+#define FASTPATH_EXIT_EITHER(cond, reason, other)
+#define FASTPATH_EXIT_CAP(cap)
+#endif
 
 #ifdef CONFIG_SIGNAL_FASTPATH
 /* Equivalent to schedContext_donate without migrateTCB() */
@@ -68,27 +90,62 @@ static inline cap_t FORCE_INLINE lookup_fp(cap_t cap, cptr_t cptr)
     cte_t *slot;
     word_t guardBits, radixBits, bits;
     word_t radix, capGuard;
+#ifdef CONFIG_FASTPATH_LOOKUP_MAX_DEPTH
+    word_t levels = 0;
+#endif
+
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+    cap_lookup_cache_entry_t *entry = capLookupCacheEntry(cptr);
+    if (likely(capLookupCacheHit(entry, cap, cptr))) {
+        cap = entry->slot->cap;
+#ifdef CONFIG_BENCHMARK_FASTPATH_EXITS
+        if (unlikely(cap_capType_equals(cap, cap_null_cap))) {
+            FASTPATH_EXIT(LOOKUP);
+        }
+#endif
+        return cap;
+    }
+#endif
 
     bits = 0;
 
     if (unlikely(! cap_capType_equals(cap, cap_cnode_cap))) {
+        FASTPATH_EXIT(LOOKUP);
         return cap_null_cap_new();
     }
 
     do {
+#ifdef CONFIG_FASTPATH_LOOKUP_MAX_DEPTH
+        /* Leave deeper CSpaces to the slowpath to bound the walk */
+        if (unlikely(levels++ == CONFIG_FASTPATH_LOOKUP_MAX_DEPTH)) {
+            FASTPATH_EXIT(LOOKUP_DEPTH);
+            return cap_null_cap_new();
+        }
+#endif
         guardBits = cap_cnode_cap_get_capCNodeGuardSize(cap);
         radixBits = cap_cnode_cap_get_capCNodeRadix(cap);
         cptr2 = cptr << bits;
 
         capGuard = cap_cnode_cap_get_capCNodeGuard(cap);
 
+#ifdef CONFIG_FASTPATH_LOOKUP_MAX_DEPTH
+        /* Check the guard. Depth mismatch check is deferred. The guard size
+           is at most wordBits - 1, so splitting the shift keeps it defined
+           and a guard of size 0 compares as 0 without a separate branch. */
+        if (unlikely(cptr2 >> 1 >> (wordBits - 1 - guardBits) != capGuard)) {
+            FASTPATH_EXIT(LOOKUP);
+            return cap_null_cap_new();
+        }
+#else
         /* Check the guard. Depth mismatch check is deferred.
            The 32MinusGuardSize encoding contains an exception
            when the guard is 0, when 32MinusGuardSize will be
            reported as 0 also. In this case we skip the check */
         if (likely(guardBits) && unlikely(cptr2 >> (wordBits - guardBits) != capGuard)) {
+            FASTPATH_EXIT(LOOKUP);
             return cap_null_cap_new();
         }
+#endif
 
         radix = cptr2 << guardBits >> (wordBits - radixBits);
         slot = CTE_PTR(cap_cnode_cap_get_capCNodePtr(cap)) + radix;
@@ -101,9 +158,16 @@ static inline cap_t FORCE_INLINE lookup_fp(cap_t cap, cptr_t cptr)
     if (unlikely(bits > wordBits)) {
         /* Depth mismatch. We've overshot wordBits bits. The lookup we've done is
            safe, but wouldn't be allowed by the slowpath. */
+        FASTPATH_EXIT(LOOKUP);
         return cap_null_cap_new();
     }
 
+#ifdef CONFIG_BENCHMARK_FASTPATH_EXITS
+    /* An empty slot, which fails like a failed lookup in the slowpath */
+    if (unlikely(cap_capType_equals(cap, cap_null_cap))) {
+        FASTPATH_EXIT(LOOKUP);
+    }
+#endif
     return cap;
 }
 /* make sure the fastpath functions conform with structure_*.bf */
@@ -10,6 +10,9 @@
 #include <api/failures.h>
 #include <api/types.h>
 #include <object/structures.h>
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+#include <model/statedata.h>
+#endif
 
 struct lookupCap_ret {
     exception_t status;
@@ -55,7 +58,38 @@ lookupSlot_ret_t lookupTargetSlot(cap_t root, cptr_t capptr,
                                   word_t depth);
 lookupSlot_ret_t lookupPivotSlot(cap_t root, cptr_t capptr,
                                  word_t depth);
+#ifdef CONFIG_FRAME_RANGE_INVOCATIONS
+/* Look up a window of window (at most maxWindow) consecutive slots starting at
+ * offset within the CNode found at capptr/depth. Returns the first slot. */
+lookupSlot_ret_t lookupSourceWindow(cap_t root, cptr_t capptr, word_t depth,
+                                    word_t offset, word_t window, word_t maxWindow);
+#endif
 resolveAddressBits_ret_t resolveAddressBits(cap_t nodeCap,
                                             cptr_t capptr,
                                             word_t n_bits);
 
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+void capLookupCacheFlush(void);
+
+static inline cap_lookup_cache_entry_t *capLookupCacheEntry(cptr_t capptr)
+{
+    word_t index = (capptr ^ (capptr >> CONFIG_CAP_LOOKUP_CACHE_BITS)) & MASK(CONFIG_CAP_LOOKUP_CACHE_BITS);
+    return &NODE_STATE(ksCapLookupCache)[index];
+}
+
+static inline bool_t capLookupCacheHit(cap_lookup_cache_entry_t *entry, cap_t root, cptr_t capptr)
+{
+    return entry->epoch == ksCapLookupEpoch && entry->cptr == capptr &&
+           entry->root.words[0] == root.words[0] && entry->root.words[1] == root.words[1];
+}
+
+/* A cached translation only depends on the CNode caps along its path, so
+ * the cache is flushed when a CNode cap is written to or removed from a slot. */
+static inline void capLookupCacheSlotChanged(cap_t cap)
+{
+    if (cap_get_capType(cap) == cap_cnode_cap) {
+        capLookupCacheFlush();
+    }
+}
+#endif
+
@@ -8,6 +8,13 @@
 #include <config.h>
 #include <arch/kernel/vspace.h>
 
+#ifdef CONFIG_TLB_BATCHING
+/* Between these calls, the TLB invalidations of unmapped pages are deferred
+ * and then issued together by endTLBBatch. */
+void beginTLBBatch(void);
+void endTLBBatch(void);
+#endif /* CONFIG_TLB_BATCHING */
+
 #ifdef CONFIG_KERNEL_LOG_BUFFER
 exception_t benchmark_arch_map_logBuffer(word_t frame_cptr);
 #endif /* CONFIG_KERNEL_LOG_BUFFER */
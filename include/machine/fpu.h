@@ -21,6 +21,12 @@ void switchLocalFpuOwner(tcb_t *new_owner);
 /* Switch the current owner of the FPU state on the core specified by 'cpu'. */
 void switchFpuOwner(tcb_t *new_owner, word_t cpu);
 
+#ifdef CONFIG_FPU_LAZY_SWITCH
+/* Handle a trap caused by the current thread using the FPU while its state is
+ * not loaded. Returns false if the trap should be delivered as a fault. */
+bool_t handleLazyFPUFault(void);
+#endif
+
 /* Returns whether or not the passed thread is using the current active fpu state */
 static inline bool_t nativeThreadUsingFPU(tcb_t *thread)
 {
@@ -34,7 +40,15 @@ static inline void FORCE_INLINE lazyFPURestore(tcb_t *thread)
     } else if (nativeThreadUsingFPU(thread)) {
         enableFpu();
     } else {
+#ifdef CONFIG_FPU_LAZY_SWITCH
+        /* Leave the FPU disabled until the thread first uses it */
+        disableFpu();
+#ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
+        NODE_STATE(benchmark_fpu_switches_deferred)++;
+#endif
+#else
         switchLocalFpuOwner(thread);
+#endif
     }
 }
 
@@ -11,6 +11,9 @@
 #include <object/structures.h>
 #include <object/tcb.h>
 #include <mode/types.h>
+#ifdef CONFIG_BENCHMARK_FASTPATH_EXITS
+#include <sel4/benchmark_fastpath_exit_types.h>
+#endif
 
 #ifdef ENABLE_SMP_SUPPORT
 #define NODE_STATE_BEGIN(_name)                 typedef struct _name {
@@ -55,6 +58,17 @@
 #define NUM_READY_QUEUES (CONFIG_NUM_DOMAINS * CONFIG_NUM_PRIORITIES)
 #define L2_BITMAP_SIZE ((CONFIG_NUM_PRIORITIES + wordBits - 1) / wordBits)
 
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+/* The slot cptr resolves to in the CSpace of root, valid while epoch is the
+ * current ksCapLookupEpoch */
+typedef struct cap_lookup_cache_entry {
+    cap_t root;
+    cptr_t cptr;
+    cte_t *slot;
+    word_t epoch;
+} cap_lookup_cache_entry_t;
+#endif
+
 NODE_STATE_BEGIN(nodeState)
 NODE_STATE_DECLARE(tcb_queue_t, ksReadyQueues[NUM_READY_QUEUES]);
 NODE_STATE_DECLARE(word_t, ksReadyQueuesL1Bitmap[CONFIG_NUM_DOMAINS]);
@@ -87,7 +101,36 @@ NODE_STATE_DECLARE(timestamp_t, benchmark_end_time);
 NODE_STATE_DECLARE(timestamp_t, benchmark_kernel_time);
 NODE_STATE_DECLARE(timestamp_t, benchmark_kernel_number_entries);
 NODE_STATE_DECLARE(timestamp_t, benchmark_kernel_number_schedules);
+#ifdef CONFIG_PREEMPTION_TIME_BUDGET
+/* Longest time between preemption checks, in timer ticks */
+NODE_STATE_DECLARE(ticks_t, benchmark_max_nonpreemptible_time);
+#endif /* CONFIG_PREEMPTION_TIME_BUDGET */
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+NODE_STATE_DECLARE(word_t, benchmark_cap_lookup_cache_hits);
+NODE_STATE_DECLARE(word_t, benchmark_cap_lookup_cache_misses);
+#endif /* CONFIG_CAP_LOOKUP_CACHE */
+#ifdef CONFIG_FPU_LAZY_SWITCH
+NODE_STATE_DECLARE(word_t, benchmark_fpu_switches_deferred);
+NODE_STATE_DECLARE(word_t, benchmark_fpu_restores);
+#endif /* CONFIG_FPU_LAZY_SWITCH */
 #endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
+#ifdef CONFIG_BENCHMARK_FASTPATH_EXITS
+/* Number of fallbacks to the slowpath, by the fastpath check that failed */
+NODE_STATE_DECLARE(word_t, benchmark_fastpath_exits[BENCHMARK_FASTPATH_NUM_EXITS]);
+#endif
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+NODE_STATE_DECLARE(cap_lookup_cache_entry_t, ksCapLookupCache[BIT(CONFIG_CAP_LOOKUP_CACHE_BITS)]);
+#endif
+#ifdef CONFIG_LOG_BUFFER_PER_NODE
+/* Kernel window address of the log buffer of this node, or 0 if unset */
+NODE_STATE_DECLARE(word_t, ksLogBuffer);
+NODE_STATE_DECLARE(word_t, ksLogIndex);
+NODE_STATE_DECLARE(word_t, ksLogIndexFinalized);
+#if CONFIG_MAX_NUM_TRACE_POINTS > 0
+NODE_STATE_DECLARE(timestamp_t, ksEntries[CONFIG_MAX_NUM_TRACE_POINTS]);
+NODE_STATE_DECLARE(bool_t, ksStarted[CONFIG_MAX_NUM_TRACE_POINTS]);
+#endif
+#endif /* CONFIG_LOG_BUFFER_PER_NODE */
 
 NODE_STATE_END(nodeState);
 
@@ -113,8 +156,46 @@ extern char ksIdleThreadTCB[CONFIG_MAX_NUM_NODES][BIT(seL4_TCBBits)];
 extern char ksIdleThreadSC[CONFIG_MAX_NUM_NODES][BIT(seL4_MinSchedContextBits)];
 #endif
 
+#ifdef CONFIG_ENDPOINT_BADGE_INDEX
+/* Threads blocked sending with a non-zero badge, hashed on endpoint and badge.
+ * Each bucket is kept in the order the threads blocked. The cursor is where
+ * cancelling the badge of cursorEP and cursorBadge continues: none of the
+ * threads before it are blocked sending with that badge. */
+#define BADGE_INDEX_BITS 8
+typedef struct badge_index_bucket {
+    tcb_t *head;
+    tcb_t *tail;
+    tcb_t *cursor;
+    endpoint_t *cursorEP;
+    word_t cursorBadge;
+} badge_index_bucket_t;
+extern badge_index_bucket_t ksBadgeIndex[BIT(BADGE_INDEX_BITS)];
+#endif
+
+#ifdef CONFIG_UNTYPED_BACKGROUND_RESET
+/* Slots of untyped caps to clear before switching to the idle thread, or NULL */
+#define UNTYPED_RESET_QUEUE_SIZE 16
+extern cte_t *ksUntypedResetQueue[UNTYPED_RESET_QUEUE_SIZE];
+#endif
+
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+/* Cached cptr translations of all nodes stamped with another epoch are stale */
+extern word_t ksCapLookupEpoch;
+#endif
+
 #ifdef CONFIG_KERNEL_LOG_BUFFER
 extern paddr_t ksUserLogBuffer;
+
+/* The log buffer and log index used by the current node */
+#ifdef CONFIG_LOG_BUFFER_PER_NODE
+#define KS_LOG_BUFFER_SET (NODE_STATE(ksLogBuffer) != 0)
+#define KS_LOG_BUFFER_PPTR NODE_STATE(ksLogBuffer)
+#define KS_LOG_INDEX NODE_STATE(ksLogIndex)
+#else
+#define KS_LOG_BUFFER_SET (ksUserLogBuffer != 0)
+#define KS_LOG_BUFFER_PPTR KS_LOG_PPTR
+#define KS_LOG_INDEX ksLogIndex
+#endif /* CONFIG_LOG_BUFFER_PER_NODE */
 #endif /* CONFIG_KERNEL_LOG_BUFFER */
 
 #define SchedulerAction_ResumeCurrentThread ((tcb_t*)0)
@@ -41,7 +41,11 @@ void receiveIPC(tcb_t *thread, cap_t cap, bool_t isBlocking);
 #endif
 void cancelIPC(tcb_t *tptr);
 void cancelAllIPC(endpoint_t *epptr);
+#ifdef CONFIG_ENDPOINT_BADGE_INDEX
+exception_t cancelBadgedSends(endpoint_t *epptr, word_t badge);
+#else
 void cancelBadgedSends(endpoint_t *epptr, word_t badge);
+#endif
 void replyFromKernel_error(tcb_t *thread);
 void replyFromKernel_success_empty(tcb_t *thread);
 
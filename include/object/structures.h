@@ -237,6 +237,19 @@ typedef struct sched_context sched_context_t;
 typedef struct reply reply_t;
 #endif
 
+#ifdef CONFIG_BULK_RETYPE
+/* A bulk retype that was preempted, or untyped is NULL */
+typedef struct bulk_retype {
+    cte_t *untyped;
+    cte_t *window;
+    word_t type;
+    word_t userSize;
+    word_t length;
+    /* Number of objects of the window already created */
+    word_t done;
+} bulk_retype_t;
+#endif
+
 struct tcb {
     /* arch specific tcb state (including context)*/
     arch_tcb_t tcbArch;
@@ -295,6 +308,20 @@ struct tcb {
     struct tcb *tcbSchedNext;
     struct tcb *tcbSchedPrev;
 
+#ifdef CONFIG_RELEASE_QUEUE_HEAP
+    /* First child when this TCB is in the release queue pairing heap, 1 word.
+     * tcbSchedNext and tcbSchedPrev then link it to its siblings, where
+     * tcbSchedPrev of a first child is its parent. */
+    struct tcb *tcbReleaseChild;
+#endif
+
+#ifdef CONFIG_IPC_QUEUE_PRIORITY_RUNS
+    /* Other end of the run of equal priority TCBs this TCB starts or ends
+     * in an endpoint or notification queue, itself if the run has only this
+     * TCB, and NULL in the middle of a run, 1 word */
+    struct tcb *tcbEPRun;
+#endif
+
 #ifndef CONFIG_KERNEL_MCS
     /* Previous and next pointers for endpoint and notification queues, 2 words
      * only for non-MCS configurations */
@@ -302,6 +329,26 @@ struct tcb {
     struct tcb *tcbEPPrev;
 #endif
 
+#ifdef CONFIG_ENDPOINT_BADGE_INDEX
+    /* Previous and next pointers for the badge index bucket of a thread
+     * blocked sending with a non-zero badge, 2 words */
+    struct tcb *tcbBadgeNext;
+    struct tcb *tcbBadgePrev;
+#endif
+
+#ifdef CONFIG_FAST_REVOKE
+    /* Number of capabilities removed by the revoke this thread is performing,
+     * including those removed before it was preempted, and the slot being
+     * revoked, or NULL, 2 words */
+    word_t tcbRevokeProgress;
+    cte_t *tcbRevokeSlot;
+#endif
+
+#ifdef CONFIG_BULK_RETYPE
+    /* The bulk retype this thread was preempted in, 6 words */
+    bulk_retype_t tcbBulkRetype;
+#endif
+
 #ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
     /* 16 bytes (12 bytes aarch32) */
     benchmark_util_t benchmark;
@@ -134,6 +134,7 @@ static inline bool_t PURE higher_than_tcb_prio(tcb_t *tcb, prio_t priority)
     return tcb != NULL && priority > tcb->tcbPriority;
 }
 
+#ifndef CONFIG_IPC_QUEUE_PRIORITY_RUNS
 /* Find the rightmost TCB in the given queue that has a priority which is
    strictly greater than the given priority */
 static tcb_t *find_tcb_with_higher_prio(tcb_queue_t queue, prio_t priority)
@@ -146,6 +147,7 @@ static tcb_t *find_tcb_with_higher_prio(tcb_queue_t queue, prio_t priority)
 
     return tcb;
 }
+#endif
 
 /* Insert a TCB into a queue immediately after another item in the queue
    (the queue must initially contain at least two items) */
@@ -161,6 +163,73 @@ static inline void tcb_queue_insert_after(tcb_t *tcb, tcb_t *before)
     before->tcbSchedNext = tcb;
 }
 
+#ifdef CONFIG_IPC_QUEUE_PRIORITY_RUNS
+/* Endpoint and notification queues are divided into runs of TCBs of equal
+   priority. The first and the last TCB of each run point at each other, so
+   that finding the place of a new TCB skips whole runs, and takes time in the
+   number of distinct priorities queued rather than the number of TCBs. */
+
+/* Add TCB into the priority ordered endpoint or notification queue */
+static inline tcb_queue_t tcbAppend(tcb_t *tcb, tcb_queue_t queue)
+{
+    prio_t priority = tcb->tcbPriority;
+    tcb_t *before = queue.end;
+
+    /* before is always the last TCB of a run */
+    while (higher_than_tcb_prio(before, priority)) {
+        before = before->tcbEPRun->tcbSchedPrev;
+    }
+
+    if (before != NULL && before->tcbPriority == priority) {
+        /* Become the new end of the run of before */
+        tcb_t *first = before->tcbEPRun;
+        if (first != before) {
+            before->tcbEPRun = NULL;
+        }
+        first->tcbEPRun = tcb;
+        tcb->tcbEPRun = first;
+    } else {
+        tcb->tcbEPRun = tcb;
+    }
+
+    if (before == NULL) {
+        return tcb_queue_prepend(queue, tcb);
+    } else if (before == queue.end) {
+        return tcb_queue_append(queue, tcb);
+    }
+
+    tcb_queue_insert_after(tcb, before);
+    return queue;
+}
+
+/* Update the runs of a queue for a TCB that is about to be removed from it.
+   Must be called while the TCB is still linked into the queue. */
+static inline void tcbEPRunRemove(tcb_t *tcb)
+{
+    tcb_t *other = tcb->tcbEPRun;
+    tcb_t *replacement;
+
+    if (other == NULL || other == tcb) {
+        return;
+    }
+
+    /* The TCB starts a run if the next TCB is in the same run, which is the
+       case if it is the other end or in the middle of the run */
+    if (tcb->tcbSchedNext == other || (tcb->tcbSchedNext != NULL && tcb->tcbSchedNext->tcbEPRun == NULL)) {
+        replacement = tcb->tcbSchedNext;
+    } else {
+        replacement = tcb->tcbSchedPrev;
+    }
+
+    if (replacement == other) {
+        other->tcbEPRun = other;
+    } else {
+        replacement->tcbEPRun = other;
+        other->tcbEPRun = replacement;
+    }
+    tcb->tcbEPRun = NULL;
+}
+#else
 /* Add TCB into the priority ordered endpoint or notification queue */
 static inline tcb_queue_t tcbAppend(tcb_t *tcb, tcb_queue_t queue)
 {
@@ -181,6 +250,7 @@ static inline tcb_queue_t tcbAppend(tcb_t *tcb, tcb_queue_t queue)
 
     return new_queue;
 }
+#endif /* CONFIG_IPC_QUEUE_PRIORITY_RUNS */
 
 /* Check for NullCap or EndpointCap with sufficient access rights */
 bool_t validFaultHandler(cap_t cap);
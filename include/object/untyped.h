@@ -34,3 +34,14 @@ exception_t invokeUntyped_Retype(cte_t *srcSlot, bool_t reset,
                                  void *retypeBase, object_t newType, word_t userSize,
                                  cte_t *destCNode, word_t destOffset, word_t destLength,
                                  bool_t deviceMemory);
+#ifdef CONFIG_BULK_RETYPE
+exception_t invokeUntyped_RetypeBulk(cte_t *srcSlot, bool_t reset,
+                                     void *retypeBase, object_t newType, word_t userSize,
+                                     cte_t *destSlots, word_t destLength, word_t done,
+                                     bool_t deviceMemory);
+#endif
+#ifdef CONFIG_UNTYPED_BACKGROUND_RESET
+void untypedResetSwapSlots(cte_t *slot1, cte_t *slot2);
+void untypedResetCancel(cte_t *slot);
+void untypedBackgroundReset(void);
+#endif
@@ -73,12 +73,26 @@ typedef struct acpi_rmrr_list {
     int num;
 } acpi_rmrr_list_t;
 
+typedef struct acpi_drhd_entry {
+    dev_id_t device;
+    uint32_t drhu;
+} acpi_drhd_entry_t;
+
+/* The PCI devices in the scope of each IOMMU */
+typedef struct acpi_drhd_list {
+    acpi_drhd_entry_t entries[CONFIG_MAX_DRHD_SCOPE_ENTRIES];
+    int num;
+    /* The IOMMU of all devices that are not listed, or -1 if that is unknown */
+    int include_all;
+} acpi_drhd_list_t;
+
 void acpi_dmar_scan(
     acpi_rsdp_t *acpi_rsdp,
     paddr_t     *drhu_list,
     uint32_t    *num_drhu,
     uint32_t     max_dhru_list_len,
-    acpi_rmrr_list_t *rmrr_list
+    acpi_rmrr_list_t *rmrr_list,
+    acpi_drhd_list_t *drhd_list
 );
 
 bool_t acpi_fadt_scan(
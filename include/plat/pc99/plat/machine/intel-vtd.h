@@ -11,12 +11,16 @@
 #ifdef CONFIG_IOMMU
 
 void invalidate_iotlb(void);
+/* invalidate the IOTLB entries of a domain, or of one page of a domain, in
+ * the IOMMU that translates the requests of a PCI device */
+void invalidate_iotlb_domain(uint32_t pci_request_id, uint16_t domain_id);
+void invalidate_iotlb_page(uint32_t pci_request_id, uint16_t domain_id, word_t io_address, word_t page_bits);
 void invalidate_context_cache(void);
 void vtd_handle_fault(void);
 /* calculate the number of IOPTs needed to map the rmrr regions */
 word_t vtd_get_n_paging(acpi_rmrr_list_t *rmrr_list);
 /* initialise the number of IOPTs */
 bool_t vtd_init_num_iopts(uint32_t num_drhu);
-bool_t vtd_init(cpu_id_t  cpu_id, acpi_rmrr_list_t *rmrr_list);
+bool_t vtd_init(cpu_id_t  cpu_id, acpi_rmrr_list_t *rmrr_list, acpi_drhd_list_t *drhd_list);
 
 #endif /* CONFIG_IOMMU */
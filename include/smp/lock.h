@@ -7,12 +7,17 @@
 #pragma once
 
 #include <config.h>
+#include <assert.h>
 #include <types.h>
 #include <util.h>
 #include <mode/machine.h>
 #include <arch/model/statedata.h>
 #include <smp/ipi.h>
 #include <util.h>
+#ifdef CONFIG_BENCHMARK_LOCK_CONTENTION
+#include <arch/benchmark.h>
+#include <sel4/benchmark_lock_contention_types.h>
+#endif
 
 #ifdef ENABLE_SMP_SUPPORT
 
@@ -35,6 +40,12 @@ typedef struct clh_node {
     clh_req_t *myreq; // Used to grant the lock to our successor.
     /* This is the software blocking IPI flag */
     word_t ipi;
+#ifdef CONFIG_FINE_GRAINED_LOCKING
+    /* Set while this node holds the lock in shared mode */
+    word_t shared;
+    /* Object lock currently held by this node, if any */
+    struct object_lock *objLock;
+#endif
 } ALIGN(L1_CACHE_LINE_SIZE) clh_node_t;
 
 typedef struct clh_lock {
@@ -43,6 +54,12 @@ typedef struct clh_lock {
 
     clh_req_t *tail;
 
+#ifdef CONFIG_FINE_GRAINED_LOCKING
+    /* Set by the node that holds the lock exclusively. Shared holders back
+     * off to the exclusive queue while it is set. */
+    word_t exclusive;
+#endif
+
     /* Global IPI state */
     ipi_state_t ipi;
 } ALIGN(EXCL_RES_GRANULE_SIZE) clh_lock_t;
@@ -50,6 +67,77 @@ typedef struct clh_lock {
 extern clh_lock_t big_kernel_lock;
 BOOT_CODE void clh_lock_init(void);
 
+#ifdef CONFIG_BENCHMARK_LOCK_CONTENTION
+/* Contention counters of a node. They are only written by the node they
+ * belong to, and kept apart from the lock so that counting does not add
+ * cache line transfers to the lock itself. */
+typedef struct clh_lock_stats {
+    uint64_t acquisitions[BENCHMARK_LOCK_NUM_ENTRY_TYPES];
+    uint64_t wait_cycles[BENCHMARK_LOCK_NUM_ENTRY_TYPES];
+    uint64_t hold_cycles[BENCHMARK_LOCK_NUM_ENTRY_TYPES];
+    /* Remote calls serviced while waiting for the lock */
+    uint64_t ipis;
+    uint64_t ipi_cycles;
+    /* Entry type of the current acquisition */
+    word_t entry;
+    /* Time the lock was granted, or 0 if no exclusive hold is being timed */
+    timestamp_t acquired;
+} ALIGN(L1_CACHE_LINE_SIZE) clh_lock_stats_t;
+
+extern clh_lock_stats_t clh_lock_stats[CONFIG_MAX_NUM_NODES];
+
+void clh_lock_stats_reset(void);
+
+#define NODE_LOCK_SET_ENTRY(_entry) do {                 \
+    clh_lock_stats[getCurrentCPUIndex()].entry = (_entry); \
+} while(0)
+#else
+#define NODE_LOCK_SET_ENTRY(_entry) do {} while (0)
+#endif /* CONFIG_BENCHMARK_LOCK_CONTENTION */
+
+#ifdef CONFIG_FINE_GRAINED_LOCKING
+/* Object locks protect the state of endpoints that may be modified while the
+ * big kernel lock is only held in shared mode. Objects are hashed onto a fixed
+ * set of spin locks, as the object layouts have no room for a lock word. */
+#define OBJECT_LOCK_STRIPE_BITS 6
+
+typedef struct object_lock {
+    word_t held;
+} ALIGN(L1_CACHE_LINE_SIZE) object_lock_t;
+
+extern object_lock_t object_locks[BIT(OBJECT_LOCK_STRIPE_BITS)];
+
+static inline object_lock_t *object_lock_for(void *obj)
+{
+    return &object_locks[((word_t)obj >> seL4_EndpointBits) & MASK(OBJECT_LOCK_STRIPE_BITS)];
+}
+
+static inline void FORCE_INLINE object_lock_acquire(void *obj)
+{
+    clh_node_t *node = &big_kernel_lock.node[getCurrentCPUIndex()];
+    object_lock_t *lock = object_lock_for(obj);
+
+    /* A node never holds more than one object lock, so there is no lock order to respect */
+    assert(node->objLock == NULL);
+    while (__atomic_exchange_n(&lock->held, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&lock->held, __ATOMIC_RELAXED)) {
+            arch_pause();
+        }
+    }
+    node->objLock = lock;
+}
+
+static inline void FORCE_INLINE object_lock_release(void)
+{
+    clh_node_t *node = &big_kernel_lock.node[getCurrentCPUIndex()];
+
+    if (node->objLock) {
+        __atomic_store_n(&node->objLock->held, 0, __ATOMIC_RELEASE);
+        node->objLock = NULL;
+    }
+}
+#endif /* CONFIG_FINE_GRAINED_LOCKING */
+
 static inline bool_t FORCE_INLINE clh_is_ipi_pending(word_t cpu)
 {
     /* Asssure IPI data is accessed only when this flag is set */
@@ -60,6 +148,10 @@ static inline void FORCE_INLINE clh_lock_acquire(bool_t irqPath)
 {
     word_t cpu = getCurrentCPUIndex();
     clh_node_t *node = &big_kernel_lock.node[cpu];
+#ifdef CONFIG_BENCHMARK_LOCK_CONTENTION
+    clh_lock_stats_t *stats = &clh_lock_stats[cpu];
+    timestamp_t start = timestamp();
+#endif
 
     /* Tell successor to wait */
     node->myreq->state = CLHState_Pending;
@@ -75,7 +167,14 @@ static inline void FORCE_INLINE clh_lock_acquire(bool_t irqPath)
             /* we only handle irq_remote_call_ipi here as other type of IPIs
              * are async and could be delayed. 'handleIPI' may not return
              * based on value of the 'irqPath'. */
+#ifdef CONFIG_BENCHMARK_LOCK_CONTENTION
+            timestamp_t ipi_start = timestamp();
+            stats->ipis++;
+#endif
             handleIPI(CORE_IRQ_TO_IRQT(cpu, irq_remote_call_ipi), irqPath);
+#ifdef CONFIG_BENCHMARK_LOCK_CONTENTION
+            stats->ipi_cycles += timestamp() - ipi_start;
+#endif
             /* We do not need to perform a memory release here as we would have only modified
              * local state that we do not need to make visible */
         }
@@ -84,15 +183,49 @@ static inline void FORCE_INLINE clh_lock_acquire(bool_t irqPath)
 
     /* make sure no resource access passes from this point */
     __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+#ifdef CONFIG_FINE_GRAINED_LOCKING
+    /* Keep new shared holders out and wait for the current ones to leave. Shared
+     * holders never wait on anything held by an exclusive holder, so this
+     * cannot deadlock. */
+    __atomic_store_n(&big_kernel_lock.exclusive, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    for (int i = 0; i < CONFIG_MAX_NUM_NODES; i++) {
+        while (__atomic_load_n(&big_kernel_lock.node[i].shared, __ATOMIC_ACQUIRE)) {
+            arch_pause();
+        }
+    }
+#endif
+
+#ifdef CONFIG_BENCHMARK_LOCK_CONTENTION
+    /* Waiting for shared holders to leave counts as waiting for the lock */
+    stats->acquired = timestamp();
+    stats->acquisitions[stats->entry]++;
+    stats->wait_cycles[stats->entry] += stats->acquired - start;
+#endif
 }
 
 static inline void FORCE_INLINE clh_lock_release(void)
 {
     clh_node_t *node = &big_kernel_lock.node[getCurrentCPUIndex()];
 
+#ifdef CONFIG_BENCHMARK_LOCK_CONTENTION
+    /* A core that was stalled while waiting takes the lock without returning
+     * to clh_lock_acquire, in which case the hold is not timed. */
+    clh_lock_stats_t *stats = &clh_lock_stats[getCurrentCPUIndex()];
+    if (stats->acquired != 0) {
+        stats->hold_cycles[stats->entry] += timestamp() - stats->acquired;
+        stats->acquired = 0;
+    }
+#endif
+
     /* make sure no resource access passes from this point */
     __atomic_thread_fence(__ATOMIC_RELEASE);
 
+#ifdef CONFIG_FINE_GRAINED_LOCKING
+    __atomic_store_n(&big_kernel_lock.exclusive, 0, __ATOMIC_RELAXED);
+#endif
+
     /* Pass lock to successor */
     node->myreq->state = CLHState_Granted;
     /* Take ownership of watched request, to use next time we take the lock */
@@ -104,12 +237,71 @@ static inline bool_t FORCE_INLINE clh_is_self_in_queue(void)
     return big_kernel_lock.node[getCurrentCPUIndex()].myreq->state == CLHState_Pending;
 }
 
-#define NODE_LOCK(_irqPath) do {                         \
+/* Whether another node has queued for the lock behind us */
+static inline bool_t FORCE_INLINE clh_is_lock_contended(void)
+{
+    return __atomic_load_n(&big_kernel_lock.tail, __ATOMIC_RELAXED) !=
+           big_kernel_lock.node[getCurrentCPUIndex()].myreq;
+}
+
+#ifdef CONFIG_FINE_GRAINED_LOCKING
+/* Try to take the lock in shared mode. This fails rather than waits if the
+ * lock is held exclusively, as only the exclusive queue services IPIs. */
+static inline bool_t FORCE_INLINE clh_lock_try_acquire_shared(void)
+{
+    clh_node_t *node = &big_kernel_lock.node[getCurrentCPUIndex()];
+
+    __atomic_store_n(&node->shared, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (unlikely(__atomic_load_n(&big_kernel_lock.exclusive, __ATOMIC_RELAXED))) {
+        __atomic_store_n(&node->shared, 0, __ATOMIC_RELAXED);
+        return false;
+    }
+
+#ifdef CONFIG_BENCHMARK_LOCK_CONTENTION
+    /* Shared holders neither wait nor hold up other shared holders, so only
+     * the acquisition is counted */
+    clh_lock_stats_t *stats = &clh_lock_stats[getCurrentCPUIndex()];
+    stats->acquisitions[stats->entry]++;
+#endif
+    return true;
+}
+
+static inline void FORCE_INLINE clh_lock_release_shared(void)
+{
+    __atomic_store_n(&big_kernel_lock.node[getCurrentCPUIndex()].shared, 0, __ATOMIC_RELEASE);
+}
+
+static inline bool_t FORCE_INLINE clh_is_self_shared(void)
+{
+    return big_kernel_lock.node[getCurrentCPUIndex()].shared;
+}
+
+/* Drop any object lock and, if the lock is only held in shared mode, take it
+ * exclusively. Callers must not have modified any state yet. */
+static inline void FORCE_INLINE clh_lock_upgrade(void)
+{
+    object_lock_release();
+    if (clh_is_self_shared()) {
+        clh_lock_release_shared();
+        NODE_LOCK_SET_ENTRY(BENCHMARK_LOCK_ENTRY_SYSCALL);
+        clh_lock_acquire(false);
+    }
+}
+#endif /* CONFIG_FINE_GRAINED_LOCKING */
+
+#define NODE_LOCK_AS(_irqPath, _entry) do {              \
+    NODE_LOCK_SET_ENTRY(_entry);                         \
     clh_lock_acquire(_irqPath);                          \
 } while(0)
 
-#define NODE_UNLOCK do {                                 \
-    clh_lock_release();                                  \
+#define NODE_LOCK(_irqPath) NODE_LOCK_AS(_irqPath,       \
+    (_irqPath) ? BENCHMARK_LOCK_ENTRY_INTERRUPT : BENCHMARK_LOCK_ENTRY_SYSCALL)
+
+#define NODE_LOCK_IF_AS(_cond, _irqPath, _entry) do {    \
+    if((_cond)) {                                        \
+        NODE_LOCK_AS(_irqPath, _entry);                  \
+    }                                                    \
 } while(0)
 
 #define NODE_LOCK_IF(_cond, _irqPath) do {               \
@@ -118,20 +310,72 @@ static inline bool_t FORCE_INLINE clh_is_self_in_queue(void)
     }                                                    \
 } while(0)
 
+#ifdef CONFIG_FINE_GRAINED_LOCKING
+#define NODE_LOCK_SHARED(_irqPath) do {                  \
+    NODE_LOCK_SET_ENTRY(BENCHMARK_LOCK_ENTRY_FASTPATH);  \
+    if (!clh_lock_try_acquire_shared()) {                \
+        clh_lock_acquire(_irqPath);                      \
+    }                                                    \
+} while(0)
+
+#define NODE_LOCK_UPGRADE do {                           \
+    clh_lock_upgrade();                                  \
+} while(0)
+
+#define NODE_LOCK_OBJECT(_obj) do {                      \
+    object_lock_acquire(_obj);                           \
+} while(0)
+
+#define NODE_UNLOCK_OBJECT do {                          \
+    object_lock_release();                               \
+} while(0)
+
+#define NODE_UNLOCK do {                                 \
+    if (clh_is_self_shared()) {                          \
+        clh_lock_release_shared();                       \
+    } else {                                             \
+        clh_lock_release();                              \
+    }                                                    \
+} while(0)
+
+#define NODE_UNLOCK_IF_HELD do {                         \
+    if(clh_is_self_in_queue() || clh_is_self_shared()) { \
+        NODE_UNLOCK;                                     \
+    }                                                    \
+} while(0)
+#else
+#define NODE_LOCK_SHARED(_irqPath) NODE_LOCK_AS(_irqPath, BENCHMARK_LOCK_ENTRY_FASTPATH)
+#define NODE_LOCK_UPGRADE do {} while (0)
+#define NODE_LOCK_OBJECT(_obj) do {} while (0)
+#define NODE_UNLOCK_OBJECT do {} while (0)
+
+#define NODE_UNLOCK do {                                 \
+    clh_lock_release();                                  \
+} while(0)
+
 #define NODE_UNLOCK_IF_HELD do {                         \
     if(clh_is_self_in_queue()) {                         \
         NODE_UNLOCK;                                     \
     }                                                    \
 } while(0)
+#endif /* CONFIG_FINE_GRAINED_LOCKING */
 
 #else
 #define NODE_LOCK(_irq) do {} while (0)
+#define NODE_LOCK_AS(_irq, _entry) do {} while (0)
 #define NODE_UNLOCK do {} while (0)
 #define NODE_LOCK_IF(_cond, _irq) do {} while (0)
+#define NODE_LOCK_IF_AS(_cond, _irq, _entry) do {} while (0)
 #define NODE_UNLOCK_IF_HELD do {} while (0)
+#define NODE_LOCK_SHARED(_irq) do {} while (0)
+#define NODE_LOCK_UPGRADE do {} while (0)
+#define NODE_LOCK_OBJECT(_obj) do {} while (0)
+#define NODE_UNLOCK_OBJECT do {} while (0)
 #endif /* ENABLE_SMP_SUPPORT */
 
 #define NODE_LOCK_SYS NODE_LOCK(false)
+#define NODE_LOCK_FAULT NODE_LOCK_AS(false, BENCHMARK_LOCK_ENTRY_FAULT)
+#define NODE_LOCK_SHARED_SYS NODE_LOCK_SHARED(false)
 #define NODE_LOCK_IRQ NODE_LOCK(true)
 #define NODE_LOCK_SYS_IF(_cond) NODE_LOCK_IF(_cond, false)
 #define NODE_LOCK_IRQ_IF(_cond) NODE_LOCK_IF(_cond, true)
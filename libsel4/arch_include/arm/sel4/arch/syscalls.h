@@ -719,6 +719,37 @@ LIBSEL4_INLINE_FUNC seL4_Error seL4_BenchmarkSetLogBuffer(seL4_Word frame_cptr)
     return (seL4_Error) frame_cptr;
 }
 
+#ifdef CONFIG_LOG_BUFFER_PER_NODE
+LIBSEL4_INLINE_FUNC seL4_Error seL4_BenchmarkSetNodeLogBuffer(seL4_Word frame_cptr, seL4_Word node)
+{
+    seL4_Word unused0 = 0;
+    seL4_Word unused1 = 0;
+    seL4_Word unused2 = 0;
+    seL4_Word unused3 = 0;
+    seL4_Word unused4 = 0;
+
+    arm_sys_send_recv(seL4_SysBenchmarkSetLogBuffer, frame_cptr, &frame_cptr, node, &unused0, &unused1, &unused2, &unused3,
+                      &unused4, 0);
+
+    return (seL4_Error) frame_cptr;
+}
+#endif /* CONFIG_LOG_BUFFER_PER_NODE */
+
+#ifdef CONFIG_BENCHMARK_ENTRY_HISTOGRAMS
+LIBSEL4_INLINE_FUNC seL4_Word seL4_BenchmarkGetHistogram(seL4_Word index)
+{
+    seL4_Word unused0 = 0;
+    seL4_Word unused1 = 0;
+    seL4_Word unused2 = 0;
+    seL4_Word unused3 = 0;
+    seL4_Word unused4 = 0;
+
+    arm_sys_send_recv(seL4_SysBenchmarkGetHistogram, index, &index, 0, &unused0, &unused1, &unused2, &unused3, &unused4, 0);
+
+    return index;
+}
+#endif /* CONFIG_BENCHMARK_ENTRY_HISTOGRAMS */
+
 LIBSEL4_INLINE_FUNC void seL4_BenchmarkNullSyscall(void)
 {
     arm_sys_null(seL4_SysBenchmarkNullSyscall);
@@ -792,6 +823,102 @@ LIBSEL4_INLINE_FUNC void seL4_BenchmarkResetAllThreadsUtilisation(void)
 
 #endif
 #endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
+
+#ifdef CONFIG_BENCHMARK_LOCK_CONTENTION
+LIBSEL4_INLINE_FUNC seL4_Error seL4_BenchmarkGetLockContention(seL4_Word node)
+{
+    seL4_Word unused0 = 0;
+    seL4_Word unused1 = 0;
+    seL4_Word unused2 = 0;
+    seL4_Word unused3 = 0;
+    seL4_Word unused4 = 0;
+
+    arm_sys_send_recv(seL4_SysBenchmarkGetLockContention, node, &node, 0, &unused0, &unused1, &unused2, &unused3, &unused4, 0);
+
+    return (seL4_Error) node;
+}
+
+LIBSEL4_INLINE_FUNC void seL4_BenchmarkResetLockContention(void)
+{
+    seL4_Word unused0 = 0;
+    seL4_Word unused1 = 0;
+    seL4_Word unused2 = 0;
+    seL4_Word unused3 = 0;
+    seL4_Word unused4 = 0;
+    seL4_Word unused5 = 0;
+
+    arm_sys_send_recv(seL4_SysBenchmarkResetLockContention, 0, &unused0, 0, &unused1, &unused2, &unused3, &unused4, &unused5, 0);
+}
+#endif /* CONFIG_BENCHMARK_LOCK_CONTENTION */
+
+#ifdef CONFIG_FAST_CLEAR_MEMORY
+LIBSEL4_INLINE_FUNC seL4_Error seL4_BenchmarkClearMemory(seL4_CPtr untyped, seL4_Word size_bits)
+{
+    seL4_Word unused0 = 0;
+    seL4_Word unused1 = 0;
+    seL4_Word unused2 = 0;
+    seL4_Word unused3 = 0;
+
+    arm_sys_send_recv(seL4_SysBenchmarkClearMemory, untyped, &untyped, 0, &unused0, &size_bits, &unused1, &unused2, &unused3, 0);
+
+    return (seL4_Error) untyped;
+}
+#endif /* CONFIG_FAST_CLEAR_MEMORY */
+
+#ifdef CONFIG_BENCHMARK_FASTPATH_EXITS
+LIBSEL4_INLINE_FUNC seL4_Error seL4_BenchmarkGetFastpathExits(seL4_Word node)
+{
+    seL4_Word unused0 = 0;
+    seL4_Word unused1 = 0;
+    seL4_Word unused2 = 0;
+    seL4_Word unused3 = 0;
+    seL4_Word unused4 = 0;
+
+    arm_sys_send_recv(seL4_SysBenchmarkGetFastpathExits, node, &node, 0, &unused0, &unused1, &unused2, &unused3, &unused4, 0);
+
+    return (seL4_Error) node;
+}
+
+LIBSEL4_INLINE_FUNC void seL4_BenchmarkResetFastpathExits(void)
+{
+    seL4_Word unused0 = 0;
+    seL4_Word unused1 = 0;
+    seL4_Word unused2 = 0;
+    seL4_Word unused3 = 0;
+    seL4_Word unused4 = 0;
+    seL4_Word unused5 = 0;
+
+    arm_sys_send_recv(seL4_SysBenchmarkResetFastpathExits, 0, &unused0, 0, &unused1, &unused2, &unused3, &unused4, &unused5, 0);
+}
+#endif /* CONFIG_BENCHMARK_FASTPATH_EXITS */
+
+#ifdef CONFIG_BENCHMARK_VCPU_SWITCH
+LIBSEL4_INLINE_FUNC seL4_Error seL4_BenchmarkGetVCPUSwitchStats(seL4_CPtr vcpu)
+{
+    seL4_Word unused0 = 0;
+    seL4_Word unused1 = 0;
+    seL4_Word unused2 = 0;
+    seL4_Word unused3 = 0;
+    seL4_Word unused4 = 0;
+
+    arm_sys_send_recv(seL4_SysBenchmarkGetVCPUSwitchStats, vcpu, &vcpu, 0, &unused0, &unused1, &unused2, &unused3, &unused4, 0);
+
+    return (seL4_Error) vcpu;
+}
+
+LIBSEL4_INLINE_FUNC seL4_Error seL4_BenchmarkResetVCPUSwitchStats(seL4_CPtr vcpu)
+{
+    seL4_Word unused0 = 0;
+    seL4_Word unused1 = 0;
+    seL4_Word unused2 = 0;
+    seL4_Word unused3 = 0;
+    seL4_Word unused4 = 0;
+
+    arm_sys_send_recv(seL4_SysBenchmarkResetVCPUSwitchStats, vcpu, &vcpu, 0, &unused0, &unused1, &unused2, &unused3, &unused4, 0);
+
+    return (seL4_Error) vcpu;
+}
+#endif /* CONFIG_BENCHMARK_VCPU_SWITCH */
 #endif /* CONFIG_ENABLE_BENCHMARKS */
 
 #ifdef CONFIG_SET_TLS_BASE_SELF
@@ -802,6 +929,23 @@ LIBSEL4_INLINE_FUNC void seL4_SetTLSBase(seL4_Word tls_base)
 }
 #endif /* CONFIG_SET_TLS_BASE_SELF */
 
+#ifdef CONFIG_BATCH_INVOCATION
+LIBSEL4_INLINE_FUNC seL4_Error seL4_BatchInvoke(seL4_Word length)
+{
+    seL4_Word unused0 = 0;
+    seL4_Word unused1 = 0;
+    seL4_Word unused2 = 0;
+    seL4_Word unused3 = 0;
+    seL4_Word unused4 = 0;
+    seL4_Word error;
+
+    arm_sys_send_recv(seL4_SysBatchInvoke, 0, &error, seL4_MessageInfo_new(0, 0, 0, length).words[0], &unused0,
+                      &unused1, &unused2, &unused3, &unused4, 0);
+
+    return (seL4_Error) error;
+}
+#endif /* CONFIG_BATCH_INVOCATION */
+
 #ifndef CONFIG_KERNEL_MCS
 LIBSEL4_INLINE_FUNC void seL4_Wait(seL4_CPtr src, seL4_Word *sender)
 {
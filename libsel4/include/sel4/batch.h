@@ -0,0 +1,67 @@
+/*
+ * Copyright 2026, UNSW
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <sel4/config.h>
+#include <sel4/types.h>
+#include <sel4/functions.h>
+#include <sel4/arch/syscalls.h>
+
+#ifdef CONFIG_BATCH_INVOCATION
+
+/* A batch of invocations that is built in memory and then copied to the IPC
+ * buffer to be performed with seL4_BatchInvoke. Records are added with the
+ * generated _Batch variants of the object invocations. */
+typedef struct seL4_Batch {
+    seL4_Word length;
+    seL4_Word msg[seL4_MsgMaxLength];
+} seL4_Batch_t;
+
+LIBSEL4_INLINE_FUNC void seL4_Batch_Init(seL4_Batch_t *batch)
+{
+    batch->msg[seL4_Batch_Completed] = 0;
+    batch->msg[seL4_Batch_NextRecord] = seL4_Batch_HeaderLength;
+    batch->length = seL4_Batch_HeaderLength;
+}
+
+/* Reserve space for a record, returning a pointer to the words after the
+ * invoked capability, or seL4_Null if the record does not fit in the batch. */
+LIBSEL4_INLINE_FUNC seL4_Word *seL4_Batch_Reserve(seL4_Batch_t *batch, seL4_MessageInfo_t tag, seL4_CPtr service)
+{
+    seL4_Word words = 2 + seL4_MessageInfo_get_extraCaps(tag) + seL4_MessageInfo_get_length(tag);
+    seL4_Word *record = &batch->msg[batch->length];
+
+    if (batch->length + words > seL4_MsgMaxLength) {
+        return seL4_Null;
+    }
+
+    batch->length += words;
+    record[0] = tag.words[0];
+    record[1] = service;
+    return &record[2];
+}
+
+/* Perform all records of a batch. On return, *completed holds the number of
+ * records that were performed, and if an error is returned, the record with
+ * that index failed and no later records were performed. */
+LIBSEL4_INLINE_FUNC seL4_Error seL4_Batch_Invoke(seL4_Batch_t *batch, seL4_Word *completed)
+{
+    seL4_Error error;
+
+    for (seL4_Word i = 0; i < batch->length; i++) {
+        seL4_SetMR(i, batch->msg[i]);
+    }
+
+    error = seL4_BatchInvoke(batch->length);
+
+    if (completed != seL4_Null) {
+        *completed = seL4_GetMR(seL4_Batch_Completed);
+    }
+    return error;
+}
+
+#endif /* CONFIG_BATCH_INVOCATION */
@@ -0,0 +1,25 @@
+/*
+ * Copyright 2026, UNSW
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <sel4/config.h>
+
+#if defined(CONFIG_ENABLE_BENCHMARKS) && defined(CONFIG_FAST_CLEAR_MEMORY)
+
+/* Layout of the 64-bit cycle counts that seL4_BenchmarkClearMemory writes to
+ * the IPC buffer. Cycles are in the unit of the benchmark timestamp. */
+enum benchmark_clear_memory_ipc_index {
+    /* Clearing with the generic word loop */
+    BENCHMARK_CLEAR_MEMORY_WORD_LOOP = 0,
+    /* Clearing with the method the kernel uses for objects */
+    BENCHMARK_CLEAR_MEMORY_OBJECT,
+    /* Clearing with the method the kernel uses to reset untyped memory */
+    BENCHMARK_CLEAR_MEMORY_RESET,
+    BENCHMARK_CLEAR_MEMORY_NUM_METHODS
+};
+
+#endif /* CONFIG_ENABLE_BENCHMARKS && CONFIG_FAST_CLEAR_MEMORY */
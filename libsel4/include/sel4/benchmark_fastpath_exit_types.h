@@ -0,0 +1,61 @@
+/*
+ * Copyright 2026, UNSW
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <sel4/config.h>
+
+#ifdef CONFIG_BENCHMARK_FASTPATH_EXITS
+
+/* Checks of the IPC, signal and fault fastpaths that can send a kernel entry
+ * to the slowpath. seL4_BenchmarkGetFastpathExits writes the number of times
+ * each check failed on a node to the IPC buffer as 64-bit counters, in this
+ * order. */
+enum benchmark_fastpath_exit {
+    /* The message has extra caps or too many words for the fastpath */
+    BENCHMARK_FASTPATH_EXIT_MESSAGE_INFO,
+    /* The invoking thread has a saved fault */
+    BENCHMARK_FASTPATH_EXIT_SAVED_FAULT,
+    /* The cptr does not resolve, or resolves to an empty slot */
+    BENCHMARK_FASTPATH_EXIT_LOOKUP,
+    /* The cptr resolves through more than KernelFastpathLookupMaxDepth CNodes */
+    BENCHMARK_FASTPATH_EXIT_LOOKUP_DEPTH,
+    /* The cap has the wrong type or lacks a right the fastpath needs */
+    BENCHMARK_FASTPATH_EXIT_CAP_TYPE,
+    /* The thread to switch to would not be the highest priority runnable
+     * thread */
+    BENCHMARK_FASTPATH_EXIT_PRIORITY,
+    /* The thread to switch to has affinity to another node */
+    BENCHMARK_FASTPATH_EXIT_AFFINITY,
+    /* No thread waits to receive on the endpoint, or a thread waits to send
+     * on the endpoint received from */
+    BENCHMARK_FASTPATH_EXIT_ENDPOINT_STATE,
+    /* The notification bound to the receiving thread is active */
+    BENCHMARK_FASTPATH_EXIT_BOUND_NOTIFICATION,
+    /* The thread to switch to is being single stepped */
+    BENCHMARK_FASTPATH_EXIT_SINGLE_STEP,
+    /* The thread to switch to has no valid VSpace root, ASID or VMID */
+    BENCHMARK_FASTPATH_EXIT_VTABLE,
+    /* The thread to switch to is in another domain, or the current domain
+     * has expired */
+    BENCHMARK_FASTPATH_EXIT_DOMAIN,
+    /* A scheduling context cannot be donated as the fastpath requires, or it
+     * has no budget left */
+    BENCHMARK_FASTPATH_EXIT_SCHED_CONTEXT,
+    /* The reply cap or reply object is not in the state the fastpath
+     * requires */
+    BENCHMARK_FASTPATH_EXIT_REPLY,
+    /* The thread replied to has a fault the fastpath cannot reply to */
+    BENCHMARK_FASTPATH_EXIT_CALLER_FAULT,
+    /* The thread signalled has its FPU state loaded on another node */
+    BENCHMARK_FASTPATH_EXIT_FPU,
+    /* The VCPU invocation is not an IRQ injection the fastpath performs, or
+     * an IRQ is invalid or its list register is in use */
+    BENCHMARK_FASTPATH_EXIT_VCPU_INJECT,
+    BENCHMARK_FASTPATH_NUM_EXITS
+};
+
+#endif /* CONFIG_BENCHMARK_FASTPATH_EXITS */
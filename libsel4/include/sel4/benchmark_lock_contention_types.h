@@ -0,0 +1,43 @@
+/*
+ * Copyright 2026, UNSW
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <sel4/config.h>
+
+#ifdef CONFIG_BENCHMARK_LOCK_CONTENTION
+
+/* Kernel entry types that acquisitions of the kernel lock are counted by */
+enum benchmark_lock_entry_type {
+    /* System calls on the slowpath, including fastpath calls that fell back to it */
+    BENCHMARK_LOCK_ENTRY_SYSCALL,
+    /* System calls that entered on the fastpath */
+    BENCHMARK_LOCK_ENTRY_FASTPATH,
+    /* User-level, VM and VCPU faults */
+    BENCHMARK_LOCK_ENTRY_FAULT,
+    /* Interrupts */
+    BENCHMARK_LOCK_ENTRY_INTERRUPT,
+    BENCHMARK_LOCK_NUM_ENTRY_TYPES
+};
+
+/* Layout of the 64-bit counters that seL4_BenchmarkGetLockContention writes
+ * to the IPC buffer. Cycles are in the unit of the benchmark timestamp. */
+enum benchmark_lock_contention_ipc_index {
+    /* Number of times the lock was taken, per entry type */
+    BENCHMARK_LOCK_ACQUISITIONS = 0,
+    /* Cycles spent waiting for the lock, per entry type. This includes the
+     * time spent servicing remote calls while waiting. */
+    BENCHMARK_LOCK_WAIT_CYCLES = BENCHMARK_LOCK_ACQUISITIONS + BENCHMARK_LOCK_NUM_ENTRY_TYPES,
+    /* Cycles the lock was held exclusively, per entry type */
+    BENCHMARK_LOCK_HOLD_CYCLES = BENCHMARK_LOCK_WAIT_CYCLES + BENCHMARK_LOCK_NUM_ENTRY_TYPES,
+    /* Number of remote calls serviced while waiting for the lock */
+    BENCHMARK_LOCK_IPIS = BENCHMARK_LOCK_HOLD_CYCLES + BENCHMARK_LOCK_NUM_ENTRY_TYPES,
+    /* Cycles spent servicing remote calls while waiting for the lock */
+    BENCHMARK_LOCK_IPI_CYCLES,
+    BENCHMARK_LOCK_NUM_COUNTERS
+};
+
+#endif /* CONFIG_BENCHMARK_LOCK_CONTENTION */
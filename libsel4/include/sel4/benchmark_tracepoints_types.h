@@ -7,10 +7,15 @@
 #pragma once
 
 #include <sel4/config.h>
+#include <stdint.h>
 
 #ifdef CONFIG_BENCHMARK_TRACEPOINTS
 typedef struct benchmark_tracepoint_log_entry {
     seL4_Word  id;
     seL4_Word  duration;
+#ifdef CONFIG_LOG_BUFFER_PER_NODE
+    /* timestamp() when the trace point was started */
+    uint64_t   start_time;
+#endif
 } benchmark_tracepoint_log_entry_t;
 #endif /* CONFIG_BENCHMARK_TRACEPOINTS */
@@ -65,4 +65,31 @@ typedef struct benchmark_syscall_log_entry {
     kernel_entry_t entry;
 } benchmark_track_kernel_entry_t;
 
+#ifdef CONFIG_BENCHMARK_ENTRY_HISTOGRAMS
+
+/* Number of log2 latency buckets in each histogram. Bucket i counts kernel
+ * entries that took [2^i, 2^(i+1)) cycles, bucket 0 also counts entries of
+ * zero cycles and the last bucket counts everything longer. */
+#define seL4_NumBenchmarkHistogramBuckets 32
+
+/* Index of the histogram that counts kernel entries that could not be given a
+ * histogram of their own. */
+#define seL4_BenchmarkHistogramOverflow 0
+
+/**
+ * @brief Kernel entry latency histogram
+ *
+ * Aggregates the duration of all kernel entries with the same key. Syscalls are
+ * keyed on the syscall number, cap type, invocation label and whether they
+ * took the fastpath, interrupts on the core and interrupt number, and all other
+ * entries on the entry path alone.
+ */
+typedef struct benchmark_track_histogram {
+    kernel_entry_t entry;
+    uint64_t count;
+    uint32_t buckets[seL4_NumBenchmarkHistogramBuckets];
+} benchmark_track_histogram_t;
+
+#endif /* CONFIG_BENCHMARK_ENTRY_HISTOGRAMS */
+
 #endif /* CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES || CONFIG_DEBUG_BUILD */
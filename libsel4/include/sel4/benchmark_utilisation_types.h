@@ -40,6 +40,29 @@ enum benchmark_track_util_ipc_index {
     BENCHMARK_TOTAL_KERNEL_UTILISATION,
     /* Total number of times the kernel is entered on the current core */
     BENCHMARK_TOTAL_NUMBER_KERNEL_ENTRIES,
+
+#ifdef CONFIG_FPU_LAZY_SWITCH
+    /* Number of times a thread was switched to on the current core without
+     * loading its FPU state */
+    BENCHMARK_TOTAL_FPU_SWITCHES_DEFERRED,
+    /* Number of times a thread's FPU state was loaded on first use on the
+     * current core. The difference to the deferred switches is the number of
+     * FPU switches that were avoided. */
+    BENCHMARK_TOTAL_FPU_RESTORES,
+#endif
+
+#ifdef CONFIG_PREEMPTION_TIME_BUDGET
+    /* Longest time in timer ticks the core spent in the kernel without
+     * checking for pending interrupts, measured at preemption points */
+    BENCHMARK_TOTAL_MAX_NONPREEMPTIBLE_TIME,
+#endif
+
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+    /* Number of cptr lookups on the core answered by the lookup cache */
+    BENCHMARK_TOTAL_CAP_LOOKUP_CACHE_HITS,
+    /* Number of cptr lookups on the core that walked the CSpace */
+    BENCHMARK_TOTAL_CAP_LOOKUP_CACHE_MISSES,
+#endif
 };
 
 #endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
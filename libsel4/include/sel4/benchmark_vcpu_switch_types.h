@@ -0,0 +1,37 @@
+/*
+ * Copyright 2026, UNSW
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <sel4/config.h>
+
+#ifdef CONFIG_BENCHMARK_VCPU_SWITCH
+
+/* Costs of switching the hardware to and from a VCPU.
+ * seL4_BenchmarkGetVCPUSwitchStats writes the counters of a VCPU to the IPC
+ * buffer as 64-bit counters, in this order. */
+enum benchmark_vcpu_switch_stat {
+    /* Number of times the state of the VCPU was loaded into the hardware */
+    BENCHMARK_VCPU_SWITCH_LOADS,
+    /* Number of times the VCPU was re-enabled while its state was still
+     * loaded, after a thread without a VCPU ran */
+    BENCHMARK_VCPU_SWITCH_REENABLES,
+    /* Number of times the state of the VCPU was saved from the hardware */
+    BENCHMARK_VCPU_SWITCH_SAVES,
+    /* Number of VGIC list registers read when saving the VCPU */
+    BENCHMARK_VCPU_SWITCH_LRS_SAVED,
+    /* Number of VGIC list registers written when loading the VCPU */
+    BENCHMARK_VCPU_SWITCH_LRS_RESTORED,
+    /* Number of system registers of the save range written when loading
+     * the VCPU */
+    BENCHMARK_VCPU_SWITCH_REGS_RESTORED,
+    /* Number of cycles spent switching to the VCPU, including saving the
+     * VCPU that was loaded before it */
+    BENCHMARK_VCPU_SWITCH_CYCLES,
+    BENCHMARK_VCPU_SWITCH_NUM_STATS
+};
+
+#endif /* CONFIG_BENCHMARK_VCPU_SWITCH */
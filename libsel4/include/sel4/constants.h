@@ -41,6 +41,16 @@ typedef enum {
 } seL4_DebugException_Msg;
 #endif
 
+#ifdef CONFIG_BATCH_INVOCATION
+/* Format of the header of a batch invocation message. */
+typedef enum {
+    seL4_Batch_Completed,
+    seL4_Batch_NextRecord,
+    seL4_Batch_HeaderLength,
+    SEL4_FORCE_LONG_ENUM(seL4_Batch_Msg)
+} seL4_Batch_Msg;
+#endif
+
 enum priorityConstants {
     seL4_InvalidPrio = -1,
     seL4_MinPrio = 0,
@@ -220,7 +220,11 @@ seL4_BenchmarkResetLog(void);
  *    2. `BENCHMARK_TRACK_KERNEL_ENTRIES`:  as above,
  *    3. `BENCHMARK_TRACK_UTILISATION`: sets benchmark end time to current time, stops tracking utilisation.
  *
+ * With `LOG_BUFFER_PER_NODE`, the final index of the log buffer of each node is also written to the
+ * message register with the index of the node.
+ *
  * @return The index of the final entry in the log buffer (if `BENCHMARK_TRACEPOINTS`/`BENCHMARK_TRACK_KERNEL_ENTRIES` are enabled).
+ *         With `LOG_BUFFER_PER_NODE`, the index of the final entry in the log buffer of node 0.
  *
  */
 LIBSEL4_INLINE_FUNC seL4_Word
@@ -240,6 +244,44 @@ seL4_BenchmarkFinalizeLog(void);
 LIBSEL4_INLINE_FUNC seL4_Error
 seL4_BenchmarkSetLogBuffer(seL4_Word frame_cptr);
 
+#ifdef CONFIG_LOG_BUFFER_PER_NODE
+/**
+ * @xmlonly <manual name="Set Node Log Buffer" label="sel4_benchmarksetnodelogbuffer"/> @endxmlonly
+ * @brief Set the log buffer of a node.
+ *
+ * With `LOG_BUFFER_PER_NODE`, each node logs to its own buffer with its own index. The frame must not be
+ * device memory and must be at least `seL4_LogBufferSize` in size. `seL4_BenchmarkSetLogBuffer` sets the
+ * buffer of node 0. The logs of several nodes can be merged by start time with `tools/merge_log_buffers.py`.
+ *
+ * @param[in] frame_cptr A capability pointer to a user allocated frame.
+ * @param[in] node The index of the node that logs to the frame.
+ * @return A `seL4_IllegalOperation` error if `frame_cptr` or `node` is not valid and couldn't set the buffer.
+ *
+ */
+LIBSEL4_INLINE_FUNC seL4_Error
+seL4_BenchmarkSetNodeLogBuffer(seL4_Word frame_cptr, seL4_Word node);
+#endif
+
+#ifdef CONFIG_BENCHMARK_ENTRY_HISTOGRAMS
+/**
+ * @xmlonly <manual name="Get Histogram" label="sel4_benchmarkgethistogram"/> @endxmlonly
+ * @brief Get a kernel entry latency histogram.
+ *
+ * With `BENCHMARK_ENTRY_HISTOGRAMS`, the log buffer holds an array of `benchmark_track_histogram_t`
+ * instead of one record per kernel entry, and `seL4_BenchmarkFinalizeLog` returns the number of histograms in use.
+ * Histogram `seL4_BenchmarkHistogramOverflow` counts entries that did not fit in the log buffer.
+ * This system call copies the buckets of one histogram to message registers 0 to
+ * `seL4_NumBenchmarkHistogramBuckets - 1` of the IPC buffer, as a snapshot that is not being updated
+ * by other cores. Use `seL4_BenchmarkResetLog` to clear all histograms.
+ *
+ * @param[in] index Index of the histogram in the log buffer.
+ * @return The number of kernel entries counted in the histogram, or 0 if `index` is not in use.
+ *
+ */
+LIBSEL4_INLINE_FUNC seL4_Word
+seL4_BenchmarkGetHistogram(seL4_Word index);
+#endif
+
 /**
  * @xmlonly <manual name="Null Syscall" label="sel4_benchmarknullsyscall"/> @endxmlonly
  * @brief Null system call that enters and exits the kernel immediately, for timing kernel traps in microbenchmarks.
@@ -322,6 +364,99 @@ seL4_BenchmarkResetAllThreadsUtilisation(void);
 
 #endif
 #endif
+
+#ifdef CONFIG_BENCHMARK_LOCK_CONTENTION
+/**
+ * @xmlonly <manual name="Get Lock Contention" label="sel4_benchmarkgetlockcontention"/> @endxmlonly
+ * @brief Get the kernel lock contention counters of a node.
+ *
+ * Get the number of times a node took the kernel lock, and the cycles it spent waiting for and
+ * holding the lock, by kernel entry type. Also get the number of remote calls the node serviced
+ * while waiting and the cycles spent on them. The counters are written into the caller's IPC buffer;
+ * see the definition of the `benchmark_lock_contention_ipc_index` enum for the format.
+ *
+ * @param[in] node The index of the node to get the counters of.
+ * @return A `seL4_InvalidArgument` error if `node` is not valid or the caller has no IPC buffer.
+ */
+LIBSEL4_INLINE_FUNC seL4_Error
+seL4_BenchmarkGetLockContention(seL4_Word node);
+
+/**
+ * @xmlonly <manual name="Reset Lock Contention" label="sel4_benchmarkresetlockcontention"/> @endxmlonly
+ * @brief Reset the kernel lock contention counters of all nodes.
+ *
+ */
+LIBSEL4_INLINE_FUNC void
+seL4_BenchmarkResetLockContention(void);
+#endif
+
+#ifdef CONFIG_FAST_CLEAR_MEMORY
+/**
+ * @xmlonly <manual name="Clear Memory" label="sel4_benchmarkclearmemory"/> @endxmlonly
+ * @brief Time the ways the kernel can clear memory.
+ *
+ * Clear the first 2^`size_bits` bytes of an untyped object with the generic word loop, with the
+ * method the kernel uses for new objects, and with the method it uses to reset untyped memory, in
+ * that order. The cycles each took are written into the caller's IPC buffer; see the definition of
+ * the `benchmark_clear_memory_ipc_index` enum for the format. Dividing 2^`size_bits` by the cycles
+ * gives the bytes cleared per cycle. The memory is cleared without preemption.
+ *
+ * @param[in] untyped A CPtr to an untyped object without children that is not device memory.
+ * @param[in] size_bits Log2 of the number of bytes to clear. Must not exceed the size of the object.
+ * @return A `seL4_InvalidArgument` error if the arguments are not valid or the caller has no IPC
+ *         buffer.
+ */
+LIBSEL4_INLINE_FUNC seL4_Error
+seL4_BenchmarkClearMemory(seL4_CPtr untyped, seL4_Word size_bits);
+#endif
+
+#ifdef CONFIG_BENCHMARK_FASTPATH_EXITS
+/**
+ * @xmlonly <manual name="Get Fastpath Exits" label="sel4_benchmarkgetfastpathexits"/> @endxmlonly
+ * @brief Get the number of times each fastpath check sent a node to the slowpath.
+ *
+ * The counters are written into the caller's IPC buffer; see the definition of the
+ * `benchmark_fastpath_exit` enum for the format.
+ *
+ * @param[in] node The index of the node to get the counters of.
+ * @return A `seL4_InvalidArgument` error if `node` is not valid or the caller has no IPC buffer.
+ */
+LIBSEL4_INLINE_FUNC seL4_Error
+seL4_BenchmarkGetFastpathExits(seL4_Word node);
+
+/**
+ * @xmlonly <manual name="Reset Fastpath Exits" label="sel4_benchmarkresetfastpathexits"/> @endxmlonly
+ * @brief Reset the fastpath exit counters of all nodes.
+ *
+ */
+LIBSEL4_INLINE_FUNC void
+seL4_BenchmarkResetFastpathExits(void);
+#endif
+
+#ifdef CONFIG_BENCHMARK_VCPU_SWITCH
+/**
+ * @xmlonly <manual name="Get VCPU Switch Stats" label="sel4_benchmarkgetvcpuswitchstats"/> @endxmlonly
+ * @brief Get the counters of the costs of switching the hardware to and from a VCPU.
+ *
+ * The counters are written into the caller's IPC buffer; see the definition of the
+ * `benchmark_vcpu_switch_stat` enum for the format.
+ *
+ * @param[in] vcpu A capability to the VCPU to get the counters of.
+ * @return A `seL4_InvalidArgument` error if `vcpu` is not a VCPU capability or the caller has no IPC buffer.
+ */
+LIBSEL4_INLINE_FUNC seL4_Error
+seL4_BenchmarkGetVCPUSwitchStats(seL4_CPtr vcpu);
+
+/**
+ * @xmlonly <manual name="Reset VCPU Switch Stats" label="sel4_benchmarkresetvcpuswitchstats"/> @endxmlonly
+ * @brief Reset the switch cost counters of a VCPU.
+ *
+ * @param[in] vcpu A capability to the VCPU to reset the counters of.
+ * @return A `seL4_InvalidArgument` error if `vcpu` is not a VCPU capability.
+ */
+LIBSEL4_INLINE_FUNC seL4_Error
+seL4_BenchmarkResetVCPUSwitchStats(seL4_CPtr vcpu);
+#endif
 #endif
 /** @} */
 
@@ -406,3 +541,29 @@ LIBSEL4_INLINE_FUNC void
 seL4_SetTLSBase(seL4_Word tls_base);
 #endif
 
+#ifdef CONFIG_BATCH_INVOCATION
+/**
+ * @xmlonly <manual name="Batch Invoke" label="sel4_batchinvoke"/> @endxmlonly
+ * @brief Perform a batch of invocations held in the IPC buffer.
+ *
+ * The first `length` message words of the IPC buffer hold a batch header followed by records.
+ * Message word `seL4_Batch_Completed` counts the records that have been performed, and message word
+ * `seL4_Batch_NextRecord` holds the offset of the next record to perform. Each record is a
+ * `seL4_MessageInfo_t` with the label, number of extra caps and number of arguments of the invocation,
+ * followed by the invoked capability, the extra capabilities and the arguments.
+ *
+ * Records are performed in order as if by `seL4_Send`, so they return no results, and endpoint,
+ * notification and reply capabilities cannot be invoked. The kernel may be preempted between records
+ * and resumes from the next record. The batch stops at the first record that fails, which is record
+ * number `seL4_Batch_Completed`.
+ *
+ * The `seL4_Batch_t` helpers and the generated `_Batch` variants of the object invocations build batches
+ * and perform them.
+ *
+ * @param length Number of message words in the batch, including the header.
+ * @return The error of the record that failed, or `seL4_NoError` if all records were performed.
+ */
+LIBSEL4_INLINE_FUNC seL4_Error
+seL4_BatchInvoke(seL4_Word length);
+#endif
+
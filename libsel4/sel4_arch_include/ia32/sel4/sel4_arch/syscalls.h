@@ -961,6 +961,19 @@ LIBSEL4_INLINE_FUNC seL4_Error seL4_BenchmarkSetLogBuffer(seL4_Word frame_cptr)
     return (seL4_Error) frame_cptr;
 }
 
+#ifdef CONFIG_BENCHMARK_ENTRY_HISTOGRAMS
+LIBSEL4_INLINE_FUNC seL4_Word seL4_BenchmarkGetHistogram(seL4_Word index)
+{
+    seL4_Word unused0 = 0;
+    seL4_Word unused1 = 0;
+    LIBSEL4_UNUSED seL4_Word unused2 = 0;
+
+    x86_sys_send_recv(seL4_SysBenchmarkGetHistogram, index, &index, 0, &unused0, &unused1, MCS_COND(0, &unused2));
+
+    return index;
+}
+#endif /* CONFIG_BENCHMARK_ENTRY_HISTOGRAMS */
+
 
 LIBSEL4_INLINE_FUNC void seL4_BenchmarkNullSyscall(void)
 {
@@ -1022,6 +1035,64 @@ LIBSEL4_INLINE_FUNC seL4_Word seL4_BenchmarkResetAllThreadsUtilisation(void)
 
 #endif /* CONFIG_DEBUG_BUILD */
 #endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
+
+#ifdef CONFIG_BENCHMARK_LOCK_CONTENTION
+LIBSEL4_INLINE_FUNC seL4_Error seL4_BenchmarkGetLockContention(seL4_Word node)
+{
+    seL4_Word unused0 = 0;
+    seL4_Word unused1 = 0;
+    LIBSEL4_UNUSED seL4_Word unused2 = 0;
+
+    x86_sys_send_recv(seL4_SysBenchmarkGetLockContention, node, &node, 0, &unused0, &unused1, MCS_COND(0, &unused2));
+
+    return (seL4_Error) node;
+}
+
+LIBSEL4_INLINE_FUNC void seL4_BenchmarkResetLockContention(void)
+{
+    seL4_Word unused0 = 0;
+    seL4_Word unused1 = 0;
+    seL4_Word unused2 = 0;
+    LIBSEL4_UNUSED seL4_Word unused3 = 0;
+
+    x86_sys_send_recv(seL4_SysBenchmarkResetLockContention, 0, &unused0, 0, &unused1, &unused2, MCS_COND(0, &unused3));
+}
+#endif /* CONFIG_BENCHMARK_LOCK_CONTENTION */
+
+#ifdef CONFIG_FAST_CLEAR_MEMORY
+LIBSEL4_INLINE_FUNC seL4_Error seL4_BenchmarkClearMemory(seL4_CPtr untyped, seL4_Word size_bits)
+{
+    seL4_Word unused0 = 0;
+    LIBSEL4_UNUSED seL4_Word unused1 = 0;
+
+    x86_sys_send_recv(seL4_SysBenchmarkClearMemory, untyped, &untyped, 0, &unused0, &size_bits, MCS_COND(0, &unused1));
+
+    return (seL4_Error) untyped;
+}
+#endif /* CONFIG_FAST_CLEAR_MEMORY */
+
+#ifdef CONFIG_BENCHMARK_FASTPATH_EXITS
+LIBSEL4_INLINE_FUNC seL4_Error seL4_BenchmarkGetFastpathExits(seL4_Word node)
+{
+    seL4_Word unused0 = 0;
+    seL4_Word unused1 = 0;
+    LIBSEL4_UNUSED seL4_Word unused2 = 0;
+
+    x86_sys_send_recv(seL4_SysBenchmarkGetFastpathExits, node, &node, 0, &unused0, &unused1, MCS_COND(0, &unused2));
+
+    return (seL4_Error) node;
+}
+
+LIBSEL4_INLINE_FUNC void seL4_BenchmarkResetFastpathExits(void)
+{
+    seL4_Word unused0 = 0;
+    seL4_Word unused1 = 0;
+    seL4_Word unused2 = 0;
+    LIBSEL4_UNUSED seL4_Word unused3 = 0;
+
+    x86_sys_send_recv(seL4_SysBenchmarkResetFastpathExits, 0, &unused0, 0, &unused1, &unused2, MCS_COND(0, &unused3));
+}
+#endif /* CONFIG_BENCHMARK_FASTPATH_EXITS */
 #endif /* CONFIG_ENABLE_BENCHMARKS */
 
 #ifdef CONFIG_SET_TLS_BASE_SELF
@@ -1031,3 +1102,18 @@ LIBSEL4_INLINE_FUNC void seL4_SetTLSBase(seL4_Word tls_base)
     asm volatile("" ::: "memory");
 }
 #endif /* CONFIG_SET_TLS_BASE_SELF */
+
+#ifdef CONFIG_BATCH_INVOCATION
+LIBSEL4_INLINE_FUNC seL4_Error seL4_BatchInvoke(seL4_Word length)
+{
+    seL4_Word unused0 = 0;
+    seL4_Word unused1 = 0;
+    LIBSEL4_UNUSED seL4_Word unused2 = 0;
+    seL4_Word error;
+
+    x86_sys_send_recv(seL4_SysBatchInvoke, 0, &error, seL4_MessageInfo_new(0, 0, 0, length).words[0], &unused0,
+                      &unused1, MCS_COND(0, &unused2));
+
+    return (seL4_Error) error;
+}
+#endif /* CONFIG_BATCH_INVOCATION */
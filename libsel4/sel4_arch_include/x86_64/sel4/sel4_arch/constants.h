@@ -23,7 +23,9 @@
 #define seL4_WordSizeBits       3
 #define seL4_PageBits           12
 #define seL4_SlotBits           5
-#if CONFIG_XSAVE_SIZE >= 832
+#if CONFIG_XSAVE_SIZE >= 832 || \
+    (defined(CONFIG_BULK_RETYPE) && defined(CONFIG_BENCHMARK_TRACK_UTILISATION) && \
+     (defined(CONFIG_ENDPOINT_BADGE_INDEX) || defined(CONFIG_FAST_REVOKE)))
 #define seL4_TCBBits            12
 #else
 #define seL4_TCBBits            11
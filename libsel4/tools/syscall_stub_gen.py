@@ -79,7 +79,7 @@ MAX_MESSAGE_LENGTH = 64
 
 # Headers to include
 INCLUDES = [
-    'sel4/config.h', 'sel4/types.h', 'sel4/sel4_arch/constants.h'
+    'sel4/config.h', 'sel4/types.h', 'sel4/sel4_arch/constants.h', 'sel4/batch.h'
 ]
 
 TYPES = {
@@ -795,6 +795,44 @@ def generate_stub(arch, wordsize, interface_name, method_name, method_id, input_
     return "\n".join(result) + "\n"
 
 
+def generate_batch_stub(wordsize, interface_name, method_name, method_id, input_params, structs):
+    """
+    Generate a stub that adds an invocation to a batch for seL4_BatchInvoke,
+    instead of performing it. The record is marshalled as if only the IPC
+    buffer was used.
+    """
+    result = []
+
+    standard_params = [x for x in input_params if not isinstance(x.type, CapType)]
+    cap_params = [x for x in input_params if isinstance(x.type, CapType)]
+
+    input_expressions = generate_marshal_expressions(standard_params, 0, structs, wordsize)
+    service_cap = cap_params[0].name
+    cap_expressions = [x.name for x in cap_params[1:]]
+
+    result.append("/* Add a %s_%s invocation to a batch. */" % (interface_name, method_name))
+    result.append("LIBSEL4_INLINE seL4_Error")
+    result.append("%s_%s_Batch(seL4_Batch_t *batch, %s)" % (
+        interface_name, method_name, generate_param_list(input_params, [])))
+    result.append("{")
+    result.append("\tseL4_MessageInfo_t tag = seL4_MessageInfo_new(%s, 0, %d, %d);" %
+                  (method_id, len(cap_expressions), len(input_expressions)))
+    result.append("\tseL4_Word *record = seL4_Batch_Reserve(batch, tag, %s);" % service_cap)
+    result.append("")
+    result.append("\tif (record == seL4_Null) {")
+    result.append("\t\treturn seL4_NotEnoughMemory;")
+    result.append("\t}")
+    result.append("")
+    for i in range(len(cap_expressions)):
+        result.append("\trecord[%d] = %s;" % (i, cap_expressions[i]))
+    for i in range(len(input_expressions)):
+        result.append("\trecord[%d] = %s;" % (len(cap_expressions) + i, input_expressions[i]))
+    result.append("\treturn seL4_NoError;")
+    result.append("}")
+
+    return "\n".join(result) + "\n"
+
+
 def get_xml_element_contents(element):
     """
     Converts the contents of an xml element into a string, with all
@@ -1074,6 +1112,22 @@ def generate_stub_file(arch, input_files, output_file, use_only_ipc_buffer, mcs,
         if condition != "":
             result.append("#endif")
 
+    #
+    # Generate stubs that add invocations to a batch. Invocations performed in
+    # a batch return no results, so only methods without outputs get one.
+    #
+    result.append("#ifdef CONFIG_BATCH_INVOCATION")
+    for (interface_name, method_name, method_id, inputs, outputs, condition, _) in methods:
+        if len(outputs) > 0:
+            continue
+        if condition != "":
+            result.append("#if %s" % condition)
+        result.append(generate_batch_stub(wordsize, interface_name, method_name,
+                                          method_id, inputs, structs))
+        if condition != "":
+            result.append("#endif")
+    result.append("#endif /* CONFIG_BATCH_INVOCATION */")
+
     # Write the output
     output = open(output_file, "w")
     output.write("\n".join(result))
@@ -21,6 +21,7 @@
 #include <plat/machine/hardware.h>
 #include <object/interrupt.h>
 #include <model/statedata.h>
+#include <model/preemption.h>
 #include <string.h>
 #include <kernel/traps.h>
 #include <arch/machine.h>
@@ -96,6 +97,11 @@ exception_t handleInterruptEntry(void)
 
 exception_t handleUnknownSyscall(word_t w)
 {
+#ifdef CONFIG_BATCH_INVOCATION
+    if (w == SysBatchInvoke) {
+        return handleBatchSyscall();
+    }
+#endif /* CONFIG_BATCH_INVOCATION */
 #ifdef CONFIG_PRINTING
     if (w == SysDebugPutChar) {
         kernel_putchar(getRegister(NODE_STATE(ksCurThread), capRegister));
@@ -225,6 +231,10 @@ exception_t handleUnknownSyscall(word_t w)
     case SysBenchmarkSetLogBuffer:
         return handle_SysBenchmarkSetLogBuffer();
 #endif /* CONFIG_KERNEL_LOG_BUFFER */
+#ifdef CONFIG_BENCHMARK_ENTRY_HISTOGRAMS
+    case SysBenchmarkGetHistogram:
+        return handle_SysBenchmarkGetHistogram();
+#endif /* CONFIG_BENCHMARK_ENTRY_HISTOGRAMS */
 #ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
     case SysBenchmarkGetThreadUtilisation:
         return handle_SysBenchmarkGetThreadUtilisation();
@@ -237,6 +247,28 @@ exception_t handleUnknownSyscall(word_t w)
         return handle_SysBenchmarkResetAllThreadsUtilisation();
 #endif /* CONFIG_DEBUG_BUILD */
 #endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
+#ifdef CONFIG_BENCHMARK_LOCK_CONTENTION
+    case SysBenchmarkGetLockContention:
+        return handle_SysBenchmarkGetLockContention();
+    case SysBenchmarkResetLockContention:
+        return handle_SysBenchmarkResetLockContention();
+#endif /* CONFIG_BENCHMARK_LOCK_CONTENTION */
+#ifdef CONFIG_FAST_CLEAR_MEMORY
+    case SysBenchmarkClearMemory:
+        return handle_SysBenchmarkClearMemory();
+#endif /* CONFIG_FAST_CLEAR_MEMORY */
+#ifdef CONFIG_BENCHMARK_FASTPATH_EXITS
+    case SysBenchmarkGetFastpathExits:
+        return handle_SysBenchmarkGetFastpathExits();
+    case SysBenchmarkResetFastpathExits:
+        return handle_SysBenchmarkResetFastpathExits();
+#endif /* CONFIG_BENCHMARK_FASTPATH_EXITS */
+#ifdef CONFIG_BENCHMARK_VCPU_SWITCH
+    case SysBenchmarkGetVCPUSwitchStats:
+        return handle_SysBenchmarkGetVCPUSwitchStats();
+    case SysBenchmarkResetVCPUSwitchStats:
+        return handle_SysBenchmarkResetVCPUSwitchStats();
+#endif /* CONFIG_BENCHMARK_VCPU_SWITCH */
     case SysBenchmarkNullSyscall:
         return EXCEPTION_NONE;
     default:
@@ -352,6 +384,9 @@ static exception_t handleInvocation(bool_t isCall, bool_t isBlocking)
         userError("Warning: No IPC buffer for thread. Truncating message length to: %d.", n_msgRegisters);
         length = n_msgRegisters;
     }
+#ifdef CONFIG_TLB_BATCHING
+    beginTLBBatch();
+#endif
 #ifdef CONFIG_KERNEL_MCS
     status = decodeInvocation(seL4_MessageInfo_get_label(info), length,
                               cptr, lu_ret.slot, lu_ret.cap,
@@ -362,6 +397,9 @@ static exception_t handleInvocation(bool_t isCall, bool_t isBlocking)
                               cptr, lu_ret.slot, lu_ret.cap,
                               isBlocking, isCall, buffer);
 #endif
+#ifdef CONFIG_TLB_BATCHING
+    endTLBBatch();
+#endif
 
     if (unlikely(status == EXCEPTION_PREEMPTED)) {
         return status;
@@ -543,6 +581,176 @@ static inline void mcsPreemptionPoint(void)
 #define handleInvocation(isCall, isBlocking, canDonate, firstPhase, cptr) handleInvocation(isCall, isBlocking)
 #endif
 
+#ifdef CONFIG_BATCH_INVOCATION
+/* Each record of a batch is decoded from this buffer, so that decoding does
+ * not overwrite the rest of the batch in the caller's IPC buffer. */
+static seL4_IPCBuffer batch_buffer;
+
+static exception_t invokeBatchRecord(seL4_MessageInfo_t info, cptr_t cptr, word_t *args)
+{
+    tcb_t *thread = NODE_STATE(ksCurThread);
+    word_t *buffer = (word_t *)&batch_buffer;
+    word_t length = seL4_MessageInfo_get_length(info);
+    lookupCapAndSlot_ret_t lu_ret;
+    exception_t status;
+
+    for (word_t i = 0; i < seL4_MessageInfo_get_extraCaps(info); i++) {
+        buffer[seL4_MsgMaxLength + 2 + i] = args[i];
+    }
+    args += seL4_MessageInfo_get_extraCaps(info);
+    for (word_t i = 0; i < length; i++) {
+        if (i < n_msgRegisters) {
+            setRegister(thread, msgRegisters[i], args[i]);
+        } else {
+            buffer[i + 1] = args[i];
+        }
+    }
+
+    lu_ret = lookupCapAndSlot(thread, cptr);
+    if (unlikely(lu_ret.status != EXCEPTION_NONE)) {
+        userError("Batch invocation of invalid cap #%lu.", cptr);
+        current_syscall_error.type = seL4_FailedLookup;
+        current_syscall_error.failedLookupWasSource = false;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    /* Records cannot block, so IPC objects cannot be invoked from a batch. */
+    switch (cap_get_capType(lu_ret.cap)) {
+    case cap_endpoint_cap:
+    case cap_notification_cap:
+    case cap_reply_cap:
+        userError("Batch invocation of IPC object cap #%lu.", cptr);
+        current_syscall_error.type = seL4_IllegalOperation;
+        return EXCEPTION_SYSCALL_ERROR;
+    default:
+        break;
+    }
+
+    status = lookupExtraCaps(thread, buffer, info);
+    if (unlikely(status != EXCEPTION_NONE)) {
+        userError("Lookup of extra caps failed.");
+        current_syscall_error.type = seL4_FailedLookup;
+        current_syscall_error.failedLookupWasSource = false;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+#ifdef CONFIG_KERNEL_MCS
+    return decodeInvocation(seL4_MessageInfo_get_label(info), length,
+                            cptr, lu_ret.slot, lu_ret.cap,
+                            false, false, false, false, buffer);
+#else
+    return decodeInvocation(seL4_MessageInfo_get_label(info), length,
+                            cptr, lu_ret.slot, lu_ret.cap,
+                            false, false, buffer);
+#endif
+}
+
+/* Execute the records of a batch in the caller's IPC buffer in order, until
+ * one fails. Progress is kept in the IPC buffer, so that a preempted batch
+ * resumes with the record it was preempted in when the syscall is restarted. */
+static exception_t handleBatchInvocation(void)
+{
+    tcb_t *thread = NODE_STATE(ksCurThread);
+    seL4_MessageInfo_t info = messageInfoFromWord(getRegister(thread, msgInfoRegister));
+    word_t length = seL4_MessageInfo_get_length(info);
+    word_t *ipcBuffer = lookupIPCBuffer(true, thread);
+    word_t *msg;
+    word_t offset;
+    exception_t status;
+
+    if (unlikely(ipcBuffer == NULL || length < seL4_Batch_HeaderLength)) {
+        userError("Batch invocation requires a writable IPC buffer and a batch header.");
+        setRegister(thread, capRegister, seL4_IllegalOperation);
+        return EXCEPTION_NONE;
+    }
+
+    msg = ipcBuffer + 1;
+    offset = msg[seL4_Batch_NextRecord];
+    while (offset < length) {
+        seL4_MessageInfo_t record;
+        word_t next;
+
+        if (unlikely(offset < seL4_Batch_HeaderLength || offset + 2 > length)) {
+            userError("Batch record at %lu is out of range.", offset);
+            setRegister(thread, capRegister, seL4_RangeError);
+            return EXCEPTION_NONE;
+        }
+
+        record = messageInfoFromWord(msg[offset]);
+        next = offset + 2 + seL4_MessageInfo_get_extraCaps(record) + seL4_MessageInfo_get_length(record);
+        if (unlikely(next > length)) {
+            userError("Batch record at %lu is truncated.", offset);
+            setRegister(thread, capRegister, seL4_RangeError);
+            return EXCEPTION_NONE;
+        }
+
+#ifdef CONFIG_TLB_BATCHING
+        beginTLBBatch();
+#endif
+        status = invokeBatchRecord(record, msg[offset + 1], &msg[offset + 2]);
+#ifdef CONFIG_TLB_BATCHING
+        endTLBBatch();
+#endif
+        if (unlikely(status == EXCEPTION_PREEMPTED)) {
+            return status;
+        }
+        if (unlikely(status == EXCEPTION_SYSCALL_ERROR)) {
+            setRegister(thread, capRegister, current_syscall_error.type);
+            return EXCEPTION_NONE;
+        }
+
+        /* The record may have removed the caller's IPC buffer, in which case
+         * progress can no longer be recorded. */
+        if (unlikely(lookupIPCBuffer(true, thread) != ipcBuffer)) {
+            userError("Batch invocation lost its IPC buffer.");
+            if (thread_state_get_tsType(thread->tcbState) == ThreadState_Restart) {
+                setThreadState(thread, ThreadState_Running);
+            }
+            setRegister(thread, capRegister, seL4_IllegalOperation);
+            return EXCEPTION_NONE;
+        }
+
+        msg[seL4_Batch_Completed]++;
+        msg[seL4_Batch_NextRecord] = next;
+        offset = next;
+
+        /* The record stopped the caller, which continues with the next
+         * record if it is restarted. */
+        if (unlikely(thread_state_get_tsType(thread->tcbState) != ThreadState_Restart)) {
+            return EXCEPTION_NONE;
+        }
+        setThreadState(thread, ThreadState_Running);
+
+        if (offset < length) {
+            status = preemptionPoint();
+            if (unlikely(status != EXCEPTION_NONE)) {
+                setThreadState(thread, ThreadState_Restart);
+                return status;
+            }
+        }
+    }
+
+    setRegister(thread, capRegister, seL4_NoError);
+    return EXCEPTION_NONE;
+}
+
+exception_t handleBatchSyscall(void)
+{
+    MCS_DO_IF_BUDGET({
+        exception_t ret = handleBatchInvocation();
+        if (unlikely(ret != EXCEPTION_NONE))
+        {
+            mcsPreemptionPoint();
+            checkInterrupt(/* was_interrupt_entry */ false);
+        }
+    })
+    schedule();
+    activateThread();
+
+    return EXCEPTION_NONE;
+}
+#endif /* CONFIG_BATCH_INVOCATION */
+
 static void handleYield(void)
 {
 #ifdef CONFIG_KERNEL_MCS
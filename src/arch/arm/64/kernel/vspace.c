@@ -16,6 +16,7 @@
 #include <machine/io.h>
 #include <machine/debug.h>
 #include <model/statedata.h>
+#include <model/preemption.h>
 #include <object/cnode.h>
 #include <object/untyped.h>
 #include <arch/api/invocation.h>
@@ -1102,6 +1103,110 @@ static inline void invalidateTLBByASIDVA(asid_t asid, vptr_t vaddr)
 #endif
 }
 
+#ifdef CONFIG_TLB_BATCHING
+static inline void invalidateTLBByASIDRange(asid_t asid, vptr_t vaddr, word_t pages)
+{
+    if (pages > CONFIG_TLB_FLUSH_ASID_THRESHOLD &&
+        !(config_set(CONFIG_ARM_TLBI_RANGE) && pages < TLBI_RANGE_MAX_PAGES)) {
+        invalidateTLBByASID(asid);
+        return;
+    }
+
+#ifdef CONFIG_ARM_SMMU
+    word_t bind_cb = getASIDBindCB(asid);
+    if (unlikely(bind_cb)) {
+#ifdef CONFIG_ARM_SMMU_V3
+        /* Per page commands are queued and complete behind one CMD_SYNC
+         * at the end of the batch. Ranges above the threshold are
+         * invalidated by ASID with a single command, even when the CPU
+         * TLBs are invalidated with range operations. */
+        if (pages > CONFIG_TLB_FLUSH_ASID_THRESHOLD) {
+            invalidateSMMUTLBByASID(asid, bind_cb);
+        } else {
+            for (word_t i = 0; i < pages; i++) {
+                invalidateSMMUTLBByASIDVA(asid, vaddr + (i << seL4_PageBits), bind_cb);
+            }
+        }
+#else
+        invalidateSMMUTLBByASID(asid, bind_cb);
+#endif
+    }
+#endif
+#ifdef CONFIG_ARM_HYPERVISOR_SUPPORT
+    asid_map_t asid_map;
+
+    asid_map = findMapForASID(asid);
+    if (!asid_map_asid_map_vspace_get_stored_vmid_valid(asid_map)) {
+        return;
+    }
+    uint64_t hw_asid = asid_map_asid_map_vspace_get_stored_hw_vmid(asid_map);
+    for (word_t i = 0; i < pages; i++) {
+        invalidateTranslationSingle((hw_asid << 48) | ((vaddr >> seL4_PageBits) + i));
+    }
+#else
+    invalidateTranslationRange((asid << 48) | vaddr >> seL4_PageBits, pages);
+#endif
+}
+
+/* The pages unmapped since beginTLBBatch, as the span of addresses that
+ * contains them. Unmapping in another address space flushes the batch. */
+typedef struct tlb_batch {
+    bool_t open;
+    asid_t asid;
+    vptr_t start;
+    vptr_t end;
+} tlb_batch_t;
+
+static tlb_batch_t tlb_batch;
+
+static void flushTLBBatch(void)
+{
+    if (tlb_batch.asid != asidInvalid) {
+        invalidateTLBByASIDRange(tlb_batch.asid, tlb_batch.start,
+                                 ((tlb_batch.end - tlb_batch.start) >> seL4_PageBits) + 1);
+        tlb_batch.asid = asidInvalid;
+    }
+}
+
+void beginTLBBatch(void)
+{
+    assert(!tlb_batch.open && tlb_batch.asid == asidInvalid);
+    tlb_batch.open = true;
+#if defined(CONFIG_ARM_SMMU) && defined(CONFIG_ARM_SMMU_V3)
+    smmu_tlb_batch_begin();
+#endif
+}
+
+void endTLBBatch(void)
+{
+    flushTLBBatch();
+    tlb_batch.open = false;
+#if defined(CONFIG_ARM_SMMU) && defined(CONFIG_ARM_SMMU_V3)
+    /* wait for the SMMU commands queued by the invocation */
+    smmu_tlb_batch_end();
+#endif
+}
+
+static void invalidateTLBByASIDVADeferred(asid_t asid, vptr_t vaddr)
+{
+    if (!tlb_batch.open) {
+        invalidateTLBByASIDVA(asid, vaddr);
+        return;
+    }
+
+    if (tlb_batch.asid != asid) {
+        flushTLBBatch();
+        tlb_batch.asid = asid;
+        tlb_batch.start = vaddr;
+        tlb_batch.end = vaddr;
+        return;
+    }
+
+    tlb_batch.start = MIN(tlb_batch.start, vaddr);
+    tlb_batch.end = MAX(tlb_batch.end, vaddr);
+}
+#endif /* CONFIG_TLB_BATCHING */
+
 
 void unmapPageTable(asid_t asid, vptr_t vptr, pte_t *target_pt)
 {
@@ -1130,7 +1235,14 @@ void unmapPageTable(asid_t asid, vptr_t vptr, pte_t *target_pt)
     assert(ptSlot != NULL);
     *ptSlot = pte_pte_invalid_new();
     cleanByVA_PoU((vptr_t)ptSlot, pptr_to_paddr(ptSlot));
+#ifdef CONFIG_TLB_BATCHING
+    /* The walk now stops at the cleared slot, which mapped everything that
+     * the page table covered. */
+    word_t bits = lookupPTSlot(find_ret.vspace_root, vptr).ptBitsLeft;
+    invalidateTLBByASIDRange(asid, vptr & ~MASK(bits), BIT(bits - seL4_PageBits));
+#else
     invalidateTLBByASID(asid);
+#endif
 }
 
 void unmapPage(vm_page_size_t page_size, asid_t asid, vptr_t vptr, pptr_t pptr)
@@ -1164,7 +1276,11 @@ void unmapPage(vm_page_size_t page_size, asid_t asid, vptr_t vptr, pptr_t pptr)
     *(lu_ret.ptSlot) = pte_pte_invalid_new();
     cleanByVA_PoU((vptr_t)lu_ret.ptSlot, pptr_to_paddr(lu_ret.ptSlot));
     assert(asid < BIT(16));
+#ifdef CONFIG_TLB_BATCHING
+    invalidateTLBByASIDVADeferred(asid, vptr);
+#else
     invalidateTLBByASIDVA(asid, vptr);
+#endif
 }
 
 void deleteASID(asid_t asid, vspace_root_t *vspace)
@@ -1178,6 +1294,12 @@ void deleteASID(asid_t asid, vspace_root_t *vspace)
         if (asid_map_get_type(asid_map) == asid_map_asid_map_vspace &&
             (vspace_root_t *)asid_map_asid_map_vspace_get_vspace_root(asid_map) == vspace) {
             invalidateTLBByASID(asid);
+#ifdef CONFIG_TLB_BATCHING
+            /* pending invalidations for this ASID are covered by the flush above */
+            if (tlb_batch.asid == asid) {
+                tlb_batch.asid = asidInvalid;
+            }
+#endif
 #ifdef CONFIG_ARM_HYPERVISOR_SUPPORT
             invalidateASIDEntry(asid);
 #endif
@@ -1203,6 +1325,11 @@ void deleteASIDPool(asid_t asid_base, asid_pool_t *pool)
 #endif
             }
         }
+#ifdef CONFIG_TLB_BATCHING
+        if (ASID_HIGH(tlb_batch.asid) == ASID_HIGH(asid_base)) {
+            tlb_batch.asid = asidInvalid;
+        }
+#endif
         armKSASIDTable[ASID_HIGH(asid_base)] = NULL;
         setVMRoot(NODE_STATE(ksCurThread));
     }
@@ -1313,6 +1440,102 @@ static exception_t performPageInvocationMap(asid_t asid, cap_t cap, cte_t *ctSlo
     return EXCEPTION_NONE;
 }
 
+#ifdef CONFIG_FRAME_RANGE_INVOCATIONS
+static exception_t performPageTableInvocationMapFrames(asid_t asid, vptr_t vaddr, pte_t *ptSlot,
+                                                       cte_t *frameSlots, word_t numFrames,
+                                                       seL4_CapRights_t rightsMask,
+                                                       vm_attributes_t attributes)
+{
+    exception_t status = EXCEPTION_NONE;
+    bool_t tlbflush_required = false;
+    word_t i;
+
+    for (i = 0; i < numFrames; i++) {
+        /* Frames that have already been mapped are skipped on restart, so
+         * there is no need to track progress anywhere else. */
+        if (i > 0) {
+            status = preemptionPoint();
+            if (unlikely(status != EXCEPTION_NONE)) {
+                break;
+            }
+        }
+
+        cap_t cap = frameSlots[i].cap;
+        vm_rights_t vmRights = maskVMRights(cap_frame_cap_get_capFVMRights(cap), rightsMask);
+        paddr_t base = pptr_to_paddr((void *)cap_frame_cap_get_capFBasePtr(cap));
+        pte_t pte = makeUserPagePTE(base, vmRights, attributes, ARMSmallPage);
+
+        if (ptSlot[i].words[0] != pte.words[0]) {
+            tlbflush_required |= pte_ptr_get_valid(&ptSlot[i]);
+            ptSlot[i] = pte;
+        }
+
+        cap = cap_frame_cap_set_capFMappedASID(cap, asid);
+        cap = cap_frame_cap_set_capFMappedAddress(cap, vaddr + (i << seL4_PageBits));
+        frameSlots[i].cap = cap;
+    }
+
+    cleanCacheRange_PoU((vptr_t)ptSlot, (vptr_t)(ptSlot + i) - 1, pptr_to_paddr(ptSlot));
+    if (unlikely(tlbflush_required)) {
+        assert(asid < BIT(16));
+#ifdef CONFIG_TLB_BATCHING
+        invalidateTLBByASIDRange(asid, vaddr, i);
+#else
+        invalidateTLBByASID(asid);
+#endif
+    }
+
+    return status;
+}
+
+static exception_t performPageTableInvocationUnmapFrames(asid_t asid, vptr_t base, pte_t *pt,
+                                                         cte_t *frameSlots, word_t numFrames)
+{
+    exception_t status = EXCEPTION_NONE;
+    pte_t *first = pt + BIT(PT_INDEX_BITS);
+    pte_t *last = NULL;
+
+    for (word_t i = 0; i < numFrames; i++) {
+        if (i > 0) {
+            status = preemptionPoint();
+            if (unlikely(status != EXCEPTION_NONE)) {
+                break;
+            }
+        }
+
+        cap_t cap = frameSlots[i].cap;
+        if (cap_frame_cap_get_capFMappedASID(cap) == asidInvalid) {
+            continue;
+        }
+
+        vptr_t vaddr = cap_frame_cap_get_capFMappedAddress(cap);
+        pte_t *ptSlot = pt + ((vaddr >> seL4_PageBits) & MASK(PT_INDEX_BITS));
+        if (pte_is_page_type(*ptSlot) &&
+            pte_get_page_base_address(*ptSlot) == pptr_to_paddr((void *)cap_frame_cap_get_capFBasePtr(cap))) {
+            *ptSlot = pte_pte_invalid_new();
+            first = MIN(first, ptSlot);
+            last = MAX(last, ptSlot);
+        }
+
+        cap = cap_frame_cap_set_capFMappedAddress(cap, 0);
+        cap = cap_frame_cap_set_capFMappedASID(cap, asidInvalid);
+        frameSlots[i].cap = cap;
+    }
+
+    if (last != NULL) {
+        cleanCacheRange_PoU((vptr_t)first, (vptr_t)(last + 1) - 1, pptr_to_paddr(first));
+        assert(asid < BIT(16));
+#ifdef CONFIG_TLB_BATCHING
+        invalidateTLBByASIDRange(asid, base + ((first - pt) << seL4_PageBits), last - first + 1);
+#else
+        invalidateTLBByASID(asid);
+#endif
+    }
+
+    return status;
+}
+#endif /* CONFIG_FRAME_RANGE_INVOCATIONS */
+
 static exception_t performPageInvocationUnmap(cap_t cap, cte_t *ctSlot)
 {
     if (cap_frame_cap_get_capFMappedASID(cap) != 0) {
@@ -1516,6 +1739,176 @@ static exception_t decodeARMVSpaceRootInvocation(word_t invLabel, word_t length,
 }
 
 
+#ifdef CONFIG_FRAME_RANGE_INVOCATIONS
+/* Find the slots of a mapped leaf page table by walking from the root of its
+ * address space, so that stale caps of a deleted ASID are rejected. */
+static lookupPTSlot_ret_t lookupLeafPTSlot(cap_t cap, vptr_t vaddr)
+{
+    lookupPTSlot_ret_t ret = { .ptSlot = NULL, .ptBitsLeft = 0 };
+    pte_t *pt = PT_PTR(cap_page_table_cap_get_capPTBasePtr(cap));
+    findVSpaceForASID_ret_t find_ret;
+
+    if (unlikely(!cap_page_table_cap_get_capPTIsMapped(cap))) {
+        current_syscall_error.type = seL4_InvalidCapability;
+        current_syscall_error.invalidCapNumber = 0;
+        return ret;
+    }
+
+    find_ret = findVSpaceForASID(cap_page_table_cap_get_capPTMappedASID(cap));
+    if (unlikely(find_ret.status != EXCEPTION_NONE)) {
+        current_syscall_error.type = seL4_FailedLookup;
+        current_syscall_error.failedLookupWasSource = false;
+        return ret;
+    }
+
+    ret = lookupPTSlot(find_ret.vspace_root, vaddr);
+    if (unlikely(ret.ptBitsLeft != seL4_PageBits ||
+                 ret.ptSlot < pt || ret.ptSlot >= pt + BIT(PT_INDEX_BITS))) {
+        current_syscall_error.type = seL4_InvalidArgument;
+        current_syscall_error.invalidArgumentNumber = 0;
+        ret.ptSlot = NULL;
+    }
+
+    return ret;
+}
+
+static exception_t decodeARMPageTableMapFrames(word_t length, cap_t cap, word_t *buffer)
+{
+    vptr_t vaddr;
+    seL4_CapRights_t rightsMask;
+    vm_attributes_t attributes;
+    word_t numFrames;
+    asid_t asid;
+    lookupPTSlot_ret_t ptSlot;
+    lookupSlot_ret_t window;
+
+    if (unlikely(length < 7 || current_extra_caps.excaprefs[0] == NULL)) {
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    vaddr = getSyscallArg(0, buffer);
+    rightsMask = rightsFromWord(getSyscallArg(1, buffer));
+    attributes = vmAttributesFromWord(getSyscallArg(2, buffer));
+    numFrames = getSyscallArg(6, buffer);
+
+    if (unlikely(!IS_ALIGNED(vaddr, seL4_PageBits))) {
+        current_syscall_error.type = seL4_AlignmentError;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    ptSlot = lookupLeafPTSlot(cap, vaddr);
+    if (unlikely(ptSlot.ptSlot == NULL)) {
+        userError("ARMPageTableMapFrames: 0x%"SEL4_PRIx_word" is not covered by this page table.", vaddr);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+    asid = cap_page_table_cap_get_capPTMappedASID(cap);
+
+    /* Only frames for this leaf table can be mapped in a single invocation. */
+    window = lookupSourceWindow(current_extra_caps.excaprefs[0]->cap,
+                                getSyscallArg(3, buffer), getSyscallArg(4, buffer),
+                                getSyscallArg(5, buffer), numFrames,
+                                PT_PTR(cap_page_table_cap_get_capPTBasePtr(cap)) +
+                                BIT(PT_INDEX_BITS) - ptSlot.ptSlot);
+    if (unlikely(window.status != EXCEPTION_NONE)) {
+        userError("ARMPageTableMapFrames: Invalid frame window.");
+        return window.status;
+    }
+
+    if (unlikely(vaddr + (numFrames << seL4_PageBits) - 1 > USER_TOP)) {
+        current_syscall_error.type = seL4_InvalidArgument;
+        current_syscall_error.invalidArgumentNumber = 0;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    for (word_t i = 0; i < numFrames; i++) {
+        cap_t frameCap = window.slot[i].cap;
+        asid_t frame_asid;
+
+        if (unlikely(cap_get_capType(frameCap) != cap_frame_cap ||
+                     cap_frame_cap_get_capFSize(frameCap) != ARMSmallPage)) {
+            userError("ARMPageTableMapFrames: Slot %"SEL4_PRIu_word" of the window is not a small frame.", i);
+            current_syscall_error.type = seL4_InvalidCapability;
+            current_syscall_error.invalidCapNumber = 1;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+
+        /* A frame may only be remapped at the same address. */
+        frame_asid = cap_frame_cap_get_capFMappedASID(frameCap);
+        if (frame_asid != asidInvalid &&
+            (frame_asid != asid ||
+             cap_frame_cap_get_capFMappedAddress(frameCap) != vaddr + (i << seL4_PageBits))) {
+            userError("ARMPageTableMapFrames: Slot %"SEL4_PRIu_word" of the window is mapped elsewhere.", i);
+            current_syscall_error.type = seL4_InvalidCapability;
+            current_syscall_error.invalidCapNumber = 1;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+    }
+
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    return performPageTableInvocationMapFrames(asid, vaddr, ptSlot.ptSlot, window.slot,
+                                               numFrames, rightsMask, attributes);
+}
+
+static exception_t decodeARMPageTableUnmapFrames(word_t length, cap_t cap, word_t *buffer)
+{
+    pte_t *pt = PT_PTR(cap_page_table_cap_get_capPTBasePtr(cap));
+    vptr_t base = cap_page_table_cap_get_capPTMappedAddress(cap);
+    word_t numFrames;
+    asid_t asid;
+    lookupPTSlot_ret_t ptSlot;
+    lookupSlot_ret_t window;
+
+    if (unlikely(length < 4 || current_extra_caps.excaprefs[0] == NULL)) {
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    numFrames = getSyscallArg(3, buffer);
+
+    ptSlot = lookupLeafPTSlot(cap, base);
+    if (unlikely(ptSlot.ptSlot == NULL)) {
+        userError("ARMPageTableUnmapFrames: Page table is not mapped.");
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+    asid = cap_page_table_cap_get_capPTMappedASID(cap);
+
+    window = lookupSourceWindow(current_extra_caps.excaprefs[0]->cap,
+                                getSyscallArg(0, buffer), getSyscallArg(1, buffer),
+                                getSyscallArg(2, buffer), numFrames, BIT(PT_INDEX_BITS));
+    if (unlikely(window.status != EXCEPTION_NONE)) {
+        userError("ARMPageTableUnmapFrames: Invalid frame window.");
+        return window.status;
+    }
+
+    for (word_t i = 0; i < numFrames; i++) {
+        cap_t frameCap = window.slot[i].cap;
+
+        if (unlikely(cap_get_capType(frameCap) != cap_frame_cap ||
+                     cap_frame_cap_get_capFSize(frameCap) != ARMSmallPage)) {
+            userError("ARMPageTableUnmapFrames: Slot %"SEL4_PRIu_word" of the window is not a small frame.", i);
+            current_syscall_error.type = seL4_InvalidCapability;
+            current_syscall_error.invalidCapNumber = 1;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+
+        /* Frames that are already unmapped are skipped, which makes this
+         * operation restartable after preemption. */
+        if (cap_frame_cap_get_capFMappedASID(frameCap) != asidInvalid &&
+            (cap_frame_cap_get_capFMappedASID(frameCap) != asid ||
+             (cap_frame_cap_get_capFMappedAddress(frameCap) & ~MASK(seL4_PageBits + PT_INDEX_BITS)) != base)) {
+            userError("ARMPageTableUnmapFrames: Slot %"SEL4_PRIu_word" of the window is not mapped by this page table.", i);
+            current_syscall_error.type = seL4_InvalidCapability;
+            current_syscall_error.invalidCapNumber = 1;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+    }
+
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    return performPageTableInvocationUnmapFrames(asid, base, pt, window.slot, numFrames);
+}
+#endif /* CONFIG_FRAME_RANGE_INVOCATIONS */
+
 static exception_t decodeARMPageTableInvocation(word_t invLabel, word_t length,
                                                 cte_t *cte, cap_t cap, word_t *buffer)
 {
@@ -1537,6 +1930,16 @@ static exception_t decodeARMPageTableInvocation(word_t invLabel, word_t length,
         return performPageTableInvocationUnmap(cap, cte);
     }
 
+#ifdef CONFIG_FRAME_RANGE_INVOCATIONS
+    if (invLabel == ARMPageTableMapFrames) {
+        return decodeARMPageTableMapFrames(length, cap, buffer);
+    }
+
+    if (invLabel == ARMPageTableUnmapFrames) {
+        return decodeARMPageTableUnmapFrames(length, cap, buffer);
+    }
+#endif
+
     if (unlikely(invLabel != ARMPageTableMap)) {
         current_syscall_error.type = seL4_IllegalOperation;
         return EXCEPTION_SYSCALL_ERROR;
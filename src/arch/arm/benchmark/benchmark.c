@@ -8,8 +8,10 @@
 #include <arch/benchmark.h>
 
 #if CONFIG_MAX_NUM_TRACE_POINTS > 0
+#ifndef CONFIG_LOG_BUFFER_PER_NODE
 timestamp_t ksEntries[CONFIG_MAX_NUM_TRACE_POINTS];
 bool_t ksStarted[CONFIG_MAX_NUM_TRACE_POINTS];
+#endif
 timestamp_t ksExit;
 seL4_Word ksLogIndex = 0;
 seL4_Word ksLogIndexFinalized = 0;
@@ -19,7 +19,7 @@
 
 void VISIBLE NORETURN c_handle_undefined_instruction(void)
 {
-    NODE_LOCK_SYS;
+    NODE_LOCK_FAULT;
     c_entry_hook();
 
 #ifdef TRACK_KERNEL_ENTRIES
@@ -36,6 +36,11 @@ void VISIBLE NORETURN c_handle_undefined_instruction(void)
     if (isDebugFault(esr)) {
         handleDebugFaultEvent(esr);
     } else
+#endif
+#ifdef CONFIG_FPU_LAZY_SWITCH
+    if (((esr >> ESR_EC_SHIFT) & 0x3f) == ESR_EL1_EC_ENFP && handleLazyFPUFault()) {
+        /* The thread retries the instruction with its FPU state loaded */
+    } else
 #endif
     {
         handleUserLevelFault(esr, 0);
@@ -56,7 +61,7 @@ void NORETURN vm_fault_slowpath(vm_fault_type_t type)
 
 static inline void NORETURN c_handle_vm_fault(vm_fault_type_t type)
 {
-    NODE_LOCK_SYS;
+    NODE_LOCK_FAULT;
     c_entry_hook();
 
 #ifdef TRACK_KERNEL_ENTRIES
@@ -101,6 +106,8 @@ void VISIBLE NORETURN c_handle_interrupt(void)
 
 void NORETURN slowpath(syscall_t syscall)
 {
+    NODE_LOCK_UPGRADE;
+
     if (unlikely(syscall < SYSCALL_MIN || syscall > SYSCALL_MAX)) {
 #ifdef TRACK_KERNEL_ENTRIES
         ksKernelEntry.path = Entry_UnknownSyscall;
@@ -139,7 +146,7 @@ void VISIBLE c_handle_syscall(word_t cptr, word_t msgInfo, syscall_t syscall)
 ALIGN(L1_CACHE_LINE_SIZE)
 void VISIBLE c_handle_fastpath_call(word_t cptr, word_t msgInfo)
 {
-    NODE_LOCK_SYS;
+    NODE_LOCK_SHARED_SYS;
 
     c_entry_hook();
 #ifdef TRACK_KERNEL_ENTRIES
@@ -176,7 +183,7 @@ void VISIBLE c_handle_fastpath_reply_recv(word_t cptr, word_t msgInfo, word_t re
 void VISIBLE c_handle_fastpath_reply_recv(word_t cptr, word_t msgInfo)
 #endif
 {
-    NODE_LOCK_SYS;
+    NODE_LOCK_SHARED_SYS;
 
     c_entry_hook();
 #ifdef TRACK_KERNEL_ENTRIES
@@ -197,7 +204,7 @@ void VISIBLE c_handle_fastpath_reply_recv(word_t cptr, word_t msgInfo)
 #ifdef CONFIG_ARM_HYPERVISOR_SUPPORT
 VISIBLE NORETURN void c_handle_vcpu_fault(word_t hsr)
 {
-    NODE_LOCK_SYS;
+    NODE_LOCK_FAULT;
 
     c_entry_hook();
 
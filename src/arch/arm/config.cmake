@@ -124,8 +124,21 @@ config_option(
   DEPENDS "KernelArchARM;KernelArmCortexA15"
   DEFAULT_DISABLED OFF)
 
-config_option(KernelArmSMMU ARM_SMMU "Enable SystemMMU" DEFAULT ON DEPENDS "KernelPlatformTx2"
-              DEFAULT_DISABLED OFF)
+# Use the SMMUv3 driver for the SystemMMU. Only set by platforms whose SystemMMU
+# implements SMMUv3 and that provide its device and stream ID range, currently
+# qemu-arm-virt with QEMU_SMMU_VERSION 3. TLB invalidations are queued as
+# commands, and with KernelTLBBatching all of them issued by an invocation are
+# waited for by a single CMD_SYNC. This is not verified.
+if(KernelArmSMMUv3 AND NOT KernelPlatformQEMUArmVirt)
+  message(FATAL_ERROR "KernelArmSMMUv3 is not supported on this platform")
+endif()
+if(KernelArmSMMUv3 AND KernelVerificationBuild)
+  message(FATAL_ERROR "KernelArmSMMUv3 is not supported in verification builds")
+endif()
+config_set(KernelArmSMMUv3 ARM_SMMU_V3 "${KernelArmSMMUv3}")
+
+config_option(KernelArmSMMU ARM_SMMU "Enable SystemMMU" DEFAULT ON
+              DEPENDS "KernelPlatformTx2 OR KernelArmSMMUv3" DEFAULT_DISABLED OFF)
 
 config_option(KernelTk1SMMU TK1_SMMU "Enable SystemMMU for the Tegra TK1 SoC" DEFAULT OFF
               DEPENDS "KernelPlatformTK1")
@@ -206,6 +219,25 @@ config_option(
   DEPENDS "KernelSel4ArchAarch64;NOT KernelVerificationBuild")
 mark_as_advanced(KernelAArch64SErrorIgnore)
 
+config_option(
+  KernelArmVCPULazySwitch ARM_VCPU_LAZY_SWITCH
+  "When switching from one VCPU to another, only read back the VGIC list registers \
+    that are not empty, and only write the VGIC and EL1 registers whose values differ \
+    from those of the VCPU that was saved. This option is not verified."
+  DEFAULT OFF
+  DEPENDS "KernelSel4ArchAarch64;KernelArmHypervisorSupport;NOT KernelVerificationBuild"
+  DEFAULT_DISABLED OFF)
+
+config_option(
+  KernelArmVCPUInjectFastpath ARM_VCPU_INJECT_FASTPATH
+  "Perform VCPU InjectIRQ invocations on the IPC fastpath, and add the InjectIRQs \
+    invocation, which injects several IRQs at once. Injections into a VCPU on another \
+    core are left for that core to load into the VGIC when it takes an IPI, without \
+    waiting for it. This option is not verified."
+  DEFAULT OFF
+  DEPENDS "KernelSel4ArchAarch64;KernelArmHypervisorSupport;KernelFastpath;NOT KernelVerificationBuild"
+  DEFAULT_DISABLED OFF)
+
 config_option(
   KernelAllowSMCCalls
   ALLOW_SMC_CALLS
@@ -25,7 +25,7 @@
 #include <arch/machine/tlb.h>
 
 #ifdef CONFIG_ARM_SMMU
-#include <drivers/smmu/smmuv2.h>
+#include <plat/platform_gen.h> /* Ensure the platform's SMMU driver header is included */
 #endif
 
 #ifdef ENABLE_SMP_SUPPORT
@@ -147,6 +147,9 @@ BOOT_CODE static void init_irqs(cap_t root_cnode_cap)
 #ifdef ENABLE_SMP_SUPPORT
     setIRQState(IRQIPI, CORE_IRQ_TO_IRQT(getCurrentCPUIndex(), irq_remote_call_ipi));
     setIRQState(IRQIPI, CORE_IRQ_TO_IRQT(getCurrentCPUIndex(), irq_reschedule_ipi));
+#ifdef CONFIG_ARM_VCPU_INJECT_FASTPATH
+    setIRQState(IRQIPI, CORE_IRQ_TO_IRQT(getCurrentCPUIndex(), irq_vcpu_inject_ipi));
+#endif
 #endif
 
     /* provide the IRQ control cap */
@@ -222,6 +225,13 @@ BOOT_CODE static bool_t init_cpu(void)
     setVtable((pptr_t)arm_vector_table);
 #endif /* CONFIG_ARCH_AARCH64 */
 
+#if defined(CONFIG_ARCH_AARCH64) && defined(CONFIG_FAST_CLEAR_MEMORY)
+    /* DC ZVA clears blocks of 4 << BS bytes, unless DZP prohibits it */
+    word_t dczid;
+    MRS("dczid_el0", dczid);
+    armKSDCZVABlockBits = (dczid & DCZID_DZP) ? 0 : (dczid & DCZID_BS_MASK) + 2;
+#endif
+
     haveHWFPU = fpsimd_HWCapTest();
 
     /* Disable FPU to avoid channels where a platform has an FPU but doesn't make use of it */
@@ -279,6 +289,9 @@ BOOT_CODE static bool_t try_init_kernel_secondary_core(void)
     }
     setIRQState(IRQIPI, CORE_IRQ_TO_IRQT(getCurrentCPUIndex(), irq_remote_call_ipi));
     setIRQState(IRQIPI, CORE_IRQ_TO_IRQT(getCurrentCPUIndex(), irq_reschedule_ipi));
+#ifdef CONFIG_ARM_VCPU_INJECT_FASTPATH
+    setIRQState(IRQIPI, CORE_IRQ_TO_IRQT(getCurrentCPUIndex(), irq_vcpu_inject_ipi));
+#endif
     /* Enable per-CPU timer interrupts */
     setIRQState(IRQTimer, CORE_IRQ_TO_IRQT(getCurrentCPUIndex(), KERNEL_TIMER_IRQ));
 #ifdef CONFIG_ARM_HYPERVISOR_SUPPORT
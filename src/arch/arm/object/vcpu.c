@@ -14,6 +14,32 @@
 #include <arch/machine/debug_conf.h>
 #include <drivers/timer/arm_generic.h>
 #include <plat/platform_gen.h> /* Ensure correct GIC header is included */
+#ifdef CONFIG_BENCHMARK_VCPU_SWITCH
+#include <arch/benchmark.h>
+
+#define vcpu_switch_stat_add(vcpu, stat, n) ((vcpu)->switchStats[(stat)] += (n))
+#else
+#define vcpu_switch_stat_add(vcpu, stat, n)
+#endif
+
+#if defined(CONFIG_ARM_VCPU_INJECT_FASTPATH) && defined(ENABLE_SMP_SUPPORT)
+/* Load the IRQs other cores injected into a VCPU loaded on this core into the
+ * VGIC. This is done before the list registers are read, so that they are not
+ * lost, and so that the VGIC holds the state saved for the VCPU. */
+static inline void vcpu_load_pending_lrs(vcpu_t *vcpu)
+{
+    word_t pending = vcpu->pendingLRs;
+
+    while (pending) {
+        word_t i = ctzl(pending);
+        set_gic_vcpu_ctrl_lr(i, vcpu->vgic.lr[i]);
+        pending &= ~BIT(i);
+    }
+    vcpu->pendingLRs = 0;
+}
+#else
+#define vcpu_load_pending_lrs(vcpu)
+#endif
 
 BOOT_CODE void vcpu_boot_init(void)
 {
@@ -33,8 +59,12 @@ static void vcpu_save(vcpu_t *vcpu, bool_t active)
 {
     word_t i;
     word_t lr_num;
+#ifdef CONFIG_ARM_VCPU_LAZY_SWITCH
+    word_t elrsr;
+#endif
 
     assert(vcpu);
+    vcpu_load_pending_lrs(vcpu);
     dsb();
     /* If we aren't active then this state already got stored when
      * we were disabled */
@@ -48,10 +78,29 @@ static void vcpu_save(vcpu_t *vcpu, bool_t active)
     vcpu->vgic.vmcr = get_gic_vcpu_ctrl_vmcr();
     vcpu->vgic.apr = get_gic_vcpu_ctrl_apr();
     lr_num = gic_vcpu_num_list_regs;
+#ifdef CONFIG_ARM_VCPU_LAZY_SWITCH
+    /* An empty list register holds no interrupt and no pending EOI
+     * maintenance, so it is saved as zero without being read back */
+    elrsr = get_gic_vcpu_ctrl_elrsr0();
+    if (lr_num > 32) {
+        elrsr |= (word_t)get_gic_vcpu_ctrl_elrsr1() << 32;
+    }
+    for (i = 0; i < lr_num; i++) {
+        if (elrsr & BIT(i)) {
+            vcpu->vgic.lr[i].words[0] = 0;
+        } else {
+            vcpu->vgic.lr[i] = get_gic_vcpu_ctrl_lr(i);
+            vcpu_switch_stat_add(vcpu, BENCHMARK_VCPU_SWITCH_LRS_SAVED, 1);
+        }
+    }
+#else
     for (i = 0; i < lr_num; i++) {
         vcpu->vgic.lr[i] = get_gic_vcpu_ctrl_lr(i);
     }
+    vcpu_switch_stat_add(vcpu, BENCHMARK_VCPU_SWITCH_LRS_SAVED, lr_num);
+#endif
     armv_vcpu_save(vcpu, active);
+    vcpu_switch_stat_add(vcpu, BENCHMARK_VCPU_SWITCH_SAVES, 1);
 }
 
 
@@ -97,12 +146,64 @@ void vcpu_restore(vcpu_t *vcpu)
     for (i = 0; i < lr_num; i++) {
         set_gic_vcpu_ctrl_lr(i, vcpu->vgic.lr[i]);
     }
+#if defined(CONFIG_ARM_VCPU_INJECT_FASTPATH) && defined(ENABLE_SMP_SUPPORT)
+    vcpu->pendingLRs = 0;
+#endif
 
     /* restore registers */
     vcpu_restore_reg_range(vcpu, seL4_VCPURegSaveRange_start, seL4_VCPURegSaveRange_end);
     vcpu_enable(vcpu);
+
+    vcpu_switch_stat_add(vcpu, BENCHMARK_VCPU_SWITCH_LOADS, 1);
+    vcpu_switch_stat_add(vcpu, BENCHMARK_VCPU_SWITCH_LRS_RESTORED, lr_num);
+    vcpu_switch_stat_add(vcpu, BENCHMARK_VCPU_SWITCH_REGS_RESTORED,
+                         seL4_VCPURegSaveRange_end - seL4_VCPURegSaveRange_start + 1);
 }
 
+#ifdef CONFIG_ARM_VCPU_LAZY_SWITCH
+/* Restore a VCPU over prev, whose state was saved just before and so is still
+ * what the hardware holds. Only the registers that differ between the two are
+ * written. Registers outside the save range are restored by vcpu_enable. */
+static void vcpu_restore_changed(vcpu_t *vcpu, vcpu_t *prev)
+{
+    word_t i;
+    word_t lr_num;
+
+    assert(vcpu && prev);
+    /* Turn off the VGIC */
+    set_gic_vcpu_ctrl_hcr(0);
+    isb();
+
+    /* Restore GIC VCPU control state */
+    if (vcpu->vgic.vmcr != prev->vgic.vmcr) {
+        set_gic_vcpu_ctrl_vmcr(vcpu->vgic.vmcr);
+    }
+    if (vcpu->vgic.apr != prev->vgic.apr) {
+        set_gic_vcpu_ctrl_apr(vcpu->vgic.apr);
+    }
+    lr_num = gic_vcpu_num_list_regs;
+    for (i = 0; i < lr_num; i++) {
+        if (vcpu->vgic.lr[i].words[0] != prev->vgic.lr[i].words[0]) {
+            set_gic_vcpu_ctrl_lr(i, vcpu->vgic.lr[i]);
+            vcpu_switch_stat_add(vcpu, BENCHMARK_VCPU_SWITCH_LRS_RESTORED, 1);
+        }
+    }
+#if defined(CONFIG_ARM_VCPU_INJECT_FASTPATH) && defined(ENABLE_SMP_SUPPORT)
+    vcpu->pendingLRs = 0;
+#endif
+
+    /* restore registers */
+    for (i = seL4_VCPURegSaveRange_start; i <= seL4_VCPURegSaveRange_end; i++) {
+        if (vcpu->regs[i] != prev->regs[i]) {
+            vcpu_restore_reg(vcpu, i);
+            vcpu_switch_stat_add(vcpu, BENCHMARK_VCPU_SWITCH_REGS_RESTORED, 1);
+        }
+    }
+    vcpu_enable(vcpu);
+    vcpu_switch_stat_add(vcpu, BENCHMARK_VCPU_SWITCH_LOADS, 1);
+}
+#endif /* CONFIG_ARM_VCPU_LAZY_SWITCH */
+
 void VPPIEvent(irq_t irq)
 {
 #ifdef CONFIG_KERNEL_MCS
@@ -165,6 +266,8 @@ void VGICMaintenance(void)
         return;
     }
 
+    vcpu_load_pending_lrs(ARCH_NODE_STATE(armHSCurVCPU));
+
     eisr0 = get_gic_vcpu_ctrl_eisr0();
     eisr1 = get_gic_vcpu_ctrl_eisr1();
     flags = get_gic_vcpu_ctrl_misr();
@@ -237,10 +340,24 @@ void vcpu_switch(vcpu_t *new)
 {
     if (likely(ARCH_NODE_STATE(armHSCurVCPU) != new)) {
         if (unlikely(new != NULL)) {
+#ifdef CONFIG_BENCHMARK_VCPU_SWITCH
+            timestamp_t start = timestamp();
+#endif
             if (unlikely(ARCH_NODE_STATE(armHSCurVCPU) != NULL)) {
                 vcpu_save(ARCH_NODE_STATE(armHSCurVCPU), ARCH_NODE_STATE(armHSVCPUActive));
             }
+#ifdef CONFIG_ARM_VCPU_LAZY_SWITCH
+            if (ARCH_NODE_STATE(armHSCurVCPU) != NULL) {
+                vcpu_restore_changed(new, ARCH_NODE_STATE(armHSCurVCPU));
+            } else {
+                vcpu_restore(new);
+            }
+#else
             vcpu_restore(new);
+#endif
+#ifdef CONFIG_BENCHMARK_VCPU_SWITCH
+            vcpu_switch_stat_add(new, BENCHMARK_VCPU_SWITCH_CYCLES, timestamp() - start);
+#endif
             ARCH_NODE_STATE(armHSCurVCPU) = new;
             ARCH_NODE_STATE(armHSVCPUActive) = true;
         } else if (unlikely(ARCH_NODE_STATE(armHSVCPUActive))) {
@@ -255,6 +372,7 @@ void vcpu_switch(vcpu_t *new)
         isb();
         vcpu_enable(new);
         ARCH_NODE_STATE(armHSVCPUActive) = true;
+        vcpu_switch_stat_add(new, BENCHMARK_VCPU_SWITCH_REENABLES, 1);
     }
 }
 
@@ -394,6 +512,11 @@ exception_t decodeVCPUReadReg(cap_t cap, word_t length, bool_t call, word_t *buf
 
 exception_t invokeVCPUInjectIRQ(vcpu_t *vcpu, unsigned long index, virq_t virq)
 {
+#ifdef CONFIG_ARM_VCPU_INJECT_FASTPATH
+    word_t lr = index;
+
+    return invokeVCPUInjectIRQs(vcpu, 1, &lr, &virq);
+#else
     if (likely(ARCH_NODE_STATE(armHSCurVCPU) == vcpu)) {
         set_gic_vcpu_ctrl_lr(index, virq);
 #ifdef ENABLE_SMP_SUPPORT
@@ -407,8 +530,133 @@ exception_t invokeVCPUInjectIRQ(vcpu_t *vcpu, unsigned long index, virq_t virq)
     }
 
     return EXCEPTION_NONE;
+#endif
 }
 
+#ifdef CONFIG_ARM_VCPU_INJECT_FASTPATH
+exception_t invokeVCPUInjectIRQs(vcpu_t *vcpu, word_t count, const word_t *indexes, const virq_t *virqs)
+{
+    word_t i;
+
+    if (likely(ARCH_NODE_STATE(armHSCurVCPU) == vcpu)) {
+        for (i = 0; i < count; i++) {
+            set_gic_vcpu_ctrl_lr(indexes[i], virqs[i]);
+#ifdef ENABLE_SMP_SUPPORT
+            /* This is newer than an IRQ injected by another core */
+            vcpu->pendingLRs &= ~BIT(indexes[i]);
+#endif
+        }
+#ifdef ENABLE_SMP_SUPPORT
+    } else if (vcpu->vcpuTCB != NULL && vcpu->vcpuTCB->tcbAffinity != getCurrentCPUIndex()) {
+        /* The VCPU may be loaded on its core. That core loads the pending list
+         * registers into its VGIC when it takes the IPI, or before it next
+         * reads them, so the IPI is not waited for. */
+        for (i = 0; i < count; i++) {
+            vcpu->vgic.lr[indexes[i]] = virqs[i];
+            vcpu->pendingLRs |= BIT(indexes[i]);
+        }
+        ipi_send_mask(CORE_IRQ_TO_IRQT(0, irq_vcpu_inject_ipi), BIT(vcpu->vcpuTCB->tcbAffinity), false);
+#endif /* ENABLE_SMP_SUPPORT */
+    } else {
+        for (i = 0; i < count; i++) {
+            vcpu->vgic.lr[indexes[i]] = virqs[i];
+        }
+    }
+
+    return EXCEPTION_NONE;
+}
+
+static inline bool_t vcpu_virq_mr_valid(word_t mr)
+{
+    word_t vid = mr & 0xffff;
+    word_t priority = (mr >> 16) & 0xff;
+    word_t group = (mr >> 24) & 0xff;
+    word_t index = (mr >> 32) & 0xff;
+
+    return vid <= (1U << 10) - 1 && priority <= 31 && group <= 1 &&
+           index < gic_vcpu_num_list_regs;
+}
+
+/* Decode IRQs to inject, each packed as the first message register of
+ * InjectIRQ. Returns the position of the first IRQ that is invalid, has its
+ * list register in use or shares it with an earlier IRQ, or count if all of
+ * them can be injected. */
+word_t vcpu_decode_virqs(vcpu_t *vcpu, word_t count, const word_t *mrs, word_t *indexes, virq_t *virqs)
+{
+    word_t used = 0;
+    word_t i;
+
+    for (i = 0; i < count; i++) {
+        word_t vid = mrs[i] & 0xffff;
+        word_t priority = (mrs[i] >> 16) & 0xff;
+        word_t group = (mrs[i] >> 24) & 0xff;
+        word_t index = (mrs[i] >> 32) & 0xff;
+
+        if (!vcpu_virq_mr_valid(mrs[i]) || (used & BIT(index)) ||
+            virq_get_virqType(vcpu->vgic.lr[index]) == virq_virq_active) {
+            break;
+        }
+        used |= BIT(index);
+        indexes[i] = index;
+        virqs[i] = virq_virq_pending_new(group, priority, 1, vid);
+    }
+
+    return i;
+}
+
+exception_t decodeVCPUInjectIRQs(cap_t cap, word_t length, word_t *buffer)
+{
+    vcpu_t *vcpu = VCPU_PTR(cap_vcpu_cap_get_capVCPUPtr(cap));
+    word_t mrs[VCPU_INJECT_IRQS_MAX];
+    word_t indexes[VCPU_INJECT_IRQS_MAX];
+    virq_t virqs[VCPU_INJECT_IRQS_MAX];
+    word_t count;
+    word_t i;
+
+    if (length < 1) {
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    count = getSyscallArg(0, buffer);
+    if (count < 1 || count > VCPU_INJECT_IRQS_MAX) {
+        current_syscall_error.type = seL4_RangeError;
+        current_syscall_error.rangeErrorMin = 1;
+        current_syscall_error.rangeErrorMax = VCPU_INJECT_IRQS_MAX;
+        current_syscall_error.invalidArgumentNumber = 0;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    if (length < 1 + count) {
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    for (i = 0; i < count; i++) {
+        mrs[i] = getSyscallArg(1 + i, buffer);
+    }
+
+    i = vcpu_decode_virqs(vcpu, count, mrs, indexes, virqs);
+    /* An IRQ sharing the list register of an earlier one never finds it in
+     * use, as the earlier IRQ would have failed first. */
+    if (i != count && vcpu_virq_mr_valid(mrs[i]) &&
+        virq_get_virqType(vcpu->vgic.lr[(mrs[i] >> 32) & 0xff]) == virq_virq_active) {
+        userError("VCPU InjectIRQs: list register of IRQ %lu in use.", (unsigned long)i);
+        current_syscall_error.type = seL4_DeleteFirst;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+    if (i != count) {
+        userError("VCPU InjectIRQs: IRQ %lu is invalid, or shares its list register.", (unsigned long)i);
+        current_syscall_error.type = seL4_InvalidArgument;
+        current_syscall_error.invalidArgumentNumber = 1 + i;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    return invokeVCPUInjectIRQs(vcpu, count, indexes, virqs);
+}
+#endif /* CONFIG_ARM_VCPU_INJECT_FASTPATH */
+
 exception_t decodeVCPUInjectIRQ(cap_t cap, word_t length, word_t *buffer)
 {
     word_t vid, priority, group, index;
@@ -511,6 +759,10 @@ exception_t decodeARMVCPUInvocation(
         return decodeVCPUWriteReg(cap, length, buffer);
     case ARMVCPUInjectIRQ:
         return decodeVCPUInjectIRQ(cap, length, buffer);
+#ifdef CONFIG_ARM_VCPU_INJECT_FASTPATH
+    case ARMVCPUInjectIRQs:
+        return decodeVCPUInjectIRQs(cap, length, buffer);
+#endif
     case ARMVCPUAckVPPI:
         return decodeVCPUAckVPPI(cap, length, buffer);
     default:
@@ -605,6 +857,17 @@ void handleVCPUInjectInterruptIPI(vcpu_t *vcpu, unsigned long index, virq_t virq
         vcpu->vgic.lr[index] = virq;
     }
 }
+
+#ifdef CONFIG_ARM_VCPU_INJECT_FASTPATH
+void handleVCPUInjectPendingIPI(void)
+{
+    /* A VCPU that is not loaded has its pending list registers loaded when it
+     * is restored */
+    if (ARCH_NODE_STATE(armHSCurVCPU) != NULL) {
+        vcpu_load_pending_lrs(ARCH_NODE_STATE(armHSCurVCPU));
+    }
+}
+#endif
 #endif /* ENABLE_SMP_SUPPORT */
 
 #endif
@@ -39,6 +39,12 @@ void handleRemoteCall(IpiRemoteCall_t call, word_t arg0, word_t arg1, word_t arg
             invalidateTranslationAllLocal();
             break;
 
+#if defined(CONFIG_TLB_BATCHING) && !defined(CONFIG_ARM_HYPERVISOR_SUPPORT)
+        case IpiRemoteCall_InvalidateTranslationRange:
+            invalidateTranslationRangeLocal(arg0, arg1);
+            break;
+#endif
+
         case IpiRemoteCall_MaskPrivateInterrupt:
             maskInterrupt(arg0, IDX_TO_IRQT(arg1));
             break;
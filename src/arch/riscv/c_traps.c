@@ -116,7 +116,7 @@ void VISIBLE NORETURN c_handle_exception(void)
     }
 #endif
 
-    NODE_LOCK_SYS;
+    NODE_LOCK_FAULT;
 
     c_entry_hook();
 
@@ -131,6 +131,12 @@ void VISIBLE NORETURN c_handle_exception(void)
         handleVMFaultEvent(scause);
         break;
     default:
+#ifdef CONFIG_FPU_LAZY_SWITCH
+        if (scause == RISCVInstructionIllegal && handleLazyFPUFault()) {
+            /* The thread retries the instruction with its FPU state loaded */
+            break;
+        }
+#endif
         handleUserLevelFault(scause, 0);
         break;
     }
@@ -141,6 +147,8 @@ void VISIBLE NORETURN c_handle_exception(void)
 
 void VISIBLE NORETURN slowpath(syscall_t syscall)
 {
+    NODE_LOCK_UPGRADE;
+
     if (unlikely(syscall < SYSCALL_MIN || syscall > SYSCALL_MAX)) {
 #ifdef TRACK_KERNEL_ENTRIES
         ksKernelEntry.path = Entry_UnknownSyscall;
@@ -168,7 +176,7 @@ void VISIBLE c_handle_fastpath_reply_recv(word_t cptr, word_t msgInfo, word_t re
 void VISIBLE c_handle_fastpath_reply_recv(word_t cptr, word_t msgInfo)
 #endif
 {
-    NODE_LOCK_SYS;
+    NODE_LOCK_SHARED_SYS;
 
     c_entry_hook();
 #ifdef TRACK_KERNEL_ENTRIES
@@ -186,7 +194,7 @@ void VISIBLE c_handle_fastpath_reply_recv(word_t cptr, word_t msgInfo)
 ALIGN(L1_CACHE_LINE_SIZE)
 void VISIBLE c_handle_fastpath_call(word_t cptr, word_t msgInfo)
 {
-    NODE_LOCK_SYS;
+    NODE_LOCK_SHARED_SYS;
 
     c_entry_hook();
 #ifdef TRACK_KERNEL_ENTRIES
@@ -28,6 +28,22 @@ config_option(KernelRiscvExtF RISCV_EXT_F "RISC-V extension for single-precision
 config_option(KernelRiscvExtD RISCV_EXT_D "RISC-V extension for double-precision floating-point"
               DEFAULT ${_KernelRiscvExtD} DEPENDS "KernelArchRiscV")
 
+config_option(
+  KernelRiscvZicboz RISCV_ZICBOZ
+  "The platform implements the Zicboz extension and the SBI implementation enables \
+    cbo.zero for S-mode. Supervisor mode cannot probe for this without trapping, so it is \
+    set per platform. With KernelFastClearMemory, the kernel clears memory with cbo.zero."
+  DEFAULT OFF
+  DEPENDS "KernelArchRiscV")
+
+config_string(
+  KernelRiscvCbozBlockBits RISCV_CBOZ_BLOCK_BITS
+  "Log2 of the size in bytes of the cache block that cbo.zero clears, as given by the \
+    riscv,cboz-block-size property of the platform's device tree."
+  DEFAULT 6
+  UNQUOTE
+  DEPENDS "KernelRiscvZicboz" UNDEF_DISABLED)
+
 config_option(
   KernelRiscvUseClintMtime
   RISCV_USE_CLINT_MTIME
@@ -680,6 +680,232 @@ static inline bool_t CONST checkVPAlignment(vm_page_size_t sz, word_t w)
     return (w & MASK(pageBitsForSize(sz))) == 0;
 }
 
+#ifdef CONFIG_FRAME_RANGE_INVOCATIONS
+static exception_t performPageTableInvocationMapFrames(asid_t asid, vptr_t vaddr, pte_t *ptSlot,
+                                                       cte_t *frameSlots, word_t numFrames,
+                                                       seL4_CapRights_t rightsMask,
+                                                       vm_attributes_t attr)
+{
+    exception_t status = EXCEPTION_NONE;
+    bool_t executable = !vm_attributes_get_riscvExecuteNever(attr);
+
+    for (word_t i = 0; i < numFrames; i++) {
+        /* Frames that have already been mapped are skipped on restart, so
+         * there is no need to track progress anywhere else. */
+        if (i > 0) {
+            status = preemptionPoint();
+            if (unlikely(status != EXCEPTION_NONE)) {
+                break;
+            }
+        }
+
+        cap_t cap = frameSlots[i].cap;
+        vm_rights_t vmRights = maskVMRights(cap_frame_cap_get_capFVMRights(cap), rightsMask);
+        paddr_t frame_paddr = addrFromPPtr((void *) cap_frame_cap_get_capFBasePtr(cap));
+
+        ptSlot[i] = makeUserPTE(frame_paddr, executable, vmRights);
+
+        cap = cap_frame_cap_set_capFMappedASID(cap, asid);
+        cap = cap_frame_cap_set_capFMappedAddress(cap, vaddr + (i << seL4_PageBits));
+        frameSlots[i].cap = cap;
+    }
+
+    sfence();
+    return status;
+}
+
+static exception_t performPageTableInvocationUnmapFrames(pte_t *pt, cte_t *frameSlots, word_t numFrames)
+{
+    exception_t status = EXCEPTION_NONE;
+
+    for (word_t i = 0; i < numFrames; i++) {
+        if (i > 0) {
+            status = preemptionPoint();
+            if (unlikely(status != EXCEPTION_NONE)) {
+                break;
+            }
+        }
+
+        cap_t cap = frameSlots[i].cap;
+        if (cap_frame_cap_get_capFMappedASID(cap) == asidInvalid) {
+            continue;
+        }
+
+        pte_t *ptSlot = pt + RISCV_GET_PT_INDEX(cap_frame_cap_get_capFMappedAddress(cap), CONFIG_PT_LEVELS - 1);
+        if (pte_ptr_get_valid(ptSlot) && !isPTEPageTable(ptSlot) &&
+            (pte_ptr_get_ppn(ptSlot) << seL4_PageBits) == pptr_to_paddr((void *)cap_frame_cap_get_capFBasePtr(cap))) {
+            *ptSlot = pte_pte_invalid_new();
+        }
+
+        cap = cap_frame_cap_set_capFMappedAddress(cap, 0);
+        cap = cap_frame_cap_set_capFMappedASID(cap, asidInvalid);
+        frameSlots[i].cap = cap;
+    }
+
+    sfence();
+    return status;
+}
+
+/* Find the slots of a mapped leaf page table by walking from the root of its
+ * address space, so that stale caps of a deleted ASID are rejected. */
+static pte_t *lookupLeafPTSlot(cap_t cap, vptr_t vaddr)
+{
+    pte_t *pt = PTE_PTR(cap_page_table_cap_get_capPTBasePtr(cap));
+
+    if (unlikely(!cap_page_table_cap_get_capPTIsMapped(cap))) {
+        current_syscall_error.type = seL4_InvalidCapability;
+        current_syscall_error.invalidCapNumber = 0;
+        return NULL;
+    }
+
+    findVSpaceForASID_ret_t find_ret = findVSpaceForASID(cap_page_table_cap_get_capPTMappedASID(cap));
+    if (unlikely(find_ret.status != EXCEPTION_NONE)) {
+        current_syscall_error.type = seL4_FailedLookup;
+        current_syscall_error.failedLookupWasSource = false;
+        return NULL;
+    }
+
+    lookupPTSlot_ret_t lu_ret = lookupPTSlot(find_ret.vspace_root, vaddr);
+    if (unlikely(lu_ret.ptBitsLeft != seL4_PageBits ||
+                 lu_ret.ptSlot < pt || lu_ret.ptSlot >= pt + BIT(PT_INDEX_BITS))) {
+        current_syscall_error.type = seL4_InvalidArgument;
+        current_syscall_error.invalidArgumentNumber = 0;
+        return NULL;
+    }
+
+    return lu_ret.ptSlot;
+}
+
+static exception_t decodeRISCVPageTableMapFrames(word_t length, cap_t cap, word_t *buffer)
+{
+    if (unlikely(length < 7 || current_extra_caps.excaprefs[0] == NULL)) {
+        userError("RISCVPageTableMapFrames: Truncated message.");
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    word_t vaddr = getSyscallArg(0, buffer);
+    seL4_CapRights_t rightsMask = rightsFromWord(getSyscallArg(1, buffer));
+    vm_attributes_t attr = vmAttributesFromWord(getSyscallArg(2, buffer));
+    word_t numFrames = getSyscallArg(6, buffer);
+
+    if (unlikely(!checkVPAlignment(RISCV_4K_Page, vaddr))) {
+        current_syscall_error.type = seL4_AlignmentError;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    pte_t *ptSlot = lookupLeafPTSlot(cap, vaddr);
+    if (unlikely(ptSlot == NULL)) {
+        userError("RISCVPageTableMapFrames: 0x%"SEL4_PRIx_word" is not covered by this page table.", vaddr);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+    asid_t asid = cap_page_table_cap_get_capPTMappedASID(cap);
+
+    /* Only frames for this leaf table can be mapped in a single invocation. */
+    lookupSlot_ret_t window = lookupSourceWindow(current_extra_caps.excaprefs[0]->cap,
+                                                 getSyscallArg(3, buffer), getSyscallArg(4, buffer),
+                                                 getSyscallArg(5, buffer), numFrames,
+                                                 PTE_PTR(cap_page_table_cap_get_capPTBasePtr(cap)) +
+                                                 BIT(PT_INDEX_BITS) - ptSlot);
+    if (unlikely(window.status != EXCEPTION_NONE)) {
+        userError("RISCVPageTableMapFrames: Invalid frame window.");
+        return window.status;
+    }
+
+    if (unlikely(vaddr + (numFrames << seL4_PageBits) - 1 >= USER_TOP)) {
+        current_syscall_error.type = seL4_InvalidArgument;
+        current_syscall_error.invalidArgumentNumber = 0;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    for (word_t i = 0; i < numFrames; i++) {
+        cap_t frameCap = window.slot[i].cap;
+
+        if (unlikely(cap_get_capType(frameCap) != cap_frame_cap ||
+                     cap_frame_cap_get_capFSize(frameCap) != RISCV_4K_Page)) {
+            userError("RISCVPageTableMapFrames: Slot %"SEL4_PRIu_word" of the window is not a 4K frame.", i);
+            current_syscall_error.type = seL4_InvalidCapability;
+            current_syscall_error.invalidCapNumber = 1;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+
+        asid_t frame_asid = cap_frame_cap_get_capFMappedASID(frameCap);
+        if (unlikely(frame_asid != asidInvalid)) {
+            /* a frame may only be remapped at the same address */
+            if (frame_asid != asid ||
+                cap_frame_cap_get_capFMappedAddress(frameCap) != vaddr + (i << seL4_PageBits)) {
+                userError("RISCVPageTableMapFrames: Slot %"SEL4_PRIu_word" of the window is mapped elsewhere.", i);
+                current_syscall_error.type = seL4_InvalidCapability;
+                current_syscall_error.invalidCapNumber = 1;
+                return EXCEPTION_SYSCALL_ERROR;
+            }
+        } else if (unlikely(pte_ptr_get_valid(&ptSlot[i]))) {
+            userError("Virtual address (0x%"SEL4_PRIx_word") already mapped", vaddr + (i << seL4_PageBits));
+            current_syscall_error.type = seL4_DeleteFirst;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+    }
+
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    return performPageTableInvocationMapFrames(asid, vaddr, ptSlot, window.slot, numFrames,
+                                               rightsMask, attr);
+}
+
+static exception_t decodeRISCVPageTableUnmapFrames(word_t length, cap_t cap, word_t *buffer)
+{
+    if (unlikely(length < 4 || current_extra_caps.excaprefs[0] == NULL)) {
+        userError("RISCVPageTableUnmapFrames: Truncated message.");
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    word_t numFrames = getSyscallArg(3, buffer);
+    word_t base = cap_page_table_cap_get_capPTMappedAddress(cap);
+
+    if (unlikely(lookupLeafPTSlot(cap, base) == NULL)) {
+        userError("RISCVPageTableUnmapFrames: PageTable is not mapped.");
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+    asid_t asid = cap_page_table_cap_get_capPTMappedASID(cap);
+
+    lookupSlot_ret_t window = lookupSourceWindow(current_extra_caps.excaprefs[0]->cap,
+                                                 getSyscallArg(0, buffer), getSyscallArg(1, buffer),
+                                                 getSyscallArg(2, buffer), numFrames, BIT(PT_INDEX_BITS));
+    if (unlikely(window.status != EXCEPTION_NONE)) {
+        userError("RISCVPageTableUnmapFrames: Invalid frame window.");
+        return window.status;
+    }
+
+    for (word_t i = 0; i < numFrames; i++) {
+        cap_t frameCap = window.slot[i].cap;
+
+        if (unlikely(cap_get_capType(frameCap) != cap_frame_cap ||
+                     cap_frame_cap_get_capFSize(frameCap) != RISCV_4K_Page)) {
+            userError("RISCVPageTableUnmapFrames: Slot %"SEL4_PRIu_word" of the window is not a 4K frame.", i);
+            current_syscall_error.type = seL4_InvalidCapability;
+            current_syscall_error.invalidCapNumber = 1;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+
+        /* frames that are already unmapped are skipped, which makes this
+         * operation restartable after preemption */
+        asid_t frame_asid = cap_frame_cap_get_capFMappedASID(frameCap);
+        if (frame_asid != asidInvalid &&
+            (frame_asid != asid ||
+             (cap_frame_cap_get_capFMappedAddress(frameCap) & ~MASK(seL4_PageBits + PT_INDEX_BITS)) != base)) {
+            userError("RISCVPageTableUnmapFrames: Slot %"SEL4_PRIu_word" of the window is not mapped by this PageTable.", i);
+            current_syscall_error.type = seL4_InvalidCapability;
+            current_syscall_error.invalidCapNumber = 1;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+    }
+
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    return performPageTableInvocationUnmapFrames(PTE_PTR(cap_page_table_cap_get_capPTBasePtr(cap)),
+                                                 window.slot, numFrames);
+}
+#endif /* CONFIG_FRAME_RANGE_INVOCATIONS */
+
 static exception_t decodeRISCVPageTableInvocation(word_t label, word_t length,
                                                   cte_t *cte, cap_t cap, word_t *buffer)
 {
@@ -706,6 +932,16 @@ static exception_t decodeRISCVPageTableInvocation(word_t label, word_t length,
         return performPageTableInvocationUnmap(cap, cte);
     }
 
+#ifdef CONFIG_FRAME_RANGE_INVOCATIONS
+    if (label == RISCVPageTableMapFrames) {
+        return decodeRISCVPageTableMapFrames(length, cap, buffer);
+    }
+
+    if (label == RISCVPageTableUnmapFrames) {
+        return decodeRISCVPageTableUnmapFrames(length, cap, buffer);
+    }
+#endif
+
     if (unlikely((label != RISCVPageTableMap))) {
         userError("RISCVPageTable: Illegal Operation");
         current_syscall_error.type = seL4_IllegalOperation;
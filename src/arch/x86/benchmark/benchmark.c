@@ -10,8 +10,10 @@
 #include <arch/benchmark.h>
 #include <arch/machine/hardware.h>
 
+#ifndef CONFIG_LOG_BUFFER_PER_NODE
 timestamp_t ksEntries[CONFIG_MAX_NUM_TRACE_POINTS];
 bool_t ksStarted[CONFIG_MAX_NUM_TRACE_POINTS];
+#endif
 timestamp_t ksExit;
 seL4_Word ksLogIndex = 0;
 seL4_Word ksLogIndexFinalized = 0;
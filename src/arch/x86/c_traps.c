@@ -37,8 +37,9 @@ void VISIBLE NORETURN c_handle_interrupt(int irq, int syscall)
 
     /* Only grab the lock if we are not handling 'int_remote_call_ipi' interrupt
      * also flag this lock as IRQ lock if handling the irq interrupts. */
-    NODE_LOCK_IF(irq != int_remote_call_ipi,
-                 irq >= int_irq_min && irq <= int_irq_max);
+    NODE_LOCK_IF_AS(irq != int_remote_call_ipi,
+                    irq >= int_irq_min && irq <= int_irq_max,
+                    (irq >= int_irq_min && irq <= int_irq_max) ? BENCHMARK_LOCK_ENTRY_INTERRUPT : BENCHMARK_LOCK_ENTRY_FAULT);
 
     c_entry_hook();
 
@@ -59,6 +60,10 @@ void VISIBLE NORETURN c_handle_interrupt(int irq, int syscall)
 #endif
         handleUserLevelDebugException(irq);
 #endif /* CONFIG_HARDWARE_DEBUG_API */
+#ifdef CONFIG_FPU_LAZY_SWITCH
+    } else if (irq == int_unimpl_dev && handleLazyFPUFault()) {
+        /* The thread retries the instruction with its FPU state loaded */
+#endif
     } else if (irq < int_irq_min) {
 #ifdef TRACK_KERNEL_ENTRIES
         ksKernelEntry.path = Entry_UserLevelFault;
@@ -96,6 +101,7 @@ void VISIBLE NORETURN c_handle_interrupt(int irq, int syscall)
 
 void NORETURN slowpath(syscall_t syscall)
 {
+    NODE_LOCK_UPGRADE;
 
 #ifdef CONFIG_VTX
     if (syscall == SysVMEnter && NODE_STATE(ksCurThread)->tcbArch.tcbVCPU) {
@@ -157,7 +163,14 @@ void VISIBLE NORETURN c_handle_syscall(word_t cptr, word_t msgInfo, syscall_t sy
         setRegister(NODE_STATE(ksCurThread), FaultIP, getRegister(NODE_STATE(ksCurThread), NextIP) - 2);
     }
 
-    NODE_LOCK_SYS;
+#ifdef CONFIG_FASTPATH
+    if (syscall == (syscall_t)SysCall || syscall == (syscall_t)SysReplyRecv) {
+        NODE_LOCK_SHARED_SYS;
+    } else
+#endif /* CONFIG_FASTPATH */
+    {
+        NODE_LOCK_SYS;
+    }
 
     c_entry_hook();
 
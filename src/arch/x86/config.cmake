@@ -80,6 +80,19 @@ config_string(
   "Setsthe maximum number of Reserved Memory Region Reporting structures we support \
     recording from the ACPI tables" DEFAULT 32 DEPENDS "KernelIOMMU" DEFAULT_DISABLED 1 UNQUOTE)
 
+config_string(
+  KernelMaxDRHDScopeEntries MAX_DRHD_SCOPE_ENTRIES
+  "Sets the maximum number of PCI devices in the scope of an IOMMU we support recording \
+    from the ACPI tables. IOTLB invalidations for a device that is not recorded go to all IOMMUs."
+  DEFAULT 32 DEPENDS "KernelIOMMU" DEFAULT_DISABLED 1 UNQUOTE)
+
+config_option(
+  KernelIOMMUQueuedInvalidation IOMMU_QUEUED_INVALIDATION
+  "Submit IOTLB invalidations through the VT-d invalidation queue, if all IOMMUs \
+    support it, and wait for them to complete in memory instead of polling registers."
+  DEFAULT ON
+  DEPENDS "KernelIOMMU" DEFAULT_DISABLED OFF)
+
 config_string(
   KernelMaxVPIDs
   MAX_VPIDS
@@ -91,6 +91,7 @@ BOOT_CODE bool_t init_sys_state(
     uint32_t      num_drhu,
     paddr_t      *drhu_list,
     acpi_rmrr_list_t *rmrr_list,
+    acpi_drhd_list_t *drhd_list,
     acpi_rsdp_t      *acpi_rsdp,
     seL4_X86_BootInfo_VBE *vbe,
     seL4_X86_BootInfo_mmap_t *mb_mmap,
@@ -313,7 +314,7 @@ BOOT_CODE bool_t init_sys_state(
 
 #ifdef CONFIG_IOMMU
     /* initialise VTD-related data structures and the IOMMUs */
-    if (!vtd_init(cpu_id, rmrr_list)) {
+    if (!vtd_init(cpu_id, rmrr_list, drhd_list)) {
         return false;
     }
 
@@ -379,6 +380,9 @@ BOOT_CODE bool_t init_cpu(
             write_cr4(read_cr4() | CR4_SMAP);
         }
     }
+#ifdef CONFIG_FAST_CLEAR_MEMORY
+    x86KSEnhancedRepStos = cpuid_007h_ebx_get_enhanced_rep_mov(ebx_007);
+#endif
     if (cpuid_007h_ebx_get_smep(ebx_007)) {
         /* similar to smap we cannot enable smep if using dangerous code injection. it
          * does not affect stack trace printing though */
@@ -176,6 +176,7 @@ static BOOT_CODE bool_t try_boot_sys_node(cpu_id_t cpu_id)
             boot_state.num_drhu,
             boot_state.drhu_list,
             &boot_state.rmrr_list,
+            &boot_state.drhd_list,
             &boot_state.acpi_rsdp,
             &boot_state.vbe_info,
             &boot_state.mb_mmap_info,
@@ -425,7 +426,8 @@ static BOOT_CODE bool_t try_boot_sys(void)
             boot_state.drhu_list,
             &boot_state.num_drhu,
             MAX_NUM_DRHU,
-            &boot_state.rmrr_list
+            &boot_state.rmrr_list,
+            &boot_state.drhd_list
         );
     }
 
@@ -9,6 +9,8 @@
 #include <machine/io.h>
 #include <kernel/boot.h>
 #include <model/statedata.h>
+#include <model/preemption.h>
+#include <kernel/cspace.h>
 #include <arch/kernel/vspace.h>
 #include <arch/api/invocation.h>
 #include <arch/kernel/tlb_bitmap.h>
@@ -34,6 +36,66 @@ static exception_t performPageGetAddress(void *vbase_ptr, bool_t call)
     return EXCEPTION_NONE;
 }
 
+#ifdef CONFIG_TLB_BATCHING
+/* The pages unmapped since beginTLBBatch, as the span of addresses that
+ * contains them. Unmapping in another address space flushes the batch. */
+typedef struct tlb_batch {
+    bool_t open;
+    asid_t asid;
+    vspace_root_t *vspace;
+    vptr_t start;
+    vptr_t end;
+} tlb_batch_t;
+
+static tlb_batch_t tlb_batch;
+
+static void flushTLBBatch(void)
+{
+    if (tlb_batch.vspace != NULL) {
+        word_t pages = ((tlb_batch.end - tlb_batch.start) >> PAGE_BITS) + 1;
+        word_t mask = SMP_TERNARY(tlb_bitmap_get(tlb_batch.vspace), 0);
+        if (pages > CONFIG_TLB_FLUSH_ASID_THRESHOLD) {
+            invalidateASID(tlb_batch.vspace, tlb_batch.asid, mask);
+        } else {
+            invalidateTranslationRangeASID(tlb_batch.start, pages, tlb_batch.asid, mask);
+        }
+        tlb_batch.vspace = NULL;
+    }
+}
+
+void beginTLBBatch(void)
+{
+    assert(!tlb_batch.open && tlb_batch.vspace == NULL);
+    tlb_batch.open = true;
+}
+
+void endTLBBatch(void)
+{
+    flushTLBBatch();
+    tlb_batch.open = false;
+}
+
+static void invalidateTranslationSingleASIDDeferred(vptr_t vptr, asid_t asid, vspace_root_t *vspace)
+{
+    if (!tlb_batch.open) {
+        invalidateTranslationSingleASID(vptr, asid, SMP_TERNARY(tlb_bitmap_get(vspace), 0));
+        return;
+    }
+
+    if (tlb_batch.vspace != vspace || tlb_batch.asid != asid) {
+        flushTLBBatch();
+        tlb_batch.asid = asid;
+        tlb_batch.vspace = vspace;
+        tlb_batch.start = vptr;
+        tlb_batch.end = vptr;
+        return;
+    }
+
+    tlb_batch.start = MIN(tlb_batch.start, vptr);
+    tlb_batch.end = MAX(tlb_batch.end, vptr);
+}
+#endif /* CONFIG_TLB_BATCHING */
+
 void deleteASIDPool(asid_t asid_base, asid_pool_t *pool)
 {
     /* Haskell error: "ASID pool's base must be aligned" */
@@ -47,6 +109,11 @@ void deleteASIDPool(asid_t asid_base, asid_pool_t *pool)
                 hwASIDInvalidate(asid_base + offset, vspace);
             }
         }
+#ifdef CONFIG_TLB_BATCHING
+        if (tlb_batch.vspace != NULL && ASID_HIGH(tlb_batch.asid) == ASID_HIGH(asid_base)) {
+            tlb_batch.vspace = NULL;
+        }
+#endif
         x86KSASIDTable[ASID_HIGH(asid_base)] = NULL;
         setVMRoot(NODE_STATE(ksCurThread));
     }
@@ -87,6 +154,12 @@ void deleteASID(asid_t asid, vspace_root_t *vspace)
         if (asid_map_get_type(asid_map) == asid_map_asid_map_vspace &&
             (vspace_root_t *)asid_map_asid_map_vspace_get_vspace_root(asid_map) == vspace) {
             hwASIDInvalidate(asid, vspace);
+#ifdef CONFIG_TLB_BATCHING
+            /* pending invalidations for this ASID are covered by the flush above */
+            if (tlb_batch.vspace == vspace) {
+                tlb_batch.vspace = NULL;
+            }
+#endif
             poolPtr->array[ASID_LOW(asid)] = asid_map_asid_map_none_new();
             setVMRoot(NODE_STATE(ksCurThread));
         }
@@ -760,8 +833,12 @@ void unmapPage(vm_page_size_t page_size, asid_t asid, vptr_t vptr, void *pptr)
         break;
     }
 
+#ifdef CONFIG_TLB_BATCHING
+    invalidateTranslationSingleASIDDeferred(vptr, asid, find_ret.vspace_root);
+#else
     invalidateTranslationSingleASID(vptr, asid,
                                     SMP_TERNARY(tlb_bitmap_get(find_ret.vspace_root), 0));
+#endif
 }
 
 void unmapPageTable(asid_t asid, vptr_t vaddr, pte_t *pt)
@@ -1137,6 +1214,273 @@ static exception_t performX86PageTableInvocationMap(cap_t cap, cte_t *ctSlot, pd
     return EXCEPTION_NONE;
 }
 
+#ifdef CONFIG_FRAME_RANGE_INVOCATIONS
+static exception_t performX86PageTableInvocationMapFrames(asid_t asid, vptr_t vaddr, pte_t *ptSlot,
+                                                          cte_t *frameSlots, word_t numFrames,
+                                                          seL4_CapRights_t rightsMask,
+                                                          vm_attributes_t vmAttr, vspace_root_t *vspace)
+{
+    exception_t status = EXCEPTION_NONE;
+
+    for (word_t i = 0; i < numFrames; i++) {
+        /* Frames that have already been mapped are skipped on restart, so
+         * there is no need to track progress anywhere else. */
+        if (i > 0) {
+            status = preemptionPoint();
+            if (unlikely(status != EXCEPTION_NONE)) {
+                break;
+            }
+        }
+
+        cap_t cap = frameSlots[i].cap;
+        vm_rights_t vmRights = maskVMRights(cap_frame_cap_get_capFVMRights(cap), rightsMask);
+
+        ptSlot[i] = makeUserPTE(pptr_to_paddr((void *)cap_frame_cap_get_capFBasePtr(cap)), vmAttr, vmRights);
+
+        cap = cap_frame_cap_set_capFMappedASID(cap, asid);
+        cap = cap_frame_cap_set_capFMappedAddress(cap, vaddr + (i << PAGE_BITS));
+        cap = cap_frame_cap_set_capFMapType(cap, X86_MappingVSpace);
+        frameSlots[i].cap = cap;
+    }
+
+    invalidatePageStructureCacheASID(pptr_to_paddr(vspace), asid,
+                                     SMP_TERNARY(tlb_bitmap_get(vspace), 0));
+    return status;
+}
+
+static exception_t performX86PageTableInvocationUnmapFrames(asid_t asid, pte_t *pt,
+                                                            cte_t *frameSlots, word_t numFrames,
+                                                            vspace_root_t *vspace)
+{
+    exception_t status = EXCEPTION_NONE;
+    bool_t flush_required = false;
+#ifdef CONFIG_TLB_BATCHING
+    vptr_t first = 0, last = 0;
+#endif
+
+    for (word_t i = 0; i < numFrames; i++) {
+        if (i > 0) {
+            status = preemptionPoint();
+            if (unlikely(status != EXCEPTION_NONE)) {
+                break;
+            }
+        }
+
+        cap_t cap = frameSlots[i].cap;
+        if (cap_frame_cap_get_capFMappedASID(cap) == asidInvalid) {
+            continue;
+        }
+
+        pte_t *ptSlot = pt + ((cap_frame_cap_get_capFMappedAddress(cap) >> PAGE_BITS) & MASK(PT_INDEX_BITS));
+        if (pte_ptr_get_present(ptSlot) &&
+            pte_ptr_get_page_base_address(ptSlot) == pptr_to_paddr((void *)cap_frame_cap_get_capFBasePtr(cap))) {
+            *ptSlot = makeUserPTEInvalid();
+#ifdef CONFIG_TLB_BATCHING
+            vptr_t vaddr = cap_frame_cap_get_capFMappedAddress(cap);
+            first = flush_required ? MIN(first, vaddr) : vaddr;
+            last = flush_required ? MAX(last, vaddr) : vaddr;
+#endif
+            flush_required = true;
+        }
+
+        cap = cap_frame_cap_set_capFMappedAddress(cap, 0);
+        cap = cap_frame_cap_set_capFMappedASID(cap, asidInvalid);
+        cap = cap_frame_cap_set_capFMapType(cap, X86_MappingNone);
+        frameSlots[i].cap = cap;
+    }
+
+    if (flush_required) {
+#ifdef CONFIG_TLB_BATCHING
+        word_t pages = ((last - first) >> PAGE_BITS) + 1;
+        if (pages <= CONFIG_TLB_FLUSH_ASID_THRESHOLD) {
+            invalidateTranslationRangeASID(first, pages, asid, SMP_TERNARY(tlb_bitmap_get(vspace), 0));
+            return status;
+        }
+#endif
+        invalidateASID(vspace, asid, SMP_TERNARY(tlb_bitmap_get(vspace), 0));
+    }
+    return status;
+}
+
+/* Find the slots of a mapped page table by walking from the root of its
+ * address space, so that stale caps of a deleted ASID are rejected. */
+static lookupPTSlot_ret_t lookupX86PageTableSlot(cap_t cap, vptr_t vaddr, vspace_root_t **vspace)
+{
+    lookupPTSlot_ret_t ret;
+    findVSpaceForASID_ret_t find_ret;
+    pte_t *pt = PTE_PTR(cap_page_table_cap_get_capPTBasePtr(cap));
+
+    ret.ptSlot = NULL;
+    ret.status = EXCEPTION_SYSCALL_ERROR;
+    *vspace = NULL;
+
+    if (!cap_page_table_cap_get_capPTIsMapped(cap)) {
+        current_syscall_error.type = seL4_InvalidCapability;
+        current_syscall_error.invalidCapNumber = 0;
+        return ret;
+    }
+
+    find_ret = findVSpaceForASID(cap_page_table_cap_get_capPTMappedASID(cap));
+    if (find_ret.status != EXCEPTION_NONE) {
+        current_syscall_error.type = seL4_FailedLookup;
+        current_syscall_error.failedLookupWasSource = false;
+        return ret;
+    }
+    *vspace = find_ret.vspace_root;
+
+    ret = lookupPTSlot(find_ret.vspace_root, vaddr);
+    if (ret.status != EXCEPTION_NONE || ret.ptSlot < pt || ret.ptSlot >= pt + BIT(PT_INDEX_BITS)) {
+        current_syscall_error.type = seL4_InvalidArgument;
+        current_syscall_error.invalidArgumentNumber = 0;
+        ret.ptSlot = NULL;
+        ret.status = EXCEPTION_SYSCALL_ERROR;
+    }
+
+    return ret;
+}
+
+static exception_t decodeX86PageTableMapFrames(word_t length, cap_t cap, word_t *buffer)
+{
+    word_t          vaddr;
+    seL4_CapRights_t rightsMask;
+    vm_attributes_t vmAttr;
+    word_t          numFrames;
+    asid_t          asid;
+    vspace_root_t  *vspace;
+    lookupPTSlot_ret_t ptSlot;
+    lookupSlot_ret_t window;
+
+    if (length < 7 || current_extra_caps.excaprefs[0] == NULL) {
+        userError("X86PageTable: Truncated message.");
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    vaddr = getSyscallArg(0, buffer);
+    rightsMask = rightsFromWord(getSyscallArg(1, buffer));
+    vmAttr = vmAttributesFromWord(getSyscallArg(2, buffer));
+    numFrames = getSyscallArg(6, buffer);
+
+    if (!checkVPAlignment(X86_SmallPage, vaddr)) {
+        current_syscall_error.type = seL4_AlignmentError;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    ptSlot = lookupX86PageTableSlot(cap, vaddr, &vspace);
+    if (ptSlot.status != EXCEPTION_NONE) {
+        userError("X86PageTableMapFrames: 0x%"SEL4_PRIx_word" is not covered by this page table.", vaddr);
+        return ptSlot.status;
+    }
+    asid = cap_page_table_cap_get_capPTMappedASID(cap);
+
+    /* Only frames for this page table can be mapped in a single invocation. */
+    window = lookupSourceWindow(current_extra_caps.excaprefs[0]->cap,
+                                getSyscallArg(3, buffer), getSyscallArg(4, buffer),
+                                getSyscallArg(5, buffer), numFrames,
+                                PTE_PTR(cap_page_table_cap_get_capPTBasePtr(cap)) +
+                                BIT(PT_INDEX_BITS) - ptSlot.ptSlot);
+    if (window.status != EXCEPTION_NONE) {
+        userError("X86PageTableMapFrames: Invalid frame window.");
+        return window.status;
+    }
+
+    if (vaddr + (numFrames << PAGE_BITS) > USER_TOP) {
+        userError("X86PageTableMapFrames: Mapping address too high.");
+        current_syscall_error.type = seL4_InvalidArgument;
+        current_syscall_error.invalidArgumentNumber = 0;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    for (word_t i = 0; i < numFrames; i++) {
+        cap_t frameCap = window.slot[i].cap;
+
+        if (cap_get_capType(frameCap) != cap_frame_cap ||
+            cap_frame_cap_get_capFSize(frameCap) != X86_SmallPage) {
+            userError("X86PageTableMapFrames: Slot %"SEL4_PRIu_word" of the window is not a small frame.", i);
+            current_syscall_error.type = seL4_InvalidCapability;
+            current_syscall_error.invalidCapNumber = 1;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+
+        /* A frame may only be remapped at the same address. */
+        if (cap_frame_cap_get_capFMappedASID(frameCap) != asidInvalid &&
+            (cap_frame_cap_get_capFMappedASID(frameCap) != asid ||
+             cap_frame_cap_get_capFMapType(frameCap) != X86_MappingVSpace ||
+             cap_frame_cap_get_capFMappedAddress(frameCap) != vaddr + (i << PAGE_BITS))) {
+            userError("X86PageTableMapFrames: Slot %"SEL4_PRIu_word" of the window is mapped elsewhere.", i);
+            current_syscall_error.type = seL4_InvalidCapability;
+            current_syscall_error.invalidCapNumber = 1;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+    }
+
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    return performX86PageTableInvocationMapFrames(asid, vaddr, ptSlot.ptSlot, window.slot, numFrames,
+                                                  rightsMask, vmAttr, vspace);
+}
+
+static exception_t decodeX86PageTableUnmapFrames(word_t length, cap_t cap, word_t *buffer)
+{
+    word_t          base = cap_page_table_cap_get_capPTMappedAddress(cap);
+    word_t          numFrames;
+    asid_t          asid;
+    vspace_root_t  *vspace;
+    lookupPTSlot_ret_t ptSlot;
+    lookupSlot_ret_t window;
+
+    if (length < 4 || current_extra_caps.excaprefs[0] == NULL) {
+        userError("X86PageTable: Truncated message.");
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    numFrames = getSyscallArg(3, buffer);
+
+    ptSlot = lookupX86PageTableSlot(cap, base, &vspace);
+    if (ptSlot.status != EXCEPTION_NONE) {
+        userError("X86PageTableUnmapFrames: Page table is not mapped.");
+        return ptSlot.status;
+    }
+    asid = cap_page_table_cap_get_capPTMappedASID(cap);
+
+    window = lookupSourceWindow(current_extra_caps.excaprefs[0]->cap,
+                                getSyscallArg(0, buffer), getSyscallArg(1, buffer),
+                                getSyscallArg(2, buffer), numFrames, BIT(PT_INDEX_BITS));
+    if (window.status != EXCEPTION_NONE) {
+        userError("X86PageTableUnmapFrames: Invalid frame window.");
+        return window.status;
+    }
+
+    for (word_t i = 0; i < numFrames; i++) {
+        cap_t frameCap = window.slot[i].cap;
+
+        if (cap_get_capType(frameCap) != cap_frame_cap ||
+            cap_frame_cap_get_capFSize(frameCap) != X86_SmallPage) {
+            userError("X86PageTableUnmapFrames: Slot %"SEL4_PRIu_word" of the window is not a small frame.", i);
+            current_syscall_error.type = seL4_InvalidCapability;
+            current_syscall_error.invalidCapNumber = 1;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+
+        /* Frames that are already unmapped are skipped, which makes this
+         * operation restartable after preemption. */
+        if (cap_frame_cap_get_capFMappedASID(frameCap) != asidInvalid &&
+            (cap_frame_cap_get_capFMappedASID(frameCap) != asid ||
+             cap_frame_cap_get_capFMapType(frameCap) != X86_MappingVSpace ||
+             (cap_frame_cap_get_capFMappedAddress(frameCap) & ~MASK(PT_INDEX_BITS + PAGE_BITS)) != base)) {
+            userError("X86PageTableUnmapFrames: Slot %"SEL4_PRIu_word" of the window is not mapped by this page table.", i);
+            current_syscall_error.type = seL4_InvalidCapability;
+            current_syscall_error.invalidCapNumber = 1;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+    }
+
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    return performX86PageTableInvocationUnmapFrames(asid, PTE_PTR(cap_page_table_cap_get_capPTBasePtr(cap)),
+                                                    window.slot, numFrames, vspace);
+}
+#endif /* CONFIG_FRAME_RANGE_INVOCATIONS */
+
 static exception_t decodeX86PageTableInvocation(
     word_t invLabel,
     word_t length,
@@ -1163,6 +1507,16 @@ static exception_t decodeX86PageTableInvocation(
         return performX86PageTableInvocationUnmap(cap, cte);
     }
 
+#ifdef CONFIG_FRAME_RANGE_INVOCATIONS
+    if (invLabel == X86PageTableMapFrames) {
+        return decodeX86PageTableMapFrames(length, cap, buffer);
+    }
+
+    if (invLabel == X86PageTableUnmapFrames) {
+        return decodeX86PageTableUnmapFrames(length, cap, buffer);
+    }
+#endif
+
     if (invLabel != X86PageTableMap) {
         userError("X86PageTable: Illegal operation.");
         current_syscall_error.type = seL4_IllegalOperation;
@@ -49,8 +49,14 @@ uint32_t x86KSnumDrhu;
 /* Intel VT-d Root Entry Table */
 vtd_rte_t *x86KSvtdRootTable;
 uint32_t x86KSnumIOPTLevels;
+/* Number of levels above the last IO page table level that can map pages */
+uint32_t x86KSnumIOSuperPageLevels;
 uint32_t x86KSnumIODomainIDBits;
 uint32_t x86KSFirstValidIODomain;
+/* PCI devices in the scope of each IOMMU */
+acpi_drhd_list_t x86KSvtdDrhdList;
+/* Invalidation queue of each IOMMU, NULL if invalidation is register based */
+vtd_inv_queue_t *x86KSvtdInvQueues;
 #endif
 
 #ifdef CONFIG_VTX
@@ -73,3 +79,6 @@ word_t x86KSAllocatedIOPorts[NUM_IO_PORTS / CONFIG_WORD_SIZE];
 uint32_t x86KStscMhz;
 uint32_t x86KSapicRatio;
 #endif
+#ifdef CONFIG_FAST_CLEAR_MEMORY
+bool_t x86KSEnhancedRepStos;
+#endif
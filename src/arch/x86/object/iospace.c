@@ -37,31 +37,31 @@ BOOT_CODE cap_t master_iospace_cap(void)
         );
 }
 
-static vtd_cte_t *lookup_vtd_context_slot(cap_t cap)
+static uint32_t get_pci_request_id(cap_t cap)
 {
-    uint32_t   vtd_root_index;
-    uint32_t   vtd_context_index;
-    uint32_t   pci_request_id;
-    vtd_rte_t *vtd_root_slot;
-    vtd_cte_t *vtd_context;
-    vtd_cte_t *vtd_context_slot;
-
     switch (cap_get_capType(cap)) {
     case cap_io_space_cap:
-        pci_request_id = cap_io_space_cap_get_capPCIDevice(cap);
-        break;
+        return cap_io_space_cap_get_capPCIDevice(cap);
 
     case cap_io_page_table_cap:
-        pci_request_id = cap_io_page_table_cap_get_capIOPTIOASID(cap);
-        break;
+        return cap_io_page_table_cap_get_capIOPTIOASID(cap);
 
     case cap_frame_cap:
-        pci_request_id = cap_frame_cap_get_capFMappedASID(cap);
-        break;
+        return cap_frame_cap_get_capFMappedASID(cap);
 
     default:
         fail("Invalid cap type");
     }
+}
+
+static vtd_cte_t *lookup_vtd_context_slot(cap_t cap)
+{
+    uint32_t   vtd_root_index;
+    uint32_t   vtd_context_index;
+    uint32_t   pci_request_id = get_pci_request_id(cap);
+    vtd_rte_t *vtd_root_slot;
+    vtd_cte_t *vtd_context;
+    vtd_cte_t *vtd_context_slot;
 
     vtd_root_index = get_pci_bus(pci_request_id);
     vtd_root_slot = x86KSvtdRootTable + vtd_root_index;
@@ -93,7 +93,7 @@ static lookupIOPTSlot_ret_t lookupIOPTSlot_resolve_levels(vtd_pte_t *iopt, word_
                  MASK(VTD_PT_INDEX_BITS);
     iopt_slot = iopt + iopt_index;
 
-    if (!vtd_pte_ptr_get_write(iopt_slot) || levels_remaining == 0) {
+    if (!vtd_pte_ptr_get_write(iopt_slot) || vtd_pte_ptr_get_super_page(iopt_slot) || levels_remaining == 0) {
         ret.ioptSlot = iopt_slot;
         ret.level = levels_remaining;
         ret.status = EXCEPTION_NONE;
@@ -104,7 +104,9 @@ static lookupIOPTSlot_ret_t lookupIOPTSlot_resolve_levels(vtd_pte_t *iopt, word_
 }
 
 
-static inline lookupIOPTSlot_ret_t lookupIOPTSlot(vtd_pte_t *iopt, word_t io_address)
+/* Look up the slot of io_address in the IO page table at the given level,
+ * where level 0 is the last level */
+static inline lookupIOPTSlot_ret_t lookupIOPTSlot(vtd_pte_t *iopt, word_t io_address, word_t level)
 {
     lookupIOPTSlot_ret_t ret;
 
@@ -115,14 +117,21 @@ static inline lookupIOPTSlot_ret_t lookupIOPTSlot(vtd_pte_t *iopt, word_t io_add
         return ret;
     } else {
         return lookupIOPTSlot_resolve_levels(iopt, io_address >> PAGE_BITS,
-                                             x86KSnumIOPTLevels - 1, x86KSnumIOPTLevels - 1);
+                                             x86KSnumIOPTLevels - 1 - level, x86KSnumIOPTLevels - 1 - level);
     }
 }
 
+/* The IO page table level at which a frame is mapped, 0 being the last level */
+static inline word_t frameIOPTLevel(cap_t cap)
+{
+    return (pageBitsForSize(cap_frame_cap_get_capFSize(cap)) - seL4_PageBits) / VTD_PT_INDEX_BITS;
+}
+
 void unmapVTDContextEntry(cap_t cap)
 {
     vtd_cte_t *cte = lookup_vtd_context_slot(cap);
     assert(cte != 0);
+    uint16_t domain_id = vtd_cte_ptr_get_did(cte);
     *cte = vtd_cte_new(
                0,
                false,
@@ -133,7 +142,7 @@ void unmapVTDContextEntry(cap_t cap)
            );
 
     flushCacheRange(cte, VTD_CTE_SIZE_BITS);
-    invalidate_iotlb();
+    invalidate_iotlb_domain(get_pci_request_id(cap), domain_id);
     setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
     return;
 }
@@ -252,7 +261,7 @@ exception_t decodeX86IOPTInvocation(
         vtd_pte_t   iopte;
 
         vtd_pte = (vtd_pte_t *)paddr_to_pptr(vtd_cte_ptr_get_asr(vtd_context_slot));
-        lu_ret  = lookupIOPTSlot(vtd_pte, io_address);
+        lu_ret  = lookupIOPTSlot(vtd_pte, io_address, 0);
 
         if (lu_ret.status != EXCEPTION_NONE) {
             current_syscall_error.type = seL4_FailedLookup;
@@ -269,6 +278,7 @@ exception_t decodeX86IOPTInvocation(
 
         iopte = vtd_pte_new(
                     paddr,      /* physical addr            */
+                    0,          /* super page flag          */
                     1,          /* write permission flag    */
                     1           /* read  permission flag    */
                 );
@@ -302,6 +312,8 @@ exception_t decodeX86IOMapInvocation(
 {
     cap_t      io_space;
     word_t     io_address;
+    word_t     frame_bits;
+    word_t     level;
     uint32_t   pci_request_id;
     vtd_cte_t *vtd_context_slot;
     vtd_pte_t *vtd_pte;
@@ -317,7 +329,11 @@ exception_t decodeX86IOMapInvocation(
         return EXCEPTION_SYSCALL_ERROR;
     }
 
-    if (cap_frame_cap_get_capFSize(cap) != X86_SmallPage) {
+    /* Large pages are mapped by a single entry of a higher level IO page
+     * table, if the IOMMUs support pages of that size */
+    frame_bits = pageBitsForSize(cap_frame_cap_get_capFSize(cap));
+    level = frameIOPTLevel(cap);
+    if ((frame_bits - seL4_PageBits) % VTD_PT_INDEX_BITS != 0 || level > x86KSnumIOSuperPageLevels) {
         userError("X86PageMapIO: Invalid page size.");
         current_syscall_error.type = seL4_InvalidCapability;
         current_syscall_error.invalidCapNumber = 0;
@@ -332,7 +348,7 @@ exception_t decodeX86IOMapInvocation(
     }
 
     io_space    = current_extra_caps.excaprefs[0]->cap;
-    io_address  = getSyscallArg(1, buffer) & ~MASK(PAGE_BITS);
+    io_address  = getSyscallArg(1, buffer) & ~MASK(frame_bits);
     paddr       = pptr_to_paddr((void *)cap_frame_cap_get_capFBasePtr(cap));
 
     if (cap_get_capType(io_space) != cap_io_space_cap) {
@@ -361,7 +377,7 @@ exception_t decodeX86IOMapInvocation(
     }
 
     vtd_pte = (vtd_pte_t *)paddr_to_pptr(vtd_cte_ptr_get_asr(vtd_context_slot));
-    lu_ret  = lookupIOPTSlot(vtd_pte, io_address);
+    lu_ret  = lookupIOPTSlot(vtd_pte, io_address, level);
     if (lu_ret.status != EXCEPTION_NONE || lu_ret.level != 0) {
         current_syscall_error.type = seL4_FailedLookup;
         current_syscall_error.failedLookupWasSource = false;
@@ -379,7 +395,7 @@ exception_t decodeX86IOMapInvocation(
     bool_t write = seL4_CapRights_get_capAllowWrite(dma_cap_rights_mask) && (frame_cap_rights == VMReadWrite);
     bool_t read = seL4_CapRights_get_capAllowRead(dma_cap_rights_mask) && (frame_cap_rights != VMKernelOnly);
     if (write || read) {
-        iopte = vtd_pte_new(paddr, !!write, !!read);
+        iopte = vtd_pte_new(paddr, level != 0, !!write, !!read);
     } else {
         current_syscall_error.type = seL4_InvalidArgument;
         current_syscall_error.invalidArgumentNumber = 0;
@@ -399,6 +415,7 @@ void deleteIOPageTable(cap_t io_pt_cap)
     lookupIOPTSlot_ret_t lu_ret;
     uint32_t             level;
     word_t               io_address;
+    uint16_t             domain_id;
     vtd_cte_t           *vtd_context_slot;
     vtd_pte_t           *vtd_pte;
 
@@ -411,6 +428,8 @@ void deleteIOPageTable(cap_t io_pt_cap)
             return;
         }
 
+        domain_id = vtd_cte_ptr_get_did(vtd_context_slot);
+
         vtd_pte = (vtd_pte_t *)paddr_to_pptr(vtd_cte_ptr_get_asr(vtd_context_slot));
 
         if (level == 0) {
@@ -441,12 +460,13 @@ void deleteIOPageTable(cap_t io_pt_cap)
             }
             *lu_ret.ioptSlot = vtd_pte_new(
                                    0,  /* Physical Address */
+                                   0,  /* Super Page       */
                                    0,  /* Read Permission  */
                                    0   /* Write Permission */
                                );
             flushCacheRange(lu_ret.ioptSlot, VTD_PTE_SIZE_BITS);
         }
-        invalidate_iotlb();
+        invalidate_iotlb_domain(cap_io_page_table_cap_get_capIOPTIOASID(io_pt_cap), domain_id);
     }
 }
 
@@ -454,10 +474,12 @@ void unmapIOPage(cap_t cap)
 {
     lookupIOPTSlot_ret_t lu_ret;
     word_t               io_address;
+    word_t               level;
     vtd_cte_t           *vtd_context_slot;
     vtd_pte_t           *vtd_pte;
 
     io_address  = cap_frame_cap_get_capFMappedAddress(cap);
+    level = frameIOPTLevel(cap);
     vtd_context_slot = lookup_vtd_context_slot(cap);
 
 
@@ -467,7 +489,7 @@ void unmapIOPage(cap_t cap)
 
     vtd_pte = (vtd_pte_t *)paddr_to_pptr(vtd_cte_ptr_get_asr(vtd_context_slot));
 
-    lu_ret  = lookupIOPTSlot(vtd_pte, io_address);
+    lu_ret  = lookupIOPTSlot(vtd_pte, io_address, level);
     if (lu_ret.status != EXCEPTION_NONE || lu_ret.level != 0) {
         return;
     }
@@ -478,12 +500,14 @@ void unmapIOPage(cap_t cap)
 
     *lu_ret.ioptSlot = vtd_pte_new(
                            0,  /* Physical Address */
+                           0,  /* Super Page       */
                            0,  /* Read Permission  */
                            0   /* Write Permission */
                        );
 
     flushCacheRange(lu_ret.ioptSlot, VTD_PTE_SIZE_BITS);
-    invalidate_iotlb();
+    invalidate_iotlb_page(cap_frame_cap_get_capFMappedASID(cap), vtd_cte_ptr_get_did(vtd_context_slot), io_address,
+                          pageBitsForSize(cap_frame_cap_get_capFSize(cap)));
 }
 
 exception_t performX86IOUnMapInvocation(cap_t cap, cte_t *ctSlot)
@@ -1345,7 +1345,7 @@ exception_t handleVmexit(void)
         return EXCEPTION_NONE;
     }
 
-    NODE_LOCK_SYS;
+    NODE_LOCK_FAULT;
 
     switch (reason) {
     case EXCEPTION_OR_NMI:
@@ -37,6 +37,12 @@ void handleRemoteCall(IpiRemoteCall_t call, word_t arg0, word_t arg1, word_t arg
             invalidateLocalTranslationAll();
             break;
 
+#ifdef CONFIG_TLB_BATCHING
+        case IpiRemoteCall_InvalidateTranslationRangeASID:
+            invalidateLocalTranslationRangeASID(arg0, arg1, arg2);
+            break;
+#endif
+
         case IpiRemoteCall_switchFpuOwner:
             switchLocalFpuOwner((tcb_t *)arg0);
             break;
@@ -11,7 +11,18 @@
 #include <types.h>
 #include <mode/machine.h>
 #include <benchmark/benchmark.h>
+#include <benchmark/benchmark_track.h>
 #include <benchmark/benchmark_utilisation.h>
+#include <smp/lock.h>
+#ifdef CONFIG_FAST_CLEAR_MEMORY
+#include <kernel/cspace.h>
+#include <object/cnode.h>
+#include <object/untyped.h>
+#include <sel4/benchmark_clear_memory_types.h>
+#endif
+#ifdef CONFIG_BENCHMARK_VCPU_SWITCH
+#include <arch/object/vcpu.h>
+#endif
 
 
 exception_t handle_SysBenchmarkFlushCaches(void)
@@ -31,7 +42,22 @@ exception_t handle_SysBenchmarkFlushCaches(void)
 
 exception_t handle_SysBenchmarkResetLog(void)
 {
-#ifdef CONFIG_KERNEL_LOG_BUFFER
+#ifdef CONFIG_LOG_BUFFER_PER_NODE
+    bool_t buffer_set = false;
+    for (word_t i = 0; i < ksNumCPUs; i++) {
+        buffer_set |= NODE_STATE_ON_CORE(ksLogBuffer, i) != 0;
+    }
+    if (!buffer_set) {
+        userError("A user-level buffer has to be set before resetting benchmark.\
+                Use seL4_BenchmarkSetNodeLogBuffer\n");
+        setRegister(NODE_STATE(ksCurThread), capRegister, seL4_IllegalOperation);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    for (word_t i = 0; i < ksNumCPUs; i++) {
+        NODE_STATE_ON_CORE(ksLogIndex, i) = 0;
+    }
+#elif defined(CONFIG_KERNEL_LOG_BUFFER)
     if (ksUserLogBuffer == 0) {
         userError("A user-level buffer has to be set before resetting benchmark.\
                 Use seL4_BenchmarkSetLogBuffer\n");
@@ -42,6 +68,10 @@ exception_t handle_SysBenchmarkResetLog(void)
     ksLogIndex = 0;
 #endif /* CONFIG_KERNEL_LOG_BUFFER */
 
+#ifdef CONFIG_BENCHMARK_ENTRY_HISTOGRAMS
+    benchmark_track_reset_histograms();
+#endif /* CONFIG_BENCHMARK_ENTRY_HISTOGRAMS */
+
 #ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
     NODE_STATE(benchmark_log_utilisation_enabled) = true;
     benchmark_track_reset_utilisation(NODE_STATE(ksIdleThread));
@@ -51,6 +81,17 @@ exception_t handle_SysBenchmarkResetLog(void)
     NODE_STATE(benchmark_kernel_time) = 0;
     NODE_STATE(benchmark_kernel_number_entries) = 0;
     NODE_STATE(benchmark_kernel_number_schedules) = 1;
+#ifdef CONFIG_PREEMPTION_TIME_BUDGET
+    NODE_STATE(benchmark_max_nonpreemptible_time) = 0;
+#endif
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+    NODE_STATE(benchmark_cap_lookup_cache_hits) = 0;
+    NODE_STATE(benchmark_cap_lookup_cache_misses) = 0;
+#endif
+#ifdef CONFIG_FPU_LAZY_SWITCH
+    NODE_STATE(benchmark_fpu_switches_deferred) = 0;
+    NODE_STATE(benchmark_fpu_restores) = 0;
+#endif
     benchmark_arch_utilisation_reset();
 #endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
 
@@ -60,7 +101,18 @@ exception_t handle_SysBenchmarkResetLog(void)
 
 exception_t handle_SysBenchmarkFinalizeLog(void)
 {
-#ifdef CONFIG_KERNEL_LOG_BUFFER
+#ifdef CONFIG_LOG_BUFFER_PER_NODE
+    /* The number of entries of every node is returned in the IPC buffer, and
+     * that of node 0 in the return register as without per-node buffers. */
+    word_t *ipcBuffer = lookupIPCBuffer(true, NODE_STATE(ksCurThread));
+    for (word_t i = 0; i < ksNumCPUs; i++) {
+        NODE_STATE_ON_CORE(ksLogIndexFinalized, i) = NODE_STATE_ON_CORE(ksLogIndex, i);
+        if (ipcBuffer != NULL && i < seL4_MsgMaxLength) {
+            ipcBuffer[i + 1] = NODE_STATE_ON_CORE(ksLogIndexFinalized, i);
+        }
+    }
+    setRegister(NODE_STATE(ksCurThread), capRegister, NODE_STATE_ON_CORE(ksLogIndexFinalized, 0));
+#elif defined(CONFIG_KERNEL_LOG_BUFFER)
     ksLogIndexFinalized = ksLogIndex;
     setRegister(NODE_STATE(ksCurThread), capRegister, ksLogIndexFinalized);
 #endif /* CONFIG_KERNEL_LOG_BUFFER */
@@ -72,20 +124,106 @@ exception_t handle_SysBenchmarkFinalizeLog(void)
     return EXCEPTION_NONE;
 }
 
+#ifdef CONFIG_LOG_BUFFER_PER_NODE
+/* Unlike the shared log buffer, which is mapped at KS_LOG_PPTR, the buffer of
+ * a node is accessed through the kernel window. */
+static exception_t benchmark_set_node_log_buffer(word_t frame_cptr, word_t node)
+{
+    lookupCapAndSlot_ret_t lu_ret;
+
+    if (node >= ksNumCPUs) {
+        userError("Invalid node %"SEL4_PRIu_word" for log buffer.", node);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    lu_ret = lookupCapAndSlot(NODE_STATE(ksCurThread), frame_cptr);
+    if (unlikely(lu_ret.status != EXCEPTION_NONE)) {
+        userError("Invalid cap #%"SEL4_PRIu_word".", frame_cptr);
+        current_fault = seL4_Fault_CapFault_new(frame_cptr, false);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    if (cap_get_capType(lu_ret.cap) != cap_frame_cap || cap_frame_cap_get_capFIsDevice(lu_ret.cap)) {
+        userError("Invalid cap. Log buffer should be of a non-device frame cap");
+        current_fault = seL4_Fault_CapFault_new(frame_cptr, false);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    if (BIT(pageBitsForSize(cap_frame_cap_get_capFSize(lu_ret.cap))) < seL4_LogBufferSize) {
+        userError("Invalid frame size. The kernel expects at least a 1M log buffer");
+        current_fault = seL4_Fault_CapFault_new(frame_cptr, false);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    NODE_STATE_ON_CORE(ksLogIndex, node) = 0;
+    NODE_STATE_ON_CORE(ksLogBuffer, node) = cap_frame_cap_get_capFBasePtr(lu_ret.cap);
+    return EXCEPTION_NONE;
+}
+
+void benchmark_release_log_buffer(word_t frame_pptr)
+{
+    for (word_t i = 0; i < ksNumCPUs; i++) {
+        if (NODE_STATE_ON_CORE(ksLogBuffer, i) == frame_pptr) {
+            NODE_STATE_ON_CORE(ksLogBuffer, i) = 0;
+            userError("Log buffer frame of node %"SEL4_PRIu_word" is deleted, the node can't benchmark anymore", i);
+        }
+    }
+}
+#endif /* CONFIG_LOG_BUFFER_PER_NODE */
+
 #ifdef CONFIG_KERNEL_LOG_BUFFER
 exception_t handle_SysBenchmarkSetLogBuffer(void)
 {
     word_t cptr_userFrame = getRegister(NODE_STATE(ksCurThread), capRegister);
+#ifdef CONFIG_LOG_BUFFER_PER_NODE
+    word_t node = getRegister(NODE_STATE(ksCurThread), msgInfoRegister);
+    if (benchmark_set_node_log_buffer(cptr_userFrame, node) != EXCEPTION_NONE) {
+#else
     if (benchmark_arch_map_logBuffer(cptr_userFrame) != EXCEPTION_NONE) {
+#endif
         setRegister(NODE_STATE(ksCurThread), capRegister, seL4_IllegalOperation);
         return EXCEPTION_SYSCALL_ERROR;
     }
 
+#ifdef CONFIG_BENCHMARK_ENTRY_HISTOGRAMS
+    benchmark_track_reset_histograms();
+#endif /* CONFIG_BENCHMARK_ENTRY_HISTOGRAMS */
+
     setRegister(NODE_STATE(ksCurThread), capRegister, seL4_NoError);
     return EXCEPTION_NONE;
 }
 #endif /* CONFIG_KERNEL_LOG_BUFFER */
 
+#ifdef CONFIG_BENCHMARK_ENTRY_HISTOGRAMS
+exception_t handle_SysBenchmarkGetHistogram(void)
+{
+    tcb_t *thread = NODE_STATE(ksCurThread);
+    word_t index = getRegister(thread, capRegister);
+    word_t *ipcBuffer = lookupIPCBuffer(true, thread);
+    benchmark_track_histogram_t *ksLog = (benchmark_track_histogram_t *) KS_LOG_PPTR;
+
+    if (ksUserLogBuffer == 0 || ipcBuffer == NULL) {
+        userError("SysBenchmarkGetHistogram: a log buffer and an IPC buffer are required.");
+        setRegister(thread, capRegister, 0);
+        return EXCEPTION_NONE;
+    }
+
+    if (index >= ksLogIndex) {
+        setRegister(thread, capRegister, 0);
+        return EXCEPTION_NONE;
+    }
+
+    /* Copy the buckets to the IPC buffer so that the caller sees a consistent
+     * snapshot, rather than one that is being updated by other cores. */
+    for (word_t i = 0; i < seL4_NumBenchmarkHistogramBuckets; i++) {
+        ipcBuffer[i + 1] = ksLog[index].buckets[i];
+    }
+
+    setRegister(thread, capRegister, ksLog[index].count);
+    return EXCEPTION_NONE;
+}
+#endif /* CONFIG_BENCHMARK_ENTRY_HISTOGRAMS */
+
 #ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
 
 exception_t handle_SysBenchmarkGetThreadUtilisation(void)
@@ -124,6 +262,22 @@ exception_t handle_SysBenchmarkDumpAllThreadsUtilisation(void)
     printf("  \"BENCHMARK_TOTAL_KERNEL_UTILISATION\":%lu,\n", (word_t) NODE_STATE(benchmark_kernel_time));
     printf("  \"BENCHMARK_TOTAL_NUMBER_KERNEL_ENTRIES\":%lu,\n", (word_t) NODE_STATE(benchmark_kernel_number_entries));
     printf("  \"BENCHMARK_TOTAL_NUMBER_SCHEDULES\":%lu,\n", (word_t) NODE_STATE(benchmark_kernel_number_schedules));
+#ifdef CONFIG_PREEMPTION_TIME_BUDGET
+    printf("  \"BENCHMARK_TOTAL_MAX_NONPREEMPTIBLE_TIME\":%lu,\n",
+           (word_t) NODE_STATE(benchmark_max_nonpreemptible_time));
+#endif
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+    printf("  \"BENCHMARK_TOTAL_CAP_LOOKUP_CACHE_HITS\":%lu,\n",
+           (word_t) NODE_STATE(benchmark_cap_lookup_cache_hits));
+    printf("  \"BENCHMARK_TOTAL_CAP_LOOKUP_CACHE_MISSES\":%lu,\n",
+           (word_t) NODE_STATE(benchmark_cap_lookup_cache_misses));
+#endif
+#ifdef CONFIG_FPU_LAZY_SWITCH
+    printf("  \"BENCHMARK_TOTAL_FPU_SWITCHES_DEFERRED\":%lu,\n",
+           (word_t) NODE_STATE(benchmark_fpu_switches_deferred));
+    printf("  \"BENCHMARK_TOTAL_FPU_RESTORES\":%lu,\n",
+           (word_t) NODE_STATE(benchmark_fpu_restores));
+#endif
     printf("  \"BENCHMARK_TCB_\": [\n");
     for (tcb_t *curr = NODE_STATE(ksDebugTCBs); curr != NULL; curr = TCB_PTR_DEBUG_PTR(curr)->tcbDebugNext) {
         printf("    {\n");
@@ -153,4 +307,175 @@ exception_t handle_SysBenchmarkResetAllThreadsUtilisation(void)
 
 #endif /* CONFIG_DEBUG_BUILD */
 #endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
+
+#ifdef CONFIG_BENCHMARK_LOCK_CONTENTION
+exception_t handle_SysBenchmarkGetLockContention(void)
+{
+    tcb_t *thread = NODE_STATE(ksCurThread);
+    word_t node = getRegister(thread, capRegister);
+    word_t *ipcBuffer = lookupIPCBuffer(true, thread);
+    uint64_t *buffer;
+    clh_lock_stats_t *stats;
+
+    if (node >= ksNumCPUs || ipcBuffer == NULL) {
+        userError("SysBenchmarkGetLockContention: a valid node and an IPC buffer are required.");
+        setRegister(thread, capRegister, seL4_InvalidArgument);
+        return EXCEPTION_NONE;
+    }
+
+    /* Counters of other nodes are only updated while the lock is held, which
+     * we hold, except for the remote call counters. */
+    buffer = (uint64_t *) &ipcBuffer[1];
+    stats = &clh_lock_stats[node];
+    for (word_t i = 0; i < BENCHMARK_LOCK_NUM_ENTRY_TYPES; i++) {
+        buffer[BENCHMARK_LOCK_ACQUISITIONS + i] = stats->acquisitions[i];
+        buffer[BENCHMARK_LOCK_WAIT_CYCLES + i] = stats->wait_cycles[i];
+        buffer[BENCHMARK_LOCK_HOLD_CYCLES + i] = stats->hold_cycles[i];
+    }
+    buffer[BENCHMARK_LOCK_IPIS] = stats->ipis;
+    buffer[BENCHMARK_LOCK_IPI_CYCLES] = stats->ipi_cycles;
+
+    setRegister(thread, capRegister, seL4_NoError);
+    return EXCEPTION_NONE;
+}
+
+exception_t handle_SysBenchmarkResetLockContention(void)
+{
+    clh_lock_stats_reset();
+    return EXCEPTION_NONE;
+}
+#endif /* CONFIG_BENCHMARK_LOCK_CONTENTION */
+
+#ifdef CONFIG_FAST_CLEAR_MEMORY
+exception_t handle_SysBenchmarkClearMemory(void)
+{
+    tcb_t *thread = NODE_STATE(ksCurThread);
+    word_t size_bits = getRegister(thread, msgRegisters[0]);
+    word_t *ipcBuffer = lookupIPCBuffer(true, thread);
+    lookupCapAndSlot_ret_t lu_ret;
+    uint64_t *buffer;
+    void *region;
+    timestamp_t start;
+
+    lu_ret = lookupCapAndSlot(thread, getRegister(thread, capRegister));
+    if (lu_ret.status != EXCEPTION_NONE || cap_get_capType(lu_ret.cap) != cap_untyped_cap
+        || cap_untyped_cap_get_capIsDevice(lu_ret.cap)
+        || size_bits < seL4_MinUntypedBits || size_bits > cap_untyped_cap_get_capBlockSize(lu_ret.cap)
+        || ensureNoChildren(lu_ret.slot) != EXCEPTION_NONE || ipcBuffer == NULL) {
+        userError("SysBenchmarkClearMemory: a RAM untyped without children of at least size_bits, "
+                  "and an IPC buffer are required.");
+        setRegister(thread, capRegister, seL4_InvalidArgument);
+        return EXCEPTION_NONE;
+    }
+
+    /* The untyped has no children, so its memory is unused and may be cleared
+     * at any time. Each method clears the same memory, and the whole of it is
+     * cleared without preemption. */
+    region = WORD_PTR(cap_untyped_cap_get_capPtr(lu_ret.cap));
+    buffer = (uint64_t *) &ipcBuffer[1];
+
+    start = timestamp();
+    memzero(region, BIT(size_bits));
+    buffer[BENCHMARK_CLEAR_MEMORY_WORD_LOOP] = timestamp() - start;
+
+    start = timestamp();
+    clearMemory(region, size_bits);
+    buffer[BENCHMARK_CLEAR_MEMORY_OBJECT] = timestamp() - start;
+
+    start = timestamp();
+    clearMemory_NT(region, size_bits);
+    buffer[BENCHMARK_CLEAR_MEMORY_RESET] = timestamp() - start;
+
+    setRegister(thread, capRegister, seL4_NoError);
+    return EXCEPTION_NONE;
+}
+#endif /* CONFIG_FAST_CLEAR_MEMORY */
+
+#ifdef CONFIG_BENCHMARK_FASTPATH_EXITS
+exception_t handle_SysBenchmarkGetFastpathExits(void)
+{
+    tcb_t *thread = NODE_STATE(ksCurThread);
+    word_t node = getRegister(thread, capRegister);
+    word_t *ipcBuffer = lookupIPCBuffer(true, thread);
+    uint64_t *buffer;
+
+    if (node >= ksNumCPUs || ipcBuffer == NULL) {
+        userError("SysBenchmarkGetFastpathExits: a valid node and an IPC buffer are required.");
+        setRegister(thread, capRegister, seL4_InvalidArgument);
+        return EXCEPTION_NONE;
+    }
+
+    buffer = (uint64_t *) &ipcBuffer[1];
+    for (word_t i = 0; i < BENCHMARK_FASTPATH_NUM_EXITS; i++) {
+        buffer[i] = NODE_STATE_ON_CORE(benchmark_fastpath_exits, node)[i];
+    }
+
+    setRegister(thread, capRegister, seL4_NoError);
+    return EXCEPTION_NONE;
+}
+
+exception_t handle_SysBenchmarkResetFastpathExits(void)
+{
+    for (word_t node = 0; node < ksNumCPUs; node++) {
+        for (word_t i = 0; i < BENCHMARK_FASTPATH_NUM_EXITS; i++) {
+            NODE_STATE_ON_CORE(benchmark_fastpath_exits, node)[i] = 0;
+        }
+    }
+    return EXCEPTION_NONE;
+}
+#endif /* CONFIG_BENCHMARK_FASTPATH_EXITS */
+
+#ifdef CONFIG_BENCHMARK_VCPU_SWITCH
+static vcpu_t *benchmark_lookup_vcpu(tcb_t *thread)
+{
+    lookupCap_ret_t lu_ret;
+
+    lu_ret = lookupCap(thread, getRegister(thread, capRegister));
+    if (lu_ret.status != EXCEPTION_NONE || cap_get_capType(lu_ret.cap) != cap_vcpu_cap) {
+        return NULL;
+    }
+    return VCPU_PTR(cap_vcpu_cap_get_capVCPUPtr(lu_ret.cap));
+}
+
+exception_t handle_SysBenchmarkGetVCPUSwitchStats(void)
+{
+    tcb_t *thread = NODE_STATE(ksCurThread);
+    vcpu_t *vcpu = benchmark_lookup_vcpu(thread);
+    word_t *ipcBuffer = lookupIPCBuffer(true, thread);
+    uint64_t *buffer;
+
+    if (vcpu == NULL || ipcBuffer == NULL) {
+        userError("SysBenchmarkGetVCPUSwitchStats: a VCPU cap and an IPC buffer are required.");
+        setRegister(thread, capRegister, seL4_InvalidArgument);
+        return EXCEPTION_NONE;
+    }
+
+    buffer = (uint64_t *) &ipcBuffer[1];
+    for (word_t i = 0; i < BENCHMARK_VCPU_SWITCH_NUM_STATS; i++) {
+        buffer[i] = vcpu->switchStats[i];
+    }
+
+    setRegister(thread, capRegister, seL4_NoError);
+    return EXCEPTION_NONE;
+}
+
+exception_t handle_SysBenchmarkResetVCPUSwitchStats(void)
+{
+    tcb_t *thread = NODE_STATE(ksCurThread);
+    vcpu_t *vcpu = benchmark_lookup_vcpu(thread);
+
+    if (vcpu == NULL) {
+        userError("SysBenchmarkResetVCPUSwitchStats: a VCPU cap is required.");
+        setRegister(thread, capRegister, seL4_InvalidArgument);
+        return EXCEPTION_NONE;
+    }
+
+    for (word_t i = 0; i < BENCHMARK_VCPU_SWITCH_NUM_STATS; i++) {
+        vcpu->switchStats[i] = 0;
+    }
+
+    setRegister(thread, capRegister, seL4_NoError);
+    return EXCEPTION_NONE;
+}
+#endif /* CONFIG_BENCHMARK_VCPU_SWITCH */
 #endif /* CONFIG_ENABLE_BENCHMARKS */
@@ -14,21 +14,112 @@ timestamp_t ksEnter;
 seL4_Word ksLogIndex;
 seL4_Word ksLogIndexFinalized;
 
+#ifdef CONFIG_BENCHMARK_ENTRY_HISTOGRAMS
+
+/* Size of the hash index, at least twice the number of histograms so that
+ * probe sequences stay short. */
+#define HISTOGRAM_INDEX_BITS 14
+/* Bound on the work done to find a histogram on each kernel exit */
+#define HISTOGRAM_MAX_PROBES 8
+
+compile_assert(histogram_index_big_enough, BIT(HISTOGRAM_INDEX_BITS) >= 2 * MAX_LOG_SIZE)
+compile_assert(histogram_index_fits, MAX_LOG_SIZE <= BIT(16))
+
+/* Open addressed hash index from kernel entry keys to histograms in the log
+ * buffer. As histogram 0 is the overflow histogram, 0 marks an empty slot. */
+static uint16_t ksHistogramIndex[BIT(HISTOGRAM_INDEX_BITS)] ALIGN(sizeof(word_t));
+
+/* Drop the parts of a kernel entry that histograms are not keyed on. */
+static kernel_entry_t histogram_entry(kernel_entry_t entry)
+{
+    kernel_entry_t key = { .path = entry.path };
+
+    if (entry.path == Entry_Syscall) {
+        key.syscall_no = entry.syscall_no;
+        key.cap_type = entry.cap_type;
+        key.is_fastpath = entry.is_fastpath;
+        key.invocation_tag = entry.invocation_tag;
+    } else if (entry.path == Entry_Interrupt) {
+        key.core = entry.core;
+        key.word = entry.word;
+    }
+
+    return key;
+}
+
+static inline uint32_t histogram_key(kernel_entry_t entry)
+{
+    return (uint32_t)entry.path | (uint32_t)entry.core << 3 | (uint32_t)entry.word << 6;
+}
+
+static benchmark_track_histogram_t *histogram_lookup(kernel_entry_t entry)
+{
+    benchmark_track_histogram_t *ksLog = (benchmark_track_histogram_t *) KS_LOG_PPTR;
+    uint32_t key = histogram_key(entry);
+    word_t hash = (key * 0x9e3779b1u) >> (32 - HISTOGRAM_INDEX_BITS);
+
+    for (word_t i = 0; i < HISTOGRAM_MAX_PROBES; i++) {
+        uint16_t *slot = &ksHistogramIndex[(hash + i) & MASK(HISTOGRAM_INDEX_BITS)];
+
+        if (*slot == 0) {
+            /* If the log buffer is full, count in the overflow histogram */
+            if (unlikely(ksLogIndex >= MAX_LOG_SIZE)) {
+                break;
+            }
+            memzero(&ksLog[ksLogIndex], sizeof(benchmark_track_histogram_t));
+            ksLog[ksLogIndex].entry = entry;
+            *slot = ksLogIndex;
+            ksLogIndex++;
+            return &ksLog[*slot];
+        }
+
+        if (histogram_key(ksLog[*slot].entry) == key) {
+            return &ksLog[*slot];
+        }
+    }
+
+    return &ksLog[seL4_BenchmarkHistogramOverflow];
+}
+
+void benchmark_track_reset_histograms(void)
+{
+    benchmark_track_histogram_t *ksLog = (benchmark_track_histogram_t *) KS_LOG_PPTR;
+
+    memzero(ksHistogramIndex, sizeof(ksHistogramIndex));
+    memzero(&ksLog[seL4_BenchmarkHistogramOverflow], sizeof(benchmark_track_histogram_t));
+    ksLogIndex = seL4_BenchmarkHistogramOverflow + 1;
+}
+
 void benchmark_track_exit(void)
 {
-    timestamp_t duration = 0;
     timestamp_t ksExit = timestamp();
-    benchmark_track_kernel_entry_t *ksLog = (benchmark_track_kernel_entry_t *) KS_LOG_PPTR;
 
     if (likely(ksUserLogBuffer != 0)) {
+        uint64_t duration = ksExit - ksEnter;
+        benchmark_track_histogram_t *histogram = histogram_lookup(histogram_entry(ksKernelEntry));
+        word_t bucket = duration == 0 ? 0 : 63 - clzll(duration);
+
+        histogram->count++;
+        histogram->buckets[MIN(bucket, seL4_NumBenchmarkHistogramBuckets - 1)]++;
+    }
+}
+#else
+void benchmark_track_exit(void)
+{
+    timestamp_t duration = 0;
+    timestamp_t ksExit = timestamp();
+    benchmark_track_kernel_entry_t *ksLog = (benchmark_track_kernel_entry_t *) KS_LOG_BUFFER_PPTR;
+
+    if (likely(KS_LOG_BUFFER_SET)) {
         /* If Log buffer is filled, do nothing */
-        if (likely(ksLogIndex < MAX_LOG_SIZE)) {
+        if (likely(KS_LOG_INDEX < MAX_LOG_SIZE)) {
             duration = ksExit - ksEnter;
-            ksLog[ksLogIndex].entry = ksKernelEntry;
-            ksLog[ksLogIndex].start_time = ksEnter;
-            ksLog[ksLogIndex].duration = duration;
-            ksLogIndex++;
+            ksLog[KS_LOG_INDEX].entry = ksKernelEntry;
+            ksLog[KS_LOG_INDEX].start_time = ksEnter;
+            ksLog[KS_LOG_INDEX].duration = duration;
+            KS_LOG_INDEX++;
         }
     }
 }
+#endif /* CONFIG_BENCHMARK_ENTRY_HISTOGRAMS */
 #endif /* CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES */
@@ -65,6 +65,20 @@ void benchmark_track_utilisation_dump(void)
     buffer[BENCHMARK_TOTAL_KERNEL_UTILISATION] = NODE_STATE(benchmark_kernel_time);
     buffer[BENCHMARK_TOTAL_NUMBER_KERNEL_ENTRIES] = NODE_STATE(benchmark_kernel_number_entries);
 
+#ifdef CONFIG_FPU_LAZY_SWITCH
+    buffer[BENCHMARK_TOTAL_FPU_SWITCHES_DEFERRED] = NODE_STATE(benchmark_fpu_switches_deferred);
+    buffer[BENCHMARK_TOTAL_FPU_RESTORES] = NODE_STATE(benchmark_fpu_restores);
+#endif
+
+#ifdef CONFIG_PREEMPTION_TIME_BUDGET
+    buffer[BENCHMARK_TOTAL_MAX_NONPREEMPTIBLE_TIME] = NODE_STATE(benchmark_max_nonpreemptible_time);
+#endif
+
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+    buffer[BENCHMARK_TOTAL_CAP_LOOKUP_CACHE_HITS] = NODE_STATE(benchmark_cap_lookup_cache_hits);
+    buffer[BENCHMARK_TOTAL_CAP_LOOKUP_CACHE_MISSES] = NODE_STATE(benchmark_cap_lookup_cache_misses);
+#endif
+
 }
 
 void benchmark_track_reset_utilisation(tcb_t *tcb)
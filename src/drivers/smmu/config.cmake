@@ -5,3 +5,4 @@
 #
 
 register_driver(compatibility_strings "arm,mmu-500" PREFIX src/drivers/smmu CFILES "smmuv2.c")
+register_driver(compatibility_strings "arm,smmu-v3" PREFIX src/drivers/smmu CFILES "smmuv3.c")
@@ -0,0 +1,587 @@
+/*
+ * Copyright 2026, UNSW
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+#include <config.h>
+
+#ifdef CONFIG_ARM_SMMU
+
+#include <types.h>
+#include <machine.h>
+#include <arch/machine.h>
+#include <plat/machine/devices_gen.h>
+#include <plat/platform_gen.h>
+#include <drivers/smmu/smmuv3.h>
+
+/* The SMMUv3 has no context banks. The kernel emulates the SMMUv2 interface
+ * used by the SID and CB capabilities: each context bank is a context
+ * descriptor (stage 1) or a set of stage 2 fields in the STE (stage 2), and
+ * its index is used as the ASID or VMID that tags its TLB entries. Binding a
+ * SID to a context bank writes the SID's stream table entry. */
+
+compile_assert(smmu_max_sid_pow2, (SMMU_MAX_SID & (SMMU_MAX_SID - 1)) == 0)
+compile_assert(smmu_max_cb_asid, SMMU_MAX_CB <= BIT(8))
+
+#define SMMU_MAX_SID_BITS      CTZL(SMMU_MAX_SID)
+#define SMMU_NUM_L1_DESC       MAX(SMMU_MAX_SID >> STRTAB_SPLIT, 1)
+#define SMMU_CB_INVALID        SMMU_MAX_CB
+
+struct smmu_feature {
+    bool_t coherent;              /*coherent access to tables and queues*/
+    bool_t two_level;             /*2-level stream table in use*/
+    uint32_t sid_bits;            /*number of SID bits covered by the stream table*/
+    uint32_t cmdq_log2size;       /*log2 number of entries in the command queue*/
+    uint32_t evtq_log2size;       /*log2 number of entries in the event queue*/
+    uint32_t oas;                 /*output address size, in the IDR5.OAS encoding*/
+};
+
+struct smmu_queue {
+    uint32_t prod;                /*producer index, including the wrap flag*/
+    uint32_t cons;                /*last seen consumer index, including the wrap flag*/
+    uint32_t log2size;
+};
+
+struct smmu_cb_state {
+    bool_t valid;                 /*a vspace is assigned*/
+    paddr_t vspace;               /*paddr of the vspace root*/
+};
+
+struct smmu_fault {
+    uint32_t type;                /*event type, 0 if there is none*/
+    uint32_t sid;
+    word_t address;
+};
+
+/* The stream table is linear, or in 2-level format the level 2 tables are
+ * consecutive 4K chunks of the same array. Level 1 descriptors are only made
+ * valid when a SID they span is first bound, so the SMMU never walks the
+ * level 2 tables of unused parts of the SID space. */
+static uint64_t smmu_strtab[SMMU_MAX_SID * STE_DWORDS] ALIGN(MAX(SMMU_MAX_SID << STE_SIZE_BITS, BIT(seL4_PageBits)));
+static uint64_t smmu_strtab_l1[SMMU_NUM_L1_DESC] ALIGN(BIT(seL4_PageBits));
+static uint64_t smmu_cd[SMMU_MAX_CB][CD_DWORDS] ALIGN(BIT(CD_SIZE_BITS));
+static uint64_t smmu_cmdq_entries[BIT(SMMU_CMDQ_LOG2SIZE)][CMD_DWORDS] ALIGN(BIT(SMMU_CMDQ_LOG2SIZE) * CMD_DWORDS * 8);
+static uint64_t smmu_evtq_entries[BIT(SMMU_EVTQ_LOG2SIZE)][EVT_DWORDS] ALIGN(BIT(SMMU_EVTQ_LOG2SIZE) * EVT_DWORDS * 8);
+
+static struct smmu_feature smmu_dev_knowledge;
+static struct smmu_queue smmu_cmdq;
+static struct smmu_queue smmu_evtq;
+static struct smmu_cb_state smmu_cb_state[SMMU_MAX_CB];
+static word_t smmu_sid_cb[SMMU_MAX_SID];
+static struct smmu_fault smmu_cb_fault[SMMU_MAX_CB];
+static struct smmu_fault smmu_global_fault;
+
+/* Commands issued while a batch is open are only waited for when the batch
+ * ends, so all invalidations of an invocation complete behind one CMD_SYNC. */
+static bool_t smmu_batch_open;
+static bool_t smmu_cmdq_pending;
+
+static inline uint32_t smmu_read_reg32(pptr_t base, uint32_t index)
+{
+    return *(volatile uint32_t *)(base + index);
+}
+
+static inline void smmu_write_reg32(pptr_t base, uint32_t index, uint32_t val)
+{
+    *(volatile uint32_t *)(base + index) = val;
+}
+
+static inline void smmu_write_reg64(pptr_t base, uint32_t index, uint64_t val)
+{
+    *(volatile uint64_t *)(base + index) = val;
+}
+
+static inline paddr_t smmu_paddr(void *ptr)
+{
+    return addrFromKPPtr(ptr);
+}
+
+static inline void smmu_clean_mem(void *ptr, word_t size)
+{
+    /*make the kernel writes visible to an SMMU that does not snoop caches*/
+    if (!smmu_dev_knowledge.coherent) {
+        cleanCacheRange_RAM((word_t)ptr, (word_t)ptr + size - 1, smmu_paddr(ptr));
+    }
+    dsb();
+}
+
+static inline void smmu_invalidate_mem(void *ptr, word_t size)
+{
+    if (!smmu_dev_knowledge.coherent) {
+        invalidateCacheRange_RAM((word_t)ptr, (word_t)ptr + size - 1, smmu_paddr(ptr));
+    }
+}
+
+static void smmu_write_cr0(uint32_t val)
+{
+    int count = 0;
+    smmu_write_reg32(SMMU_PPTR, SMMU_CR0, val);
+    while (count < CMDQ_POLL_LOOP) {
+        if (smmu_read_reg32(SMMU_PPTR, SMMU_CR0ACK) == val) {
+            break;
+        }
+        count++;
+    }
+}
+
+static inline bool_t smmu_queue_full(struct smmu_queue *q)
+{
+    return Q_IDX(q->log2size, q->prod) == Q_IDX(q->log2size, q->cons) &&
+           Q_WRP(q->log2size, q->prod) != Q_WRP(q->log2size, q->cons);
+}
+
+static inline bool_t smmu_queue_empty(struct smmu_queue *q)
+{
+    return q->prod == q->cons;
+}
+
+static inline uint32_t smmu_queue_inc(struct smmu_queue *q, uint32_t p)
+{
+    return Q_PTR(q->log2size, p + 1);
+}
+
+static void smmu_cmdq_read_cons(void)
+{
+    uint32_t cons = smmu_read_reg32(SMMU_PPTR, SMMU_CMDQ_CONS);
+    uint32_t gerror = smmu_read_reg32(SMMU_PPTR, SMMU_GERROR) ^ smmu_read_reg32(SMMU_PPTR, SMMU_GERRORN);
+
+    if (unlikely(gerror & GERROR_CMDQ_ERR)) {
+        /*the command at the consumer index was rejected, replace it with a
+         *CMD_SYNC so the queue can make progress, and acknowledge the error*/
+        uint64_t *cmd = smmu_cmdq_entries[Q_IDX(smmu_cmdq.log2size, cons)];
+        printf("SMMU: command 0x%x rejected, error 0x%x\n",
+               (unsigned int)(cmd[0] & 0xff), (unsigned int)CMDQ_CONS_ERR_VAL(cons));
+        cmd[0] = CMD_OP(CMD_SYNC) | CMD_SYNC_0_CS_NONE;
+        cmd[1] = 0;
+        smmu_clean_mem(cmd, CMD_DWORDS * sizeof(uint64_t));
+        smmu_write_reg32(SMMU_PPTR, SMMU_GERRORN,
+                         smmu_read_reg32(SMMU_PPTR, SMMU_GERRORN) ^ GERROR_CMDQ_ERR);
+    }
+    smmu_cmdq.cons = Q_PTR(smmu_cmdq.log2size, cons);
+}
+
+static void smmu_cmdq_insert(uint64_t cmd_0, uint64_t cmd_1)
+{
+    int count = 0;
+    uint64_t *cmd;
+
+    /*the SMMU consumes commands as soon as they are published, so a full
+     *queue only needs to be waited on*/
+    while (smmu_queue_full(&smmu_cmdq) && count < CMDQ_POLL_LOOP) {
+        smmu_cmdq_read_cons();
+        count++;
+    }
+    /*writing the slot now would overwrite a command the SMMU has not
+     *consumed, so a queue that never drains is fatal*/
+    if (unlikely(smmu_queue_full(&smmu_cmdq))) {
+        printf("SMMU: command queue is not draining\n");
+        halt();
+    }
+    cmd = smmu_cmdq_entries[Q_IDX(smmu_cmdq.log2size, smmu_cmdq.prod)];
+    cmd[0] = cmd_0;
+    cmd[1] = cmd_1;
+    smmu_clean_mem(cmd, CMD_DWORDS * sizeof(uint64_t));
+    smmu_cmdq.prod = smmu_queue_inc(&smmu_cmdq, smmu_cmdq.prod);
+    smmu_write_reg32(SMMU_PPTR, SMMU_CMDQ_PROD, smmu_cmdq.prod);
+}
+
+static void smmu_cmdq_sync(void)
+{
+    int count = 0;
+
+    smmu_cmdq_insert(CMD_OP(CMD_SYNC) | CMD_SYNC_0_CS_NONE, 0);
+    /*the CMD_SYNC is complete once it has been consumed, and it completes
+     *only after all commands before it*/
+    while (count < CMDQ_POLL_LOOP) {
+        smmu_cmdq_read_cons();
+        if (smmu_queue_empty(&smmu_cmdq)) {
+            break;
+        }
+        count++;
+    }
+    smmu_cmdq_pending = false;
+}
+
+static void smmu_cmdq_issue(uint64_t cmd_0, uint64_t cmd_1)
+{
+    smmu_cmdq_insert(cmd_0, cmd_1);
+    smmu_cmdq_pending = true;
+    if (!smmu_batch_open) {
+        smmu_cmdq_sync();
+    }
+}
+
+void smmu_tlb_batch_begin(void)
+{
+    smmu_batch_open = true;
+}
+
+void smmu_tlb_batch_end(void)
+{
+    smmu_batch_open = false;
+    if (smmu_cmdq_pending) {
+        smmu_cmdq_sync();
+    }
+}
+
+static uint64_t *smmu_ste_ptr(word_t sid)
+{
+    if (smmu_dev_knowledge.two_level) {
+        uint64_t *l1 = &smmu_strtab_l1[sid >> STRTAB_SPLIT];
+        if (!*l1) {
+            /*the level 2 table was initialised to abort at boot*/
+            uint64_t *l2 = &smmu_strtab[(sid & ~MASK(STRTAB_SPLIT)) * STE_DWORDS];
+            *l1 = (smmu_paddr(l2) & STRTAB_L1_DESC_L2PTR_MASK) |
+                  STRTAB_L1_DESC_SPAN_SET(STRTAB_SPLIT + 1);
+            smmu_clean_mem(l1, sizeof(uint64_t));
+        }
+    }
+    return &smmu_strtab[sid * STE_DWORDS];
+}
+
+static void smmu_ste_write(word_t sid, uint64_t const *val)
+{
+    uint64_t *ste = smmu_ste_ptr(sid);
+
+    /* An STE cannot be written atomically. If the STE in use translates,
+     * it is made to abort and invalidated before the rest of it changes,
+     * then the first double word containing the config is written last. */
+    if (ste[0] != (STE_0_V | STE_0_CFG_SET(STE_0_CFG_ABORT))) {
+        ste[0] = STE_0_V | STE_0_CFG_SET(STE_0_CFG_ABORT);
+        smmu_clean_mem(ste, sizeof(uint64_t));
+        smmu_cmdq_insert(CMD_OP(CMD_CFGI_STE) | CMD_0_SID_SET(sid), 0);
+        smmu_cmdq_sync();
+    }
+    for (int i = 1; i < STE_DWORDS; i++) {
+        ste[i] = val[i];
+    }
+    smmu_clean_mem(ste, STE_DWORDS * sizeof(uint64_t));
+    ste[0] = val[0];
+    smmu_clean_mem(ste, sizeof(uint64_t));
+    /*not a leaf invalidation, also covering the level 1 descriptor*/
+    smmu_cmdq_issue(CMD_OP(CMD_CFGI_STE) | CMD_0_SID_SET(sid), 0);
+}
+
+static void smmu_ste_update(word_t sid)
+{
+    uint64_t ste[STE_DWORDS] = { STE_0_V | STE_0_CFG_SET(STE_0_CFG_ABORT) };
+    word_t cb = smmu_sid_cb[sid];
+
+    if (cb == SMMU_CB_INVALID) {
+        smmu_ste_write(sid, ste);
+        return;
+    }
+#ifdef CONFIG_ARM_HYPERVISOR_SUPPORT
+    /*stage 2, a context bank without a vspace aborts transactions*/
+    if (smmu_cb_state[cb].valid) {
+        ste[0] = STE_0_V | STE_0_CFG_SET(STE_0_CFG_S2_TRANS);
+        ste[2] = STE_2_S2VMID_SET(cb);
+        ste[2] |= STE_2_S2IR0_SET(SMMU_CACHE_WBWA) | STE_2_S2OR0_SET(SMMU_CACHE_WBWA);
+        ste[2] |= STE_2_S2SH0_SET(SMMU_SH_ISH) | STE_2_S2TG_4K;
+        /*setting according to the vcpu_init_vtcr in vcpu.h*/
+#ifdef CONFIG_ARM_PA_SIZE_BITS_40
+        ste[2] |= STE_2_S2T0SZ_SET(24) | STE_2_S2SL0_SET(1) | STE_2_S2PS_SET(2);
+#else
+        ste[2] |= STE_2_S2T0SZ_SET(20) | STE_2_S2SL0_SET(2) | STE_2_S2PS_SET(4);
+#endif
+        ste[2] |= STE_2_S2AA64 | STE_2_S2PTW | STE_2_S2R;
+        ste[3] = smmu_cb_state[cb].vspace & STE_3_S2TTB_MASK;
+    }
+#else
+    /*stage 1, the CD of a context bank without a vspace is invalid*/
+    ste[0] = STE_0_V | STE_0_CFG_SET(STE_0_CFG_S1_TRANS);
+    ste[0] |= smmu_paddr(smmu_cd[cb]) & STE_0_S1CTXPTR_MASK;
+    if (smmu_dev_knowledge.coherent) {
+        ste[1] = STE_1_S1CIR_SET(SMMU_CACHE_WBWA) | STE_1_S1COR_SET(SMMU_CACHE_WBWA) |
+                 STE_1_S1CSH_SET(SMMU_SH_ISH);
+    } else {
+        ste[1] = STE_1_S1CIR_SET(SMMU_CACHE_NC) | STE_1_S1COR_SET(SMMU_CACHE_NC) |
+                 STE_1_S1CSH_SET(SMMU_SH_OSH);
+    }
+    ste[1] |= STE_1_STRW_NSEL1 | STE_1_SHCFG_INCOMING;
+#endif /*CONFIG_ARM_HYPERVISOR_SUPPORT*/
+    smmu_ste_write(sid, ste);
+}
+
+static void smmu_cb_update_sids(word_t cb)
+{
+    /*the SIDs bound to the context bank pick up its new configuration*/
+    for (word_t sid = 0; sid < SMMU_MAX_SID; sid++) {
+        if (smmu_sid_cb[sid] == cb) {
+#ifdef CONFIG_ARM_HYPERVISOR_SUPPORT
+            smmu_ste_update(sid);
+#else
+            smmu_cmdq_issue(CMD_OP(CMD_CFGI_CD_ALL) | CMD_0_SID_SET(sid), 0);
+#endif
+        }
+    }
+}
+
+BOOT_CODE static void smmu_config_prob(void)
+{
+    uint32_t reg, idr0;
+
+    /*ID0*/
+    idr0 = smmu_read_reg32(SMMU_PPTR, SMMU_IDR0);
+    smmu_dev_knowledge.coherent = !!(idr0 & IDR0_COHACC);
+#ifdef CONFIG_ARM_HYPERVISOR_SUPPORT
+    if (!(idr0 & IDR0_S2P)) {
+        printf("SMMU: stage 2 translation not supported\n");
+    }
+#else
+    if (!(idr0 & IDR0_S1P)) {
+        printf("SMMU: stage 1 translation not supported\n");
+    }
+#endif
+
+    /*ID1*/
+    reg = smmu_read_reg32(SMMU_PPTR, SMMU_IDR1);
+    /*the SID space the kernel manages is bounded by SMMU_MAX_SID*/
+    smmu_dev_knowledge.sid_bits = MIN(IDR1_SIDSIZE_VAL(reg), SMMU_MAX_SID_BITS);
+    /*a 2-level stream table is only worth it for more than one level 2 table*/
+    smmu_dev_knowledge.two_level = IDR0_ST_LEVEL_VAL(idr0) == IDR0_ST_LEVEL_2LVL &&
+                                   smmu_dev_knowledge.sid_bits > STRTAB_SPLIT;
+    smmu_dev_knowledge.cmdq_log2size = MIN(IDR1_CMDQS_VAL(reg), SMMU_CMDQ_LOG2SIZE);
+    smmu_dev_knowledge.evtq_log2size = MIN(IDR1_EVENTQS_VAL(reg), SMMU_EVTQ_LOG2SIZE);
+
+    /*ID5*/
+    reg = smmu_read_reg32(SMMU_PPTR, SMMU_IDR5);
+    if (!(reg & IDR5_GRAN4K)) {
+        printf("SMMU: 4K translation granule not supported\n");
+    }
+    /*52 bit output addresses require the 64K granule*/
+    smmu_dev_knowledge.oas = MIN(IDR5_OAS_VAL(reg), 5);
+}
+
+BOOT_CODE static void smmu_strtab_init(void)
+{
+    uint64_t base_cfg;
+
+    for (word_t sid = 0; sid < SMMU_MAX_SID; sid++) {
+        smmu_strtab[sid * STE_DWORDS] = STE_0_V | STE_0_CFG_SET(STE_0_CFG_ABORT);
+        smmu_sid_cb[sid] = SMMU_CB_INVALID;
+    }
+    smmu_clean_mem(smmu_strtab, sizeof(smmu_strtab));
+
+    if (smmu_dev_knowledge.two_level) {
+        /*all level 1 descriptors start out invalid*/
+        smmu_clean_mem(smmu_strtab_l1, sizeof(smmu_strtab_l1));
+        smmu_write_reg64(SMMU_PPTR, SMMU_STRTAB_BASE,
+                         STRTAB_BASE_RA | (smmu_paddr(smmu_strtab_l1) & STRTAB_BASE_ADDR_MASK));
+        base_cfg = STRTAB_BASE_CFG_FMT_2LVL | STRTAB_BASE_CFG_SPLIT_SET(STRTAB_SPLIT);
+    } else {
+        smmu_write_reg64(SMMU_PPTR, SMMU_STRTAB_BASE,
+                         STRTAB_BASE_RA | (smmu_paddr(smmu_strtab) & STRTAB_BASE_ADDR_MASK));
+        base_cfg = STRTAB_BASE_CFG_FMT_LINEAR;
+    }
+    base_cfg |= STRTAB_BASE_CFG_LOG2SIZE_SET(smmu_dev_knowledge.sid_bits);
+    smmu_write_reg32(SMMU_PPTR, SMMU_STRTAB_BASE_CFG, base_cfg);
+}
+
+BOOT_CODE static void smmu_queues_init(void)
+{
+    smmu_cmdq.log2size = smmu_dev_knowledge.cmdq_log2size;
+    smmu_cmdq.prod = 0;
+    smmu_cmdq.cons = 0;
+    smmu_write_reg64(SMMU_PPTR, SMMU_CMDQ_BASE,
+                     Q_BASE_RWA | (smmu_paddr(smmu_cmdq_entries) & Q_BASE_ADDR_MASK) |
+                     Q_BASE_LOG2SIZE_SET(smmu_cmdq.log2size));
+    smmu_write_reg32(SMMU_PPTR, SMMU_CMDQ_PROD, 0);
+    smmu_write_reg32(SMMU_PPTR, SMMU_CMDQ_CONS, 0);
+
+    smmu_evtq.log2size = smmu_dev_knowledge.evtq_log2size;
+    smmu_evtq.prod = 0;
+    smmu_evtq.cons = 0;
+    smmu_write_reg64(SMMU_PPTR, SMMU_EVENTQ_BASE,
+                     Q_BASE_RWA | (smmu_paddr(smmu_evtq_entries) & Q_BASE_ADDR_MASK) |
+                     Q_BASE_LOG2SIZE_SET(smmu_evtq.log2size));
+    smmu_write_reg32(SMMU_PPTR, SMMU_EVENTQ_PROD, 0);
+    smmu_write_reg32(SMMU_PPTR, SMMU_EVENTQ_CONS, 0);
+}
+
+BOOT_CODE static void smmu_dev_reset(void)
+{
+    uint32_t reg;
+    int count = 0;
+
+    /*disable the SMMU, aborting transactions until it is enabled again*/
+    smmu_write_cr0(0);
+    smmu_write_reg32(SMMU_PPTR, SMMU_GBPA, GBPA_UPDATE | GBPA_ABORT);
+    while (smmu_read_reg32(SMMU_PPTR, SMMU_GBPA) & GBPA_UPDATE && count < CMDQ_POLL_LOOP) {
+        count++;
+    }
+    /*the SMMU interrupts are not used, faults are read by the fault invocations*/
+    smmu_write_reg32(SMMU_PPTR, SMMU_IRQ_CTRL, 0);
+
+    /*memory attributes of the table and queue accesses*/
+    if (smmu_dev_knowledge.coherent) {
+        reg = CR1_TABLE_SH_SET(CR1_SH_ISH) | CR1_TABLE_OC_SET(CR1_CACHE_WB) |
+              CR1_TABLE_IC_SET(CR1_CACHE_WB) | CR1_QUEUE_SH_SET(CR1_SH_ISH) |
+              CR1_QUEUE_OC_SET(CR1_CACHE_WB) | CR1_QUEUE_IC_SET(CR1_CACHE_WB);
+    } else {
+        reg = CR1_TABLE_SH_SET(CR1_SH_OSH) | CR1_QUEUE_SH_SET(CR1_SH_OSH);
+    }
+    smmu_write_reg32(SMMU_PPTR, SMMU_CR1, reg);
+    /*record faults of invalid SIDs, and only invalidate the SMMU TLB by
+     *commands as the TLB of a context bank is tagged with its own ASID*/
+    smmu_write_reg32(SMMU_PPTR, SMMU_CR2, CR2_RECINVSID | CR2_PTM);
+
+    smmu_strtab_init();
+    smmu_queues_init();
+
+    /*enable the queues, then invalidate all cached configuration and TLB
+     *entries before enabling translation*/
+    reg = CR0_CMDQEN | CR0_EVENTQEN;
+    smmu_write_cr0(reg);
+    smmu_cmdq_insert(CMD_OP(CMD_CFGI_ALL), CMD_1_RANGE_ALL);
+    smmu_cmdq_insert(CMD_OP(CMD_TLBI_NSNH_ALL), 0);
+    smmu_cmdq_sync();
+    smmu_write_cr0(reg | CR0_SMMUEN);
+}
+
+BOOT_CODE void plat_smmu_init(void)
+{
+    smmu_config_prob();
+    smmu_dev_reset();
+}
+
+void smmu_cb_assign_vspace(word_t cb, vspace_root_t *vspace, asid_t asid)
+{
+    smmu_cb_state[cb].valid = true;
+    smmu_cb_state[cb].vspace = pptr_to_paddr(vspace);
+#ifndef CONFIG_ARM_HYPERVISOR_SUPPORT
+    /* The ASID of the context bank is its index rather than the ASID of the
+     * vspace, so a vspace shared by several context banks is cached
+     * separately for each, as with the context banks of the SMMUv2. */
+    uint64_t *cd = smmu_cd[cb];
+    uint64_t cd_0 = CD_0_T0SZ_SET(64 - SMMU_VA_DEFAULT_BITS) | CD_0_TG0_4K;
+    if (smmu_dev_knowledge.coherent) {
+        cd_0 |= CD_0_IR0_SET(SMMU_CACHE_WBWA) | CD_0_OR0_SET(SMMU_CACHE_WBWA) | CD_0_SH0_SET(SMMU_SH_ISH);
+    } else {
+        cd_0 |= CD_0_IR0_SET(SMMU_CACHE_NC) | CD_0_OR0_SET(SMMU_CACHE_NC) | CD_0_SH0_SET(SMMU_SH_OSH);
+    }
+    /*disable (speculative) page table walks through TTBR1*/
+    cd_0 |= CD_0_EPD1 | CD_0_IPS_SET(smmu_dev_knowledge.oas) | CD_0_AA64;
+    /*record and abort faulting transactions*/
+    cd_0 |= CD_0_R | CD_0_A | CD_0_ASET | CD_0_ASID_SET(cb) | CD_0_V;
+
+    cd[1] = smmu_cb_state[cb].vspace & CD_1_TTB0_MASK;
+    cd[2] = 0;
+    cd[3] = CD_MAIR_VALUE;
+    smmu_clean_mem(cd, CD_DWORDS * sizeof(uint64_t));
+    cd[0] = cd_0;
+    smmu_clean_mem(cd, sizeof(uint64_t));
+#endif /*!CONFIG_ARM_HYPERVISOR_SUPPORT*/
+    smmu_cb_update_sids(cb);
+}
+
+void smmu_cb_disable(word_t cb, asid_t asid)
+{
+    smmu_cb_state[cb].valid = false;
+#ifndef CONFIG_ARM_HYPERVISOR_SUPPORT
+    smmu_cd[cb][0] = 0;
+    smmu_clean_mem(smmu_cd[cb], sizeof(uint64_t));
+#endif
+    smmu_cb_update_sids(cb);
+    smmu_tlb_invalidate_cb(cb, asid);
+}
+
+void smmu_sid_bind_cb(word_t sid, word_t cb)
+{
+    smmu_sid_cb[sid] = cb;
+    smmu_ste_update(sid);
+}
+
+void smmu_sid_unbind(word_t sid)
+{
+    smmu_sid_cb[sid] = SMMU_CB_INVALID;
+    smmu_ste_update(sid);
+}
+
+void smmu_tlb_invalidate_all(void)
+{
+    /*all non-secure, non-hyp entries of both stages*/
+    smmu_cmdq_issue(CMD_OP(CMD_TLBI_NSNH_ALL), 0);
+}
+
+void smmu_tlb_invalidate_cb(int cb, asid_t asid)
+{
+#ifdef CONFIG_ARM_HYPERVISOR_SUPPORT
+    /*stage 2, the VMID is the context bank index*/
+    smmu_cmdq_issue(CMD_OP(CMD_TLBI_S12_VMALL) | CMD_0_VMID_SET(cb), 0);
+#else
+    /*stage 1, the ASID is the context bank index*/
+    smmu_cmdq_issue(CMD_OP(CMD_TLBI_NH_ASID) | CMD_0_ASID_SET(cb), 0);
+#endif
+}
+
+void smmu_tlb_invalidate_cb_va(int cb, asid_t asid, vptr_t vaddr)
+{
+#ifdef CONFIG_ARM_HYPERVISOR_SUPPORT
+    /*stage 2*/
+    smmu_cmdq_issue(CMD_OP(CMD_TLBI_S2_IPA) | CMD_0_VMID_SET(cb), CMD_1_ADDR_SET(vaddr));
+#else
+    /*stage 1*/
+    smmu_cmdq_issue(CMD_OP(CMD_TLBI_NH_VA) | CMD_0_ASID_SET(cb), CMD_1_ADDR_SET(vaddr));
+#endif
+}
+
+static void smmu_evtq_drain(void)
+{
+    uint32_t prod = smmu_read_reg32(SMMU_PPTR, SMMU_EVENTQ_PROD);
+    uint64_t *evt;
+    struct smmu_fault *fault;
+    word_t sid;
+
+    smmu_evtq.prod = Q_PTR(smmu_evtq.log2size, prod);
+    while (!smmu_queue_empty(&smmu_evtq)) {
+        evt = smmu_evtq_entries[Q_IDX(smmu_evtq.log2size, smmu_evtq.cons)];
+        smmu_invalidate_mem(evt, EVT_DWORDS * sizeof(uint64_t));
+        /*attribute the event to the context bank of its SID, keeping the
+         *first fault of each like the SMMUv2 fault status registers*/
+        sid = EVT_0_SID_VAL(evt[0]);
+        if (sid < SMMU_MAX_SID && smmu_sid_cb[sid] != SMMU_CB_INVALID) {
+            fault = &smmu_cb_fault[smmu_sid_cb[sid]];
+        } else {
+            fault = &smmu_global_fault;
+        }
+        if (!fault->type) {
+            fault->type = EVT_0_TYPE_VAL(evt[0]);
+            fault->sid = sid;
+            fault->address = evt[2];
+        }
+        smmu_evtq.cons = smmu_queue_inc(&smmu_evtq, smmu_evtq.cons);
+    }
+    /*events lost to an overflow are acknowledged with the consumer index*/
+    smmu_write_reg32(SMMU_PPTR, SMMU_EVENTQ_CONS, smmu_evtq.cons | (prod & Q_OVF));
+}
+
+void smmu_read_fault_state(uint32_t *status, uint32_t *syndrome_0, uint32_t *syndrome_1)
+{
+    smmu_evtq_drain();
+    /*the global errors that are active are those not yet acknowledged*/
+    *status = smmu_read_reg32(SMMU_PPTR, SMMU_GERROR) ^ smmu_read_reg32(SMMU_PPTR, SMMU_GERRORN);
+    /*events of SIDs not bound to a context bank*/
+    *syndrome_0 = smmu_global_fault.type;
+    *syndrome_1 = smmu_global_fault.sid;
+}
+
+void smmu_clear_fault_state(void)
+{
+    smmu_write_reg32(SMMU_PPTR, SMMU_GERRORN, smmu_read_reg32(SMMU_PPTR, SMMU_GERROR));
+    smmu_global_fault.type = 0;
+}
+
+void smmu_cb_read_fault_state(int cb, uint32_t *status, word_t *address)
+{
+    smmu_evtq_drain();
+    *status = smmu_cb_fault[cb].type;
+    *address = smmu_cb_fault[cb].address;
+}
+
+void smmu_cb_clear_fault_state(int cb)
+{
+    smmu_cb_fault[cb].type = 0;
+}
+
+#endif /* CONFIG_ARM_SMMU */
@@ -12,6 +12,89 @@
 #endif
 #include <benchmark/benchmark_utilisation.h>
 
+#ifdef CONFIG_FASTPATH_CROSS_CORE
+/* The IPC has been delivered to a thread with affinity to another core. Make it
+ * runnable on its own core and pick the next thread to run here, as the current
+ * thread has just blocked. Any reschedule IPI that is needed is sent once,
+ * after the local scheduling decision has been made. */
+static inline void NORETURN fastpath_wake_remote(tcb_t *thread)
+{
+    SCHED_ENQUEUE(thread);
+
+    /* Multiple domains are not supported on SMP, so there is no domain
+     * switch to consider here. */
+    chooseThread();
+    doMaskReschedule(ARCH_NODE_STATE(ipiReschedulePending));
+    ARCH_NODE_STATE(ipiReschedulePending) = 0;
+
+    activateThread();
+    restore_user_context();
+    UNREACHABLE();
+}
+#endif /* CONFIG_FASTPATH_CROSS_CORE */
+
+#ifdef CONFIG_ARM_VCPU_INJECT_FASTPATH
+/* Inject IRQs into a VCPU for a Call on a VCPU cap. The IRQs are all in message
+ * registers held in CPU registers, and the reply is empty. */
+static inline FORCE_INLINE void NORETURN fastpath_vcpu_inject_irq(cap_t cap, word_t msgInfo)
+{
+    tcb_t *thread = NODE_STATE(ksCurThread);
+    vcpu_t *vcpu = VCPU_PTR(cap_vcpu_cap_get_capVCPUPtr(cap));
+    seL4_MessageInfo_t info = messageInfoFromWord_raw(msgInfo);
+    word_t length = seL4_MessageInfo_get_length(info);
+    word_t mrs[VCPU_INJECT_IRQS_MAX];
+    word_t indexes[VCPU_INJECT_IRQS_MAX];
+    virq_t virqs[VCPU_INJECT_IRQS_MAX];
+    word_t count;
+    word_t i;
+
+#ifdef CONFIG_FINE_GRAINED_LOCKING
+    /* The VCPU may be modified concurrently by other cores holding the
+     * kernel lock in shared mode */
+    if (unlikely(clh_is_self_shared())) {
+        FASTPATH_EXIT(VCPU_INJECT);
+        slowpath(SysCall);
+    }
+#endif
+
+    switch (seL4_MessageInfo_get_label(info)) {
+    case ARMVCPUInjectIRQ:
+        if (unlikely(length < 1)) {
+            FASTPATH_EXIT(VCPU_INJECT);
+            slowpath(SysCall);
+        }
+        count = 1;
+        mrs[0] = getRegister(thread, msgRegisters[0]);
+        break;
+
+    case ARMVCPUInjectIRQs:
+        count = getRegister(thread, msgRegisters[0]);
+        if (unlikely(count < 1 || count > VCPU_INJECT_IRQS_MAX || length < 1 + count)) {
+            FASTPATH_EXIT(VCPU_INJECT);
+            slowpath(SysCall);
+        }
+        for (i = 0; i < count; i++) {
+            mrs[i] = getRegister(thread, msgRegisters[1 + i]);
+        }
+        break;
+
+    default:
+        FASTPATH_EXIT(VCPU_INJECT);
+        slowpath(SysCall);
+    }
+
+    /* Invalid IRQs are left to the slowpath to report */
+    if (unlikely(vcpu_decode_virqs(vcpu, count, mrs, indexes, virqs) != count)) {
+        FASTPATH_EXIT(VCPU_INJECT);
+        slowpath(SysCall);
+    }
+
+    invokeVCPUInjectIRQs(vcpu, count, indexes, virqs);
+
+    fastpath_restore(0, wordFromMessageInfo(seL4_MessageInfo_new(0, 0, 0, 0)), thread);
+}
+#endif /* CONFIG_ARM_VCPU_INJECT_FASTPATH */
+
 #ifdef CONFIG_ARCH_ARM
 static inline
 FORCE_INLINE
@@ -29,6 +112,9 @@ void NORETURN fastpath_call(word_t cptr, word_t msgInfo)
     pde_t stored_hw_asid;
     word_t fault_type;
     dom_t dom;
+#ifdef CONFIG_FASTPATH_CROSS_CORE
+    bool_t crossnode;
+#endif
 
     /* Get message info, length, and fault type. */
     info = messageInfoFromWord_raw(msgInfo);
@@ -39,6 +125,7 @@ void NORETURN fastpath_call(word_t cptr, word_t msgInfo)
      * saved fault. */
     if (unlikely(fastpath_mi_check(msgInfo) ||
                  fault_type != seL4_Fault_NullFault)) {
+        FASTPATH_EXIT_EITHER(fault_type != seL4_Fault_NullFault, SAVED_FAULT, MESSAGE_INFO);
         slowpath(SysCall);
     }
 
@@ -48,24 +135,38 @@ void NORETURN fastpath_call(word_t cptr, word_t msgInfo)
     /* Check it's an endpoint */
     if (unlikely(!cap_capType_equals(ep_cap, cap_endpoint_cap) ||
                  !cap_endpoint_cap_get_capCanSend(ep_cap))) {
+#ifdef CONFIG_ARM_VCPU_INJECT_FASTPATH
+        if (cap_capType_equals(ep_cap, cap_vcpu_cap)) {
+            fastpath_vcpu_inject_irq(ep_cap, msgInfo);
+        }
+#endif
+        FASTPATH_EXIT_CAP(ep_cap);
         slowpath(SysCall);
     }
 
     /* Get the endpoint address */
     ep_ptr = EP_PTR(cap_endpoint_cap_get_capEPPtr(ep_cap));
 
+#ifdef CONFIG_FINE_GRAINED_LOCKING
+    /* The endpoint queue and the threads on it may be modified concurrently
+     * by other cores holding the kernel lock in shared mode. */
+    NODE_LOCK_OBJECT(ep_ptr);
+#endif
+
     /* Get the destination thread, which is only going to be valid
      * if the endpoint is valid. */
     dest = TCB_PTR(endpoint_ptr_get_epQueue_head(ep_ptr));
 
     /* Check that there's a thread waiting to receive */
     if (unlikely(endpoint_ptr_get_state(ep_ptr) != EPState_Recv)) {
+        FASTPATH_EXIT(ENDPOINT_STATE);
         slowpath(SysCall);
     }
 
     /* ensure we are not single stepping the destination in ia32 */
 #if defined(CONFIG_HARDWARE_DEBUG_API) && defined(CONFIG_ARCH_IA32)
     if (unlikely(dest->tcbArch.tcbContext.breakpointState.single_step_enabled)) {
+        FASTPATH_EXIT(SINGLE_STEP);
         slowpath(SysCall);
     }
 #endif
@@ -78,6 +179,7 @@ void NORETURN fastpath_call(word_t cptr, word_t msgInfo)
 
     /* Ensure that the destination has a valid VTable. */
     if (unlikely(! isValidVTableRoot_fp(newVTable))) {
+        FASTPATH_EXIT(VTABLE);
         slowpath(SysCall);
     }
 
@@ -101,11 +203,13 @@ void NORETURN fastpath_call(word_t cptr, word_t msgInfo)
     asid_map_t asid_map = findMapForASID(asid);
     if (unlikely(asid_map_get_type(asid_map) != asid_map_asid_map_vspace ||
                  VSPACE_PTR(asid_map_asid_map_vspace_get_vspace_root(asid_map)) != cap_pd)) {
+        FASTPATH_EXIT(VTABLE);
         slowpath(SysCall);
     }
 #ifdef CONFIG_ARM_HYPERVISOR_SUPPORT
     /* Ensure the vmid is valid. */
     if (unlikely(!asid_map_asid_map_vspace_get_stored_vmid_valid(asid_map))) {
+        FASTPATH_EXIT(VTABLE);
         slowpath(SysCall);
     }
     /* vmids are the tags used instead of hw_asids in hyp mode */
@@ -122,44 +226,70 @@ void NORETURN fastpath_call(word_t cptr, word_t msgInfo)
 
     /* let gcc optimise this out for 1 domain */
     dom = maxDom ? ksCurDomain : 0;
+#ifdef CONFIG_FASTPATH_CROSS_CORE
+    /* A destination with affinity to another core is not switched to here,
+     * so the local scheduler state does not matter for it. */
+    crossnode = dest->tcbAffinity != getCurrentCPUIndex();
+    if (unlikely(!crossnode && dest->tcbPriority < NODE_STATE(ksCurThread->tcbPriority) &&
+                 !isHighestPrio(dom, dest->tcbPriority))) {
+        FASTPATH_EXIT(PRIORITY);
+        slowpath(SysCall);
+    }
+#else
     /* ensure only the idle thread or lower prio threads are present in the scheduler */
     if (unlikely(dest->tcbPriority < NODE_STATE(ksCurThread->tcbPriority) &&
                  !isHighestPrio(dom, dest->tcbPriority))) {
+        FASTPATH_EXIT(PRIORITY);
         slowpath(SysCall);
     }
+#endif
 
     /* Ensure that the endpoint has has grant or grant-reply rights so that we can
      * create the reply cap */
     if (unlikely(!cap_endpoint_cap_get_capCanGrant(ep_cap) &&
                  !cap_endpoint_cap_get_capCanGrantReply(ep_cap))) {
+        FASTPATH_EXIT(CAP_TYPE);
         slowpath(SysCall);
     }
 
 #ifdef CONFIG_ARCH_AARCH32
     if (unlikely(!pde_pde_invalid_get_stored_asid_valid(stored_hw_asid))) {
+        FASTPATH_EXIT(VTABLE);
         slowpath(SysCall);
     }
 #endif
 
     /* Ensure the original caller is in the current domain and can be scheduled directly. */
     if (unlikely(dest->tcbDomain != ksCurDomain && 0 < maxDom)) {
+        FASTPATH_EXIT(DOMAIN);
         slowpath(SysCall);
     }
 
 #ifdef CONFIG_KERNEL_MCS
     if (unlikely(dest->tcbSchedContext != NULL)) {
+        FASTPATH_EXIT(SCHED_CONTEXT);
         slowpath(SysCall);
     }
 
     reply_t *reply = thread_state_get_replyObject_np(dest->tcbState);
     if (unlikely(reply == NULL)) {
+        FASTPATH_EXIT(REPLY);
         slowpath(SysCall);
     }
 #endif
 
-#ifdef ENABLE_SMP_SUPPORT
+#ifdef CONFIG_FASTPATH_CROSS_CORE
+#ifdef CONFIG_FINE_GRAINED_LOCKING
+    /* Other cores' ready queues may only be modified under the exclusive lock */
+    if (unlikely(crossnode && clh_is_self_shared())) {
+        FASTPATH_EXIT(AFFINITY);
+        slowpath(SysCall);
+    }
+#endif
+#elif defined(ENABLE_SMP_SUPPORT)
     /* Ensure both threads have the same affinity */
     if (unlikely(NODE_STATE(ksCurThread)->tcbAffinity != dest->tcbAffinity)) {
+        FASTPATH_EXIT(AFFINITY);
         slowpath(SysCall);
     }
 #endif /* ENABLE_SMP_SUPPORT */
@@ -175,6 +305,9 @@ void NORETURN fastpath_call(word_t cptr, word_t msgInfo)
 #endif
 
     /* Dequeue the destination. */
+#ifdef CONFIG_IPC_QUEUE_PRIORITY_RUNS
+    tcbEPRunRemove(dest);
+#endif
     endpoint_ptr_set_epQueue_head_np(ep_ptr, TCB_REF(dest->tcbEPNext));
     if (unlikely(dest->tcbEPNext)) {
         dest->tcbEPNext->tcbEPPrev = NULL;
@@ -220,8 +353,23 @@ void NORETURN fastpath_call(word_t cptr, word_t msgInfo)
         &replySlot->cteMDBNode, CTE_REF(callerSlot), 1, 1);
 #endif
 
+#ifdef CONFIG_FINE_GRAINED_LOCKING
+    /* dest is no longer reachable through the endpoint */
+    NODE_UNLOCK_OBJECT;
+#endif
+
     fastpath_copy_mrs(length, NODE_STATE(ksCurThread), dest);
 
+#ifdef CONFIG_FASTPATH_CROSS_CORE
+    if (unlikely(crossnode)) {
+        setRegister(dest, badgeRegister, badge);
+        setRegister(dest, msgInfoRegister,
+                    wordFromMessageInfo(seL4_MessageInfo_set_capsUnwrapped(info, 0)));
+        thread_state_ptr_set_tsType_np(&dest->tcbState, ThreadState_Running);
+        fastpath_wake_remote(dest);
+    }
+#endif
+
     /* Dest thread is set Running, but not queued. */
     thread_state_ptr_set_tsType_np(&dest->tcbState,
                                    ThreadState_Running);
@@ -255,6 +403,9 @@ void NORETURN fastpath_reply_recv(word_t cptr, word_t msgInfo)
     vspace_root_t *cap_pd;
     pde_t stored_hw_asid;
     dom_t dom;
+#ifdef CONFIG_FASTPATH_CROSS_CORE
+    bool_t crossnode;
+#endif
 
     /* Get message info and length */
     info = messageInfoFromWord_raw(msgInfo);
@@ -265,6 +416,7 @@ void NORETURN fastpath_reply_recv(word_t cptr, word_t msgInfo)
      * saved fault. */
     if (unlikely(fastpath_mi_check(msgInfo) ||
                  fault_type != seL4_Fault_NullFault)) {
+        FASTPATH_EXIT_EITHER(fault_type != seL4_Fault_NullFault, SAVED_FAULT, MESSAGE_INFO);
         slowpath(SysReplyRecv);
     }
 
@@ -275,6 +427,7 @@ void NORETURN fastpath_reply_recv(word_t cptr, word_t msgInfo)
     /* Check it's an endpoint */
     if (unlikely(!cap_capType_equals(ep_cap, cap_endpoint_cap) ||
                  !cap_endpoint_cap_get_capCanReceive(ep_cap))) {
+        FASTPATH_EXIT_CAP(ep_cap);
         slowpath(SysReplyRecv);
     }
 
@@ -284,6 +437,7 @@ void NORETURN fastpath_reply_recv(word_t cptr, word_t msgInfo)
 
     /* check it's a reply object */
     if (unlikely(!cap_capType_equals(reply_cap, cap_reply_cap))) {
+        FASTPATH_EXIT_CAP(reply_cap);
         slowpath(SysReplyRecv);
     }
 #endif
@@ -291,14 +445,21 @@ void NORETURN fastpath_reply_recv(word_t cptr, word_t msgInfo)
     /* Check there is nothing waiting on the notification */
     if (unlikely(NODE_STATE(ksCurThread)->tcbBoundNotification &&
                  notification_ptr_get_state(NODE_STATE(ksCurThread)->tcbBoundNotification) == NtfnState_Active)) {
+        FASTPATH_EXIT(BOUND_NOTIFICATION);
         slowpath(SysReplyRecv);
     }
 
     /* Get the endpoint address */
     ep_ptr = EP_PTR(cap_endpoint_cap_get_capEPPtr(ep_cap));
 
+#ifdef CONFIG_FINE_GRAINED_LOCKING
+    /* Hold the endpoint until the current thread is queued on it */
+    NODE_LOCK_OBJECT(ep_ptr);
+#endif
+
     /* Check that there's not a thread waiting to send */
     if (unlikely(endpoint_ptr_get_state(ep_ptr) == EPState_Send)) {
+        FASTPATH_EXIT(ENDPOINT_STATE);
         slowpath(SysReplyRecv);
     }
 
@@ -310,6 +471,7 @@ void NORETURN fastpath_reply_recv(word_t cptr, word_t msgInfo)
     if (unlikely(reply_ptr->replyTCB == NULL ||
                  call_stack_get_isHead(reply_ptr->replyNext) == 0 ||
                  SC_PTR(call_stack_get_callStackPtr(reply_ptr->replyNext)) != NODE_STATE(ksCurThread)->tcbSchedContext)) {
+        FASTPATH_EXIT(REPLY);
         slowpath(SysReplyRecv);
     }
 
@@ -320,6 +482,7 @@ void NORETURN fastpath_reply_recv(word_t cptr, word_t msgInfo)
     cte_t *callerSlot = TCB_PTR_CTE_PTR(NODE_STATE(ksCurThread), tcbCaller);
     cap_t callerCap = callerSlot->cap;
     if (unlikely(!fastpath_reply_cap_check(callerCap))) {
+        FASTPATH_EXIT(REPLY);
         slowpath(SysReplyRecv);
     }
 
@@ -330,6 +493,7 @@ void NORETURN fastpath_reply_recv(word_t cptr, word_t msgInfo)
     /* ensure we are not single stepping the caller in ia32 */
 #if defined(CONFIG_HARDWARE_DEBUG_API) && defined(CONFIG_ARCH_IA32)
     if (unlikely(caller->tcbArch.tcbContext.breakpointState.single_step_enabled)) {
+        FASTPATH_EXIT(SINGLE_STEP);
         slowpath(SysReplyRecv);
     }
 #endif
@@ -341,10 +505,12 @@ void NORETURN fastpath_reply_recv(word_t cptr, word_t msgInfo)
     /* Change this as more types of faults are supported */
 #ifndef CONFIG_EXCEPTION_FASTPATH
     if (unlikely(fault_type != seL4_Fault_NullFault)) {
+        FASTPATH_EXIT(CALLER_FAULT);
         slowpath(SysReplyRecv);
     }
 #else
     if (unlikely(fault_type != seL4_Fault_NullFault && fault_type != seL4_Fault_VMFault)) {
+        FASTPATH_EXIT(CALLER_FAULT);
         slowpath(SysReplyRecv);
     }
 #endif
@@ -357,6 +523,7 @@ void NORETURN fastpath_reply_recv(word_t cptr, word_t msgInfo)
 
     /* Ensure that the destination has a valid MMU. */
     if (unlikely(! isValidVTableRoot_fp(newVTable))) {
+        FASTPATH_EXIT(VTABLE);
         slowpath(SysReplyRecv);
     }
 
@@ -378,11 +545,13 @@ void NORETURN fastpath_reply_recv(word_t cptr, word_t msgInfo)
     asid_map_t asid_map = findMapForASID(asid);
     if (unlikely(asid_map_get_type(asid_map) != asid_map_asid_map_vspace ||
                  VSPACE_PTR(asid_map_asid_map_vspace_get_vspace_root(asid_map)) != cap_pd)) {
+        FASTPATH_EXIT(VTABLE);
         slowpath(SysReplyRecv);
     }
 #ifdef CONFIG_ARM_HYPERVISOR_SUPPORT
     /* Ensure the vmid is valid. */
     if (unlikely(!asid_map_asid_map_vspace_get_stored_vmid_valid(asid_map))) {
+        FASTPATH_EXIT(VTABLE);
         slowpath(SysReplyRecv);
     }
 
@@ -399,31 +568,52 @@ void NORETURN fastpath_reply_recv(word_t cptr, word_t msgInfo)
 
     /* Ensure the original caller can be scheduled directly. */
     dom = maxDom ? ksCurDomain : 0;
+#ifdef CONFIG_FASTPATH_CROSS_CORE
+    crossnode = caller->tcbAffinity != getCurrentCPUIndex();
+    if (unlikely(!crossnode && !isHighestPrio(dom, caller->tcbPriority))) {
+        FASTPATH_EXIT(PRIORITY);
+        slowpath(SysReplyRecv);
+    }
+#else
     if (unlikely(!isHighestPrio(dom, caller->tcbPriority))) {
+        FASTPATH_EXIT(PRIORITY);
         slowpath(SysReplyRecv);
     }
+#endif
 
 #ifdef CONFIG_ARCH_AARCH32
     /* Ensure the HWASID is valid. */
     if (unlikely(!pde_pde_invalid_get_stored_asid_valid(stored_hw_asid))) {
+        FASTPATH_EXIT(VTABLE);
         slowpath(SysReplyRecv);
     }
 #endif
 
     /* Ensure the original caller is in the current domain and can be scheduled directly. */
     if (unlikely(caller->tcbDomain != ksCurDomain && 0 < maxDom)) {
+        FASTPATH_EXIT(DOMAIN);
         slowpath(SysReplyRecv);
     }
 
 #ifdef CONFIG_KERNEL_MCS
     if (unlikely(caller->tcbSchedContext != NULL)) {
+        FASTPATH_EXIT(SCHED_CONTEXT);
         slowpath(SysReplyRecv);
     }
 #endif
 
-#ifdef ENABLE_SMP_SUPPORT
+#ifdef CONFIG_FASTPATH_CROSS_CORE
+#ifdef CONFIG_FINE_GRAINED_LOCKING
+    /* Other cores' ready queues may only be modified under the exclusive lock */
+    if (unlikely(crossnode && clh_is_self_shared())) {
+        FASTPATH_EXIT(AFFINITY);
+        slowpath(SysReplyRecv);
+    }
+#endif
+#elif defined(ENABLE_SMP_SUPPORT)
     /* Ensure both threads have the same affinity */
     if (unlikely(NODE_STATE(ksCurThread)->tcbAffinity != caller->tcbAffinity)) {
+        FASTPATH_EXIT(AFFINITY);
         slowpath(SysReplyRecv);
     }
 #endif /* ENABLE_SMP_SUPPORT */
@@ -457,6 +647,9 @@ void NORETURN fastpath_reply_recv(word_t cptr, word_t msgInfo)
     if (likely(!endpointTail)) {
         NODE_STATE(ksCurThread)->tcbEPPrev = NULL;
         NODE_STATE(ksCurThread)->tcbEPNext = NULL;
+#ifdef CONFIG_IPC_QUEUE_PRIORITY_RUNS
+        NODE_STATE(ksCurThread)->tcbEPRun = NODE_STATE(ksCurThread);
+#endif
 
         /* Set head/tail of queue and endpoint state. */
         endpoint_ptr_set_epQueue_head_np(ep_ptr, TCB_REF(NODE_STATE(ksCurThread)));
@@ -480,6 +673,10 @@ void NORETURN fastpath_reply_recv(word_t cptr, word_t msgInfo)
 #endif
     }
 
+#ifdef CONFIG_FINE_GRAINED_LOCKING
+    NODE_UNLOCK_OBJECT;
+#endif
+
 #ifdef CONFIG_KERNEL_MCS
     /* update call stack */
     word_t prev_ptr = call_stack_get_callStackPtr(reply_ptr->replyPrev);
@@ -524,6 +721,11 @@ void NORETURN fastpath_reply_recv(word_t cptr, word_t msgInfo)
 
         /* Dest thread is set Running, but not queued. */
         thread_state_ptr_set_tsType_np(&caller->tcbState, ThreadState_Running);
+#ifdef CONFIG_FASTPATH_CROSS_CORE
+        if (unlikely(crossnode)) {
+            fastpath_wake_remote(caller);
+        }
+#endif
         switchToThread_fp(caller, cap_pd, stored_hw_asid);
 
         /* The badge/msginfo do not need to be not sent - this is not necessary for exceptions */
@@ -539,6 +741,14 @@ void NORETURN fastpath_reply_recv(word_t cptr, word_t msgInfo)
 
         /* Dest thread is set Running, but not queued. */
         thread_state_ptr_set_tsType_np(&caller->tcbState, ThreadState_Running);
+#ifdef CONFIG_FASTPATH_CROSS_CORE
+        if (unlikely(crossnode)) {
+            setRegister(caller, badgeRegister, badge);
+            setRegister(caller, msgInfoRegister,
+                        wordFromMessageInfo(seL4_MessageInfo_set_capsUnwrapped(info, 0)));
+            fastpath_wake_remote(caller);
+        }
+#endif
         switchToThread_fp(caller, cap_pd, stored_hw_asid);
 
         msgInfo = wordFromMessageInfo(seL4_MessageInfo_set_capsUnwrapped(info, 0));
@@ -570,6 +780,7 @@ void NORETURN fastpath_signal(word_t cptr, word_t msgInfo)
     /* Check there's no saved fault. Can be removed if the current thread can't
      * have a fault while invoking the fastpath */
     if (unlikely(fault_type != seL4_Fault_NullFault)) {
+        FASTPATH_EXIT(SAVED_FAULT);
         slowpath(SysSend);
     }
 
@@ -578,16 +789,19 @@ void NORETURN fastpath_signal(word_t cptr, word_t msgInfo)
 
     /* Check it's a notification */
     if (unlikely(!cap_capType_equals(cap, cap_notification_cap))) {
+        FASTPATH_EXIT_CAP(cap);
         slowpath(SysSend);
     }
 
     /* Check that we are allowed to send to this cap */
     if (unlikely(!cap_notification_cap_get_capNtfnCanSend(cap))) {
+        FASTPATH_EXIT(CAP_TYPE);
         slowpath(SysSend);
     }
 
     /* Check that the current domain hasn't expired */
     if (unlikely(isCurDomainExpired())) {
+        FASTPATH_EXIT(DOMAIN);
         slowpath(SysSend);
     }
 
@@ -636,12 +850,14 @@ void NORETURN fastpath_signal(word_t cptr, word_t msgInfo)
     if (!sc) {
         sc = SC_PTR(notification_ptr_get_ntfnSchedContext(ntfnPtr));
         if (sc == NULL || sc->scTcb != NULL) {
+            FASTPATH_EXIT(SCHED_CONTEXT);
             slowpath(SysSend);
         }
 
         /* Slowpath the case where dest has its FPU context in the FPU of a core*/
 #if defined(ENABLE_SMP_SUPPORT) && defined(CONFIG_HAVE_FPU)
         if (nativeThreadUsingFPU(dest)) {
+            FASTPATH_EXIT(FPU);
             slowpath(SysSend);
         }
 #endif
@@ -650,6 +866,7 @@ void NORETURN fastpath_signal(word_t cptr, word_t msgInfo)
     /* Only fastpath signal to threads which will not become the new highest prio thread on the
      * core of their SC, even if the currently running thread on the core is the idle thread. */
     if (NODE_STATE_ON_CORE(ksCurThread, sc->scCore)->tcbPriority < dest->tcbPriority) {
+        FASTPATH_EXIT(PRIORITY);
         slowpath(SysSend);
     }
 
@@ -660,6 +877,7 @@ void NORETURN fastpath_signal(word_t cptr, word_t msgInfo)
      * that will affect the conditions of this check */
     if (sc->scRefillMax > 0) {
         if (!(refill_ready(sc) && refill_sufficient(sc, 0))) {
+            FASTPATH_EXIT(SCHED_CONTEXT);
             slowpath(SysSend);
         }
         schedulable = true;
@@ -746,6 +964,7 @@ void NORETURN fastpath_vm_fault(vm_fault_type_t type)
                                                                       !cap_endpoint_cap_get_capCanGrantReply(handler_cap))
 #endif
                 )) {
+        FASTPATH_EXIT_CAP(handler_cap);
         vm_fault_slowpath(type);
     }
 
@@ -758,6 +977,7 @@ void NORETURN fastpath_vm_fault(vm_fault_type_t type)
 
     /* Check that there's a thread waiting to receive */
     if (unlikely(endpoint_ptr_get_state(ep_ptr) != EPState_Recv)) {
+        FASTPATH_EXIT(ENDPOINT_STATE);
         vm_fault_slowpath(type);
     }
 
@@ -769,6 +989,7 @@ void NORETURN fastpath_vm_fault(vm_fault_type_t type)
 
     /* Ensure that the destination has a valid VTable. */
     if (unlikely(! isValidVTableRoot_fp(newVTable))) {
+        FASTPATH_EXIT(VTABLE);
         vm_fault_slowpath(type);
     }
 
@@ -778,11 +999,13 @@ void NORETURN fastpath_vm_fault(vm_fault_type_t type)
     asid_map_t asid_map = findMapForASID(asid);
     if (unlikely(asid_map_get_type(asid_map) != asid_map_asid_map_vspace ||
                  VSPACE_PTR(asid_map_asid_map_vspace_get_vspace_root(asid_map)) != cap_pd)) {
+        FASTPATH_EXIT(VTABLE);
         vm_fault_slowpath(type);
     }
 #ifdef CONFIG_ARM_HYPERVISOR_SUPPORT
     /* Ensure the vmid is valid. */
     if (unlikely(!asid_map_asid_map_vspace_get_stored_vmid_valid(asid_map))) {
+        FASTPATH_EXIT(VTABLE);
         vm_fault_slowpath(type);
     }
 
@@ -798,22 +1021,25 @@ void NORETURN fastpath_vm_fault(vm_fault_type_t type)
     /* ensure only the idle thread or lower prio threads are present in the scheduler */
     if (unlikely(dest->tcbPriority < NODE_STATE(ksCurThread->tcbPriority) &&
                  !isHighestPrio(dom, dest->tcbPriority))) {
-
+        FASTPATH_EXIT(PRIORITY);
         vm_fault_slowpath(type);
     }
 
     /* Ensure the original caller is in the current domain and can be scheduled directly. */
     if (unlikely(dest->tcbDomain != ksCurDomain && 0 < maxDom)) {
+        FASTPATH_EXIT(DOMAIN);
         vm_fault_slowpath(type);
     }
 
 #ifdef CONFIG_KERNEL_MCS
     if (unlikely(dest->tcbSchedContext != NULL)) {
+        FASTPATH_EXIT(SCHED_CONTEXT);
         vm_fault_slowpath(type);
     }
 
     reply_t *reply = thread_state_get_replyObject_np(dest->tcbState);
     if (unlikely(reply == NULL)) {
+        FASTPATH_EXIT(REPLY);
         vm_fault_slowpath(type);
     }
 #endif
@@ -821,6 +1047,7 @@ void NORETURN fastpath_vm_fault(vm_fault_type_t type)
 #ifdef ENABLE_SMP_SUPPORT
     /* Ensure both threads have the same affinity */
     if (unlikely(NODE_STATE(ksCurThread)->tcbAffinity != dest->tcbAffinity)) {
+        FASTPATH_EXIT(AFFINITY);
         vm_fault_slowpath(type);
     }
 #endif /* ENABLE_SMP_SUPPORT */
@@ -841,6 +1068,9 @@ void NORETURN fastpath_vm_fault(vm_fault_type_t type)
 #endif
 
     /* Dequeue the destination. */
+#ifdef CONFIG_IPC_QUEUE_PRIORITY_RUNS
+    tcbEPRunRemove(dest);
+#endif
     endpoint_ptr_set_epQueue_head_np(ep_ptr, TCB_REF(dest->tcbEPNext));
     if (unlikely(dest->tcbEPNext)) {
         dest->tcbEPNext->tcbEPPrev = NULL;
@@ -11,6 +11,7 @@
 #include <kernel/cspace.h>
 #include <model/statedata.h>
 #include <arch/machine.h>
+#include <util.h>
 
 lookupCap_ret_t lookupCap(tcb_t *thread, cptr_t cPtr)
 {
@@ -48,6 +49,20 @@ lookupCapAndSlot_ret_t lookupCapAndSlot(tcb_t *thread, cptr_t cPtr)
     return ret;
 }
 
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+void capLookupCacheFlush(void)
+{
+    ksCapLookupEpoch++;
+    if (unlikely(ksCapLookupEpoch == 0)) {
+        /* Entries from before the wrap around would be valid again */
+        for (word_t i = 0; i < CONFIG_MAX_NUM_NODES; i++) {
+            memzero(NODE_STATE_ON_CORE(ksCapLookupCache, i), sizeof(NODE_STATE_ON_CORE(ksCapLookupCache, i)));
+        }
+        ksCapLookupEpoch = 1;
+    }
+}
+#endif /* CONFIG_CAP_LOOKUP_CACHE */
+
 lookupSlot_raw_ret_t lookupSlot(tcb_t *thread, cptr_t capptr)
 {
     cap_t threadRoot;
@@ -55,7 +70,30 @@ lookupSlot_raw_ret_t lookupSlot(tcb_t *thread, cptr_t capptr)
     lookupSlot_raw_ret_t ret;
 
     threadRoot = TCB_PTR_CTE_PTR(thread, tcbCTable)->cap;
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+    cap_lookup_cache_entry_t *entry = capLookupCacheEntry(capptr);
+
+    if (capLookupCacheHit(entry, threadRoot, capptr)) {
+#ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
+        NODE_STATE(benchmark_cap_lookup_cache_hits)++;
+#endif
+        ret.status = EXCEPTION_NONE;
+        ret.slot = entry->slot;
+        return ret;
+    }
+#ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
+    NODE_STATE(benchmark_cap_lookup_cache_misses)++;
+#endif
+#endif /* CONFIG_CAP_LOOKUP_CACHE */
     res_ret = resolveAddressBits(threadRoot, capptr, wordBits);
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+    if (res_ret.status == EXCEPTION_NONE) {
+        entry->root = threadRoot;
+        entry->cptr = capptr;
+        entry->slot = res_ret.slot;
+        entry->epoch = ksCapLookupEpoch;
+    }
+#endif
 
     ret.status = res_ret.status;
     ret.slot = res_ret.slot;
@@ -123,6 +161,58 @@ lookupSlot_ret_t lookupPivotSlot(cap_t root, cptr_t capptr, word_t depth)
     return lookupSlotForCNodeOp(true, root, capptr, depth);
 }
 
+#ifdef CONFIG_FRAME_RANGE_INVOCATIONS
+lookupSlot_ret_t lookupSourceWindow(cap_t root, cptr_t capptr, word_t depth,
+                                    word_t offset, word_t window, word_t maxWindow)
+{
+    lookupSlot_ret_t ret;
+    cap_t nodeCap;
+    word_t nodeSize;
+
+    ret.slot = NULL;
+
+    /* A depth of zero refers to the root CNode itself. */
+    if (depth == 0) {
+        nodeCap = root;
+    } else {
+        ret = lookupSourceSlot(root, capptr, depth);
+        if (unlikely(ret.status != EXCEPTION_NONE)) {
+            return ret;
+        }
+        nodeCap = ret.slot->cap;
+    }
+
+    if (unlikely(cap_get_capType(nodeCap) != cap_cnode_cap)) {
+        current_syscall_error.type = seL4_FailedLookup;
+        current_syscall_error.failedLookupWasSource = true;
+        current_lookup_fault = lookup_fault_missing_capability_new(depth);
+        ret.status = EXCEPTION_SYSCALL_ERROR;
+        return ret;
+    }
+
+    nodeSize = BIT(cap_cnode_cap_get_capCNodeRadix(nodeCap));
+    if (unlikely(offset > nodeSize - 1)) {
+        current_syscall_error.type = seL4_RangeError;
+        current_syscall_error.rangeErrorMin = 0;
+        current_syscall_error.rangeErrorMax = nodeSize - 1;
+        ret.status = EXCEPTION_SYSCALL_ERROR;
+        return ret;
+    }
+
+    if (unlikely(window < 1 || window > MIN(maxWindow, nodeSize - offset))) {
+        current_syscall_error.type = seL4_RangeError;
+        current_syscall_error.rangeErrorMin = 1;
+        current_syscall_error.rangeErrorMax = MIN(maxWindow, nodeSize - offset);
+        ret.status = EXCEPTION_SYSCALL_ERROR;
+        return ret;
+    }
+
+    ret.slot = CTE_PTR(cap_cnode_cap_get_capCNodePtr(nodeCap)) + offset;
+    ret.status = EXCEPTION_NONE;
+    return ret;
+}
+#endif /* CONFIG_FRAME_RANGE_INVOCATIONS */
+
 resolveAddressBits_ret_t resolveAddressBits(cap_t nodeCap, cptr_t capptr, word_t n_bits)
 {
     resolveAddressBits_ret_t ret;
@@ -61,6 +61,9 @@ void activateThread(void)
     }
 
     case ThreadState_IdleThreadState:
+#ifdef CONFIG_UNTYPED_BACKGROUND_RESET
+        untypedBackgroundReset();
+#endif
         Arch_activateIdleThread(NODE_STATE(ksCurThread));
         break;
 
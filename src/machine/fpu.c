@@ -15,7 +15,11 @@
 void switchLocalFpuOwner(tcb_t *new_owner)
 {
     enableFpu();
+#ifdef CONFIG_FPU_LAZY_SWITCH
+    if (NODE_STATE(ksCurFPUOwner) && isFpuStateDirty(NODE_STATE(ksCurFPUOwner))) {
+#else
     if (NODE_STATE(ksCurFPUOwner)) {
+#endif
         saveFpuState(NODE_STATE(ksCurFPUOwner));
     }
     if (new_owner) {
@@ -38,6 +42,23 @@ void switchFpuOwner(tcb_t *new_owner, word_t cpu)
     }
 }
 
+#ifdef CONFIG_FPU_LAZY_SWITCH
+bool_t handleLazyFPUFault(void)
+{
+    tcb_t *thread = NODE_STATE(ksCurThread);
+
+    if ((thread->tcbFlags & seL4_TCBFlag_fpuDisabled) || nativeThreadUsingFPU(thread)) {
+        return false;
+    }
+
+    switchLocalFpuOwner(thread);
+#ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
+    NODE_STATE(benchmark_fpu_restores)++;
+#endif
+    return true;
+}
+#endif /* CONFIG_FPU_LAZY_SWITCH */
+
 /* Prepare for the deletion of the given thread. */
 void fpuRelease(tcb_t *thread)
 {
@@ -26,8 +26,20 @@ exception_t preemptionPoint(void)
      * We avoid checking for pending IRQs every call, as our callers tend to
      * call us in a tight loop and checking for pending IRQs can be quite slow.
      */
+#ifdef CONFIG_PREEMPTION_TIME_BUDGET
+    /* Work units differ widely in cost, so instead measure the time since
+     * kernel entry or the last check, both of which update ksCurTime. Reading
+     * the timer is cheap compared to checking for pending IRQs. */
+    ticks_t section = getCurrentTime() - NODE_STATE(ksCurTime);
+    if (section >= usToTicks(CONFIG_PREEMPTION_TIME_BUDGET_US)) {
+#else
     if (ksWorkUnitsCompleted >= CONFIG_MAX_NUM_WORK_UNITS_PER_PREEMPTION) {
+#endif
         ksWorkUnitsCompleted = 0;
+#if defined(CONFIG_PREEMPTION_TIME_BUDGET) && defined(CONFIG_BENCHMARK_TRACK_UTILISATION)
+        NODE_STATE(benchmark_max_nonpreemptible_time) =
+            MAX(NODE_STATE(benchmark_max_nonpreemptible_time), section);
+#endif
 #ifdef CONFIG_KERNEL_MCS
         updateTimestamp();
         if (isIRQPending() || isCurDomainExpired()
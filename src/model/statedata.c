@@ -68,7 +68,33 @@ UP_STATE_DEFINE(timestamp_t, benchmark_end_time);
 UP_STATE_DEFINE(timestamp_t, benchmark_kernel_time);
 UP_STATE_DEFINE(timestamp_t, benchmark_kernel_number_entries);
 UP_STATE_DEFINE(timestamp_t, benchmark_kernel_number_schedules);
+#ifdef CONFIG_PREEMPTION_TIME_BUDGET
+UP_STATE_DEFINE(ticks_t, benchmark_max_nonpreemptible_time);
+#endif /* CONFIG_PREEMPTION_TIME_BUDGET */
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+UP_STATE_DEFINE(word_t, benchmark_cap_lookup_cache_hits);
+UP_STATE_DEFINE(word_t, benchmark_cap_lookup_cache_misses);
+#endif /* CONFIG_CAP_LOOKUP_CACHE */
+#ifdef CONFIG_FPU_LAZY_SWITCH
+UP_STATE_DEFINE(word_t, benchmark_fpu_switches_deferred);
+UP_STATE_DEFINE(word_t, benchmark_fpu_restores);
+#endif /* CONFIG_FPU_LAZY_SWITCH */
 #endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
+#ifdef CONFIG_BENCHMARK_FASTPATH_EXITS
+UP_STATE_DEFINE(word_t, benchmark_fastpath_exits[BENCHMARK_FASTPATH_NUM_EXITS]);
+#endif
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+UP_STATE_DEFINE(cap_lookup_cache_entry_t, ksCapLookupCache[BIT(CONFIG_CAP_LOOKUP_CACHE_BITS)]);
+#endif
+#ifdef CONFIG_LOG_BUFFER_PER_NODE
+UP_STATE_DEFINE(word_t, ksLogBuffer);
+UP_STATE_DEFINE(word_t, ksLogIndex);
+UP_STATE_DEFINE(word_t, ksLogIndexFinalized);
+#if CONFIG_MAX_NUM_TRACE_POINTS > 0
+UP_STATE_DEFINE(timestamp_t, ksEntries[CONFIG_MAX_NUM_TRACE_POINTS]);
+UP_STATE_DEFINE(bool_t, ksStarted[CONFIG_MAX_NUM_TRACE_POINTS]);
+#endif
+#endif /* CONFIG_LOG_BUFFER_PER_NODE */
 
 /* Units of work we have completed since the last time we checked for
  * pending interrupts */
@@ -101,6 +127,19 @@ SECTION("._idle_thread") char ksIdleThreadTCB[CONFIG_MAX_NUM_NODES][BIT(seL4_TCB
 char ksIdleThreadSC[CONFIG_MAX_NUM_NODES][BIT(seL4_MinSchedContextBits)] ALIGN(BIT(seL4_MinSchedContextBits));
 #endif
 
+#ifdef CONFIG_ENDPOINT_BADGE_INDEX
+badge_index_bucket_t ksBadgeIndex[BIT(BADGE_INDEX_BITS)];
+#endif
+
+#ifdef CONFIG_UNTYPED_BACKGROUND_RESET
+cte_t *ksUntypedResetQueue[UNTYPED_RESET_QUEUE_SIZE];
+#endif
+
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+/* Starts at 1 so that the zeroed cache entries are invalid */
+word_t ksCapLookupEpoch = 1;
+#endif
+
 #if (defined CONFIG_DEBUG_BUILD || defined CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES)
 kernel_entry_t ksKernelEntry;
 #endif /* DEBUG */
@@ -328,7 +328,11 @@ exception_t invokeCNodeCancelBadgedSends(cap_t cap)
     if (badge) {
         endpoint_t *ep = (endpoint_t *)
                          cap_endpoint_cap_get_capEPPtr(cap);
+#ifdef CONFIG_ENDPOINT_BADGE_INDEX
+        return cancelBadgedSends(ep, badge);
+#else
         cancelBadgedSends(ep, badge);
+#endif
     }
     return EXCEPTION_NONE;
 }
@@ -424,6 +428,9 @@ void cteInsert(cap_t newCap, cte_t *srcSlot, cte_t *destSlot)
 
     /* Haskell error: "cteInsert to non-empty destination" */
     assert(cap_get_capType(destSlot->cap) == cap_null_cap);
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+    capLookupCacheSlotChanged(newCap);
+#endif
     /* Haskell error: "cteInsert: mdb entry must be empty" */
     assert((cte_t *)mdb_node_get_mdbNext(destSlot->cteMDBNode) == NULL &&
            (cte_t *)mdb_node_get_mdbPrev(destSlot->cteMDBNode) == NULL);
@@ -453,6 +460,15 @@ void cteMove(cap_t newCap, cte_t *srcSlot, cte_t *destSlot)
     assert((cte_t *)mdb_node_get_mdbNext(destSlot->cteMDBNode) == NULL &&
            (cte_t *)mdb_node_get_mdbPrev(destSlot->cteMDBNode) == NULL);
 
+#ifdef CONFIG_UNTYPED_BACKGROUND_RESET
+    if (cap_get_capType(newCap) == cap_untyped_cap) {
+        untypedResetSwapSlots(srcSlot, destSlot);
+    }
+#endif
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+    capLookupCacheSlotChanged(newCap);
+#endif
+
     mdb = srcSlot->cteMDBNode;
     destSlot->cap = newCap;
     srcSlot->cap = cap_null_cap_new();
@@ -491,6 +507,16 @@ void cteSwap(cap_t cap1, cte_t *slot1, cap_t cap2, cte_t *slot2)
     mdb_node_t mdb1, mdb2;
     word_t next_ptr, prev_ptr;
 
+#ifdef CONFIG_UNTYPED_BACKGROUND_RESET
+    if (cap_get_capType(cap1) == cap_untyped_cap || cap_get_capType(cap2) == cap_untyped_cap) {
+        untypedResetSwapSlots(slot1, slot2);
+    }
+#endif
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+    capLookupCacheSlotChanged(cap1);
+    capLookupCacheSlotChanged(cap2);
+#endif
+
     slot1->cap = cap2;
     slot2->cap = cap1;
 
@@ -525,20 +551,96 @@ void cteSwap(cap_t cap1, cte_t *slot1, cap_t cap2, cte_t *slot2)
             CTE_REF(slot1));
 }
 
+#ifdef CONFIG_FAST_REVOKE
+/* Finalising a capability that is not final and has no architecture specific
+ * state does nothing, so such children can be removed by just unlinking them.
+ * Unlink a run of up to max of them that starts at the first child of slot and
+ * return its length. The MDB links of slot are updated once for the run. */
+static word_t revokeUnlinkChildren(cte_t *slot, word_t max)
+{
+    cte_t *child = CTE_PTR(mdb_node_get_mdbNext(slot->cteMDBNode));
+    word_t count = 0;
+
+    while (count < max && child && isMDBParentOf(slot, child)) {
+        cap_t cap = child->cap;
+        cte_t *next = CTE_PTR(mdb_node_get_mdbNext(child->cteMDBNode));
+
+        if (isArchCap(cap) || cap_get_capType(cap) == cap_untyped_cap ||
+            cap_get_capType(cap) == cap_zombie_cap) {
+            break;
+        }
+        /* As in isFinalCapability(), with the children already unlinked
+         * leaving slot as the previous entry. */
+        if (!sameObjectAs(slot->cap, cap) && !(next && sameObjectAs(cap, next->cap))) {
+            break;
+        }
+
+        /* Propagate firstBadged as emptySlot() does, as the next child
+         * depends on it to decide whether it is still a child of slot. */
+        if (next) {
+            mdb_node_ptr_set_mdbFirstBadged(&next->cteMDBNode,
+                                            mdb_node_get_mdbFirstBadged(next->cteMDBNode) ||
+                                            mdb_node_get_mdbFirstBadged(child->cteMDBNode));
+        }
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+        capLookupCacheSlotChanged(cap);
+#endif
+        child->cap = cap_null_cap_new();
+        child->cteMDBNode = nullMDBNode;
+        child = next;
+        count++;
+    }
+
+    if (count > 0) {
+        mdb_node_ptr_set_mdbNext(&slot->cteMDBNode, CTE_REF(child));
+        if (child) {
+            mdb_node_ptr_set_mdbPrev(&child->cteMDBNode, CTE_REF(slot));
+        }
+    }
+    return count;
+}
+#endif /* CONFIG_FAST_REVOKE */
+
 exception_t cteRevoke(cte_t *slot)
 {
     cte_t *nextPtr;
     exception_t status;
+#ifdef CONFIG_FAST_REVOKE
+    tcb_t *thread = NODE_STATE(ksCurThread);
+    word_t removed;
+
+    /* Progress carries over only to the restart of a preempted revoke */
+    if (thread->tcbRevokeSlot != slot) {
+        thread->tcbRevokeSlot = slot;
+        thread->tcbRevokeProgress = 0;
+    }
+#endif
 
     /* there is no need to check for a NullCap as NullCaps are
        always accompanied by null mdb pointers */
     for (nextPtr = CTE_PTR(mdb_node_get_mdbNext(slot->cteMDBNode));
          nextPtr && isMDBParentOf(slot, nextPtr);
          nextPtr = CTE_PTR(mdb_node_get_mdbNext(slot->cteMDBNode))) {
+#ifdef CONFIG_FAST_REVOKE
+        removed = revokeUnlinkChildren(slot, CONFIG_MAX_NUM_WORK_UNITS_PER_PREEMPTION);
+        if (removed > 0) {
+            /* Check for preemption once per run, but as often as if each
+             * child had been deleted on its own. */
+            ksWorkUnitsCompleted += removed - 1;
+            thread->tcbRevokeProgress += removed;
+        } else {
+            status = cteDelete(nextPtr, true);
+            if (status != EXCEPTION_NONE) {
+                return status;
+            }
+            thread->tcbRevokeProgress++;
+        }
+#else
         status = cteDelete(nextPtr, true);
         if (status != EXCEPTION_NONE) {
             return status;
         }
+#endif
 
         status = preemptionPoint();
         if (status != EXCEPTION_NONE) {
@@ -546,6 +648,10 @@ exception_t cteRevoke(cte_t *slot)
         }
     }
 
+#ifdef CONFIG_FAST_REVOKE
+    thread->tcbRevokeProgress = 0;
+    thread->tcbRevokeSlot = NULL;
+#endif
     return EXCEPTION_NONE;
 }
 
@@ -584,6 +690,14 @@ static void emptySlot(cte_t *slot, cap_t cleanupInfo)
             mdb_node_ptr_set_mdbFirstBadged(&next->cteMDBNode,
                                             mdb_node_get_mdbFirstBadged(next->cteMDBNode) ||
                                             mdb_node_get_mdbFirstBadged(mdbNode));
+#ifdef CONFIG_UNTYPED_BACKGROUND_RESET
+        if (cap_get_capType(slot->cap) == cap_untyped_cap) {
+            untypedResetCancel(slot);
+        }
+#endif
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+        capLookupCacheSlotChanged(slot->cap);
+#endif
         slot->cap = cap_null_cap_new();
         slot->cteMDBNode = nullMDBNode;
 
@@ -630,6 +744,9 @@ static finaliseSlot_ret_t finaliseSlot(cte_t *slot, bool_t immediate)
             return ret;
         }
 
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+        capLookupCacheSlotChanged(slot->cap);
+#endif
         slot->cap = fc_ret.remainder;
 
         if (!immediate && capCyclicZombie(fc_ret.remainder, slot)) {
@@ -747,6 +864,9 @@ void insertNewCap(cte_t *parent, cte_t *slot, cap_t cap)
     cte_t *next;
 
     next = CTE_PTR(mdb_node_get_mdbNext(parent->cteMDBNode));
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+    capLookupCacheSlotChanged(cap);
+#endif
     slot->cap = cap;
     slot->cteMDBNode = mdb_node_new(CTE_REF(next), true, true, CTE_REF(parent));
     if (next) {
@@ -15,6 +15,69 @@
 #include <object/cnode.h>
 #include <object/endpoint.h>
 #include <object/tcb.h>
+#include <model/preemption.h>
+
+#ifdef CONFIG_ENDPOINT_BADGE_INDEX
+static inline badge_index_bucket_t *badgeIndexBucket(endpoint_t *epptr, word_t badge)
+{
+    return &ksBadgeIndex[(((word_t)epptr >> seL4_EndpointBits) ^ badge) & MASK(BADGE_INDEX_BITS)];
+}
+
+/* Add a thread that has just blocked sending on an endpoint to the end of the
+ * index bucket */
+static void badgeIndexInsert(tcb_t *thread, endpoint_t *epptr, word_t badge)
+{
+    badge_index_bucket_t *bucket;
+
+    if (badge == 0) {
+        return;
+    }
+
+    bucket = badgeIndexBucket(epptr, badge);
+    thread->tcbBadgePrev = bucket->tail;
+    thread->tcbBadgeNext = NULL;
+    if (bucket->tail) {
+        bucket->tail->tcbBadgeNext = thread;
+    } else {
+        bucket->head = thread;
+    }
+    bucket->tail = thread;
+
+    /* A cancel that has visited the whole bucket must still visit this thread */
+    if (bucket->cursorEP != NULL && bucket->cursor == NULL) {
+        bucket->cursor = thread;
+    }
+}
+
+/* Remove a thread that is blocked sending on an endpoint from the index */
+static void badgeIndexRemove(tcb_t *thread)
+{
+    word_t badge = thread_state_ptr_get_blockingIPCBadge(&thread->tcbState);
+    endpoint_t *epptr = EP_PTR(thread_state_ptr_get_blockingObject(&thread->tcbState));
+
+    assert(thread_state_ptr_get_tsType(&thread->tcbState) == ThreadState_BlockedOnSend);
+    if (badge == 0) {
+        return;
+    }
+
+    badge_index_bucket_t *bucket = badgeIndexBucket(epptr, badge);
+    if (bucket->cursor == thread) {
+        bucket->cursor = thread->tcbBadgeNext;
+    }
+    if (thread->tcbBadgePrev) {
+        thread->tcbBadgePrev->tcbBadgeNext = thread->tcbBadgeNext;
+    } else {
+        bucket->head = thread->tcbBadgeNext;
+    }
+    if (thread->tcbBadgeNext) {
+        thread->tcbBadgeNext->tcbBadgePrev = thread->tcbBadgePrev;
+    } else {
+        bucket->tail = thread->tcbBadgePrev;
+    }
+    thread->tcbBadgeNext = NULL;
+    thread->tcbBadgePrev = NULL;
+}
+#endif /* CONFIG_ENDPOINT_BADGE_INDEX */
 
 #ifdef CONFIG_KERNEL_MCS
 void sendIPC(bool_t blocking, bool_t do_call, word_t badge,
@@ -55,6 +118,9 @@ void sendIPC(bool_t blocking, bool_t do_call, word_t badge,
             endpoint_ptr_set_state(epptr, EPState_Send);
             ep_ptr_set_queue(epptr, queue);
 #endif /* CONFIG_KERNEL_MCS */
+#ifdef CONFIG_ENDPOINT_BADGE_INDEX
+            badgeIndexInsert(thread, epptr, badge);
+#endif
 
         }
         break;
@@ -226,6 +292,9 @@ void receiveIPC(tcb_t *thread, cap_t cap, bool_t isBlocking)
             assert(sender);
 
             /* Dequeue the first TCB */
+#ifdef CONFIG_ENDPOINT_BADGE_INDEX
+            badgeIndexRemove(sender);
+#endif
 #ifdef CONFIG_KERNEL_MCS
             tcbEPDequeue(sender, epptr);
 #else
@@ -345,6 +414,11 @@ void cancelIPC(tcb_t *tptr)
         assert(endpoint_ptr_get_state(epptr) != EPState_Idle);
 
         /* Dequeue TCB */
+#ifdef CONFIG_ENDPOINT_BADGE_INDEX
+        if (thread_state_ptr_get_tsType(state) == ThreadState_BlockedOnSend) {
+            badgeIndexRemove(tptr);
+        }
+#endif
 #ifdef CONFIG_KERNEL_MCS
         tcbEPDequeue(tptr, epptr);
 #else
@@ -423,6 +497,11 @@ static inline void restart_thread_if_no_fault(tcb_t *thread)
 
 static inline void removeAndRestartEPQueuedThread(tcb_t *thread, endpoint_t *epptr)
 {
+#ifdef CONFIG_ENDPOINT_BADGE_INDEX
+    if (thread_state_get_tsType(thread->tcbState) == ThreadState_BlockedOnSend) {
+        badgeIndexRemove(thread);
+    }
+#endif
     tcbEPDequeue(thread, epptr);
     if (thread_state_get_tsType(thread->tcbState) == ThreadState_BlockedOnReceive) {
         reply_t *reply = REPLY_PTR(thread_state_get_replyObject(thread->tcbState));
@@ -461,6 +540,11 @@ void cancelAllIPC(endpoint_t *epptr)
         endpoint_ptr_set_epQueue_tail(epptr, 0);
 
         for (; thread; thread = thread->tcbEPNext) {
+#ifdef CONFIG_ENDPOINT_BADGE_INDEX
+            if (thread_state_get_tsType(thread->tcbState) == ThreadState_BlockedOnSend) {
+                badgeIndexRemove(thread);
+            }
+#endif
             setThreadState(thread, ThreadState_Restart);
             SCHED_ENQUEUE(thread);
         }
@@ -486,6 +570,67 @@ static inline void removeAndRestartBadgedThread(tcb_t *thread, endpoint_t *epptr
 }
 #endif
 
+#ifdef CONFIG_ENDPOINT_BADGE_INDEX
+/* Only the senders in the index bucket of the badge are visited, so the cost
+ * is in the number of matching senders and hash collisions rather than the
+ * length of the send queue. Matching senders are restarted in the order they
+ * blocked. Cancelling is preemptible, including while skipping senders with
+ * other badges. The invocation is then restarted and continues from the
+ * bucket cursor, unless another badge of the bucket has been cancelled since. */
+exception_t cancelBadgedSends(endpoint_t *epptr, word_t badge)
+{
+    badge_index_bucket_t *bucket = badgeIndexBucket(epptr, badge);
+    tcb_t *thread;
+    exception_t status;
+
+    if (bucket->cursorEP != epptr || bucket->cursorBadge != badge) {
+        bucket->cursorEP = epptr;
+        bucket->cursorBadge = badge;
+        bucket->cursor = bucket->head;
+    }
+
+    while ((thread = bucket->cursor) != NULL) {
+        if (EP_PTR(thread_state_get_blockingObject(thread->tcbState)) != epptr ||
+            thread_state_get_blockingIPCBadge(thread->tcbState) != badge) {
+            bucket->cursor = thread->tcbBadgeNext;
+            status = preemptionPoint();
+            if (status != EXCEPTION_NONE) {
+                rescheduleRequired();
+                return status;
+            }
+            continue;
+        }
+
+        /* This moves the cursor past the thread */
+        badgeIndexRemove(thread);
+#ifdef CONFIG_KERNEL_MCS
+        tcbEPDequeue(thread, epptr);
+        restart_thread_if_no_fault(thread);
+#else
+        tcb_queue_t queue = ep_ptr_get_queue(epptr);
+        queue = tcbEPDequeue(thread, queue);
+        ep_ptr_set_queue(epptr, queue);
+
+        if (!queue.head) {
+            endpoint_ptr_set_state(epptr, EPState_Idle);
+        }
+
+        setThreadState(thread, ThreadState_Restart);
+        SCHED_ENQUEUE(thread);
+#endif /* CONFIG_KERNEL_MCS */
+
+        status = preemptionPoint();
+        if (status != EXCEPTION_NONE) {
+            rescheduleRequired();
+            return status;
+        }
+    }
+
+    bucket->cursorEP = NULL;
+    rescheduleRequired();
+    return EXCEPTION_NONE;
+}
+#else
 void cancelBadgedSends(endpoint_t *epptr, word_t badge)
 {
     switch (endpoint_ptr_get_state(epptr)) {
@@ -537,6 +682,7 @@ void cancelBadgedSends(endpoint_t *epptr, word_t badge)
         fail("invalid EP state");
     }
 }
+#endif /* CONFIG_ENDPOINT_BADGE_INDEX */
 
 #ifdef CONFIG_KERNEL_MCS
 void tcbEPAppend(tcb_t *thread, endpoint_t *epptr, endpoint_state_t ep_state)
@@ -558,6 +704,9 @@ void tcbEPDequeue(tcb_t *thread, endpoint_t *epptr)
     tcb_queue_t queue;
     tcb_queue_t new_queue;
 
+#ifdef CONFIG_IPC_QUEUE_PRIORITY_RUNS
+    tcbEPRunRemove(thread);
+#endif
     queue = ep_ptr_get_queue(epptr);
     new_queue = tcb_queue_remove(queue, thread);
     ep_ptr_set_queue(epptr, new_queue);
@@ -570,6 +719,9 @@ void tcbEPDequeue(tcb_t *thread, endpoint_t *epptr)
 void reorderEP(endpoint_t *epptr, tcb_t *thread)
 {
     tcb_queue_t queue = ep_ptr_get_queue(epptr);
+#ifdef CONFIG_IPC_QUEUE_PRIORITY_RUNS
+    tcbEPRunRemove(thread);
+#endif
     queue = tcb_queue_remove(queue, thread);
     queue = tcbAppend(thread, queue);
     ep_ptr_set_queue(epptr, queue);
@@ -400,6 +400,9 @@ void tcbNTFNDequeue(tcb_t *thread, notification_t *ntfnPtr)
     tcb_queue_t queue;
     tcb_queue_t new_queue;
 
+#ifdef CONFIG_IPC_QUEUE_PRIORITY_RUNS
+    tcbEPRunRemove(thread);
+#endif
     queue = ntfn_ptr_get_queue(ntfnPtr);
     new_queue = tcb_queue_remove(queue, thread);
     ntfn_ptr_set_queue(ntfnPtr, new_queue);
@@ -412,6 +415,9 @@ void tcbNTFNDequeue(tcb_t *thread, notification_t *ntfnPtr)
 void reorderNTFN(notification_t *ntfnPtr, tcb_t *thread)
 {
     tcb_queue_t queue = ntfn_ptr_get_queue(ntfnPtr);
+#ifdef CONFIG_IPC_QUEUE_PRIORITY_RUNS
+    tcbEPRunRemove(thread);
+#endif
     queue = tcb_queue_remove(queue, thread);
     queue = tcbAppend(thread, queue);
     ntfn_ptr_set_queue(ntfnPtr, queue);
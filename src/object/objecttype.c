@@ -22,6 +22,9 @@
 #include <object/schedcontrol.h>
 #endif
 #include <object/tcb.h>
+#ifdef CONFIG_LOG_BUFFER_PER_NODE
+#include <benchmark/benchmark.h>
+#endif
 #include <object/untyped.h>
 #include <model/statedata.h>
 #include <kernel/thread.h>
@@ -106,6 +109,11 @@ finaliseCap_ret_t finaliseCap(cap_t cap, bool_t final, bool_t exposed)
     finaliseCap_ret_t fc_ret;
 
     if (isArchCap(cap)) {
+#ifdef CONFIG_LOG_BUFFER_PER_NODE
+        if (final && cap_get_capType(cap) == cap_frame_cap) {
+            benchmark_release_log_buffer(cap_frame_cap_get_capFBasePtr(cap));
+        }
+#endif
         return Arch_finaliseCap(cap, final);
     }
 
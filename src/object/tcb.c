@@ -271,6 +271,97 @@ tcb_queue_t tcbEPDequeue(tcb_t *tcb, tcb_queue_t queue)
 
 #ifdef CONFIG_KERNEL_MCS
 
+static inline ticks_t PURE tcbReadyTime(tcb_t *tcb)
+{
+    return refill_head(tcb->tcbSchedContext)->rTime;
+}
+
+#ifdef CONFIG_RELEASE_QUEUE_HEAP
+/* The release queue is kept as a pairing heap ordered by ready time, with the
+ * root in ksReleaseQueue.head. Insertion is constant time and removal is
+ * amortised logarithmic. The end of the queue is not used. */
+
+/* Link two heap roots, returning the new root. On equal ready times the first
+ * argument stays the root, so that earlier insertions tend to be released first. */
+static tcb_t *release_heap_meld(tcb_t *a, tcb_t *b)
+{
+    if (tcbReadyTime(b) < tcbReadyTime(a)) {
+        tcb_t *tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    b->tcbSchedNext = a->tcbReleaseChild;
+    if (a->tcbReleaseChild) {
+        a->tcbReleaseChild->tcbSchedPrev = b;
+    }
+    b->tcbSchedPrev = a;
+    a->tcbReleaseChild = b;
+
+    return a;
+}
+
+/* Combine a list of siblings into a single heap with the standard two pass
+ * pairing, done iteratively to keep stack usage bounded. */
+static tcb_t *release_heap_merge_pairs(tcb_t *first)
+{
+    tcb_t *pairs = NULL;
+    tcb_t *root = NULL;
+
+    /* Meld siblings pairwise from the left, stacking the results. */
+    while (first) {
+        tcb_t *a = first;
+        tcb_t *b = a->tcbSchedNext;
+
+        first = b ? b->tcbSchedNext : NULL;
+        a->tcbSchedNext = NULL;
+        a->tcbSchedPrev = NULL;
+        if (b) {
+            b->tcbSchedNext = NULL;
+            b->tcbSchedPrev = NULL;
+            a = release_heap_meld(a, b);
+        }
+        a->tcbSchedNext = pairs;
+        pairs = a;
+    }
+
+    /* Meld the pairs from the right into a single heap. */
+    while (pairs) {
+        tcb_t *next = pairs->tcbSchedNext;
+
+        pairs->tcbSchedNext = NULL;
+        root = root ? release_heap_meld(root, pairs) : pairs;
+        pairs = next;
+    }
+
+    return root;
+}
+
+static tcb_t *release_heap_remove(tcb_t *root, tcb_t *tcb)
+{
+    tcb_t *children = tcb->tcbReleaseChild;
+
+    tcb->tcbReleaseChild = NULL;
+    if (tcb == root) {
+        return release_heap_merge_pairs(children);
+    }
+
+    /* Unlink the subtree of tcb from its parent or left sibling. */
+    if (tcb->tcbSchedPrev->tcbReleaseChild == tcb) {
+        tcb->tcbSchedPrev->tcbReleaseChild = tcb->tcbSchedNext;
+    } else {
+        tcb->tcbSchedPrev->tcbSchedNext = tcb->tcbSchedNext;
+    }
+    if (tcb->tcbSchedNext) {
+        tcb->tcbSchedNext->tcbSchedPrev = tcb->tcbSchedPrev;
+    }
+    tcb->tcbSchedNext = NULL;
+    tcb->tcbSchedPrev = NULL;
+
+    children = release_heap_merge_pairs(children);
+    return children ? release_heap_meld(root, children) : root;
+}
+
 void tcbReleaseRemove(tcb_t *tcb)
 {
     if (likely(thread_state_get_tcbInReleaseQueue(tcb->tcbState))) {
@@ -280,15 +371,50 @@ void tcbReleaseRemove(tcb_t *tcb)
             NODE_STATE_ON_CORE(ksReprogram, tcb->tcbAffinity) = true;
         }
 
-        NODE_STATE_ON_CORE(ksReleaseQueue, tcb->tcbAffinity) = tcb_queue_remove(queue, tcb);
+        NODE_STATE_ON_CORE(ksReleaseQueue, tcb->tcbAffinity).head = release_heap_remove(queue.head, tcb);
 
         thread_state_ptr_set_tcbInReleaseQueue(&tcb->tcbState, false);
     }
 }
 
-static inline ticks_t PURE tcbReadyTime(tcb_t *tcb)
+void tcbReleaseEnqueue(tcb_t *tcb)
 {
-    return refill_head(tcb->tcbSchedContext)->rTime;
+    assert(thread_state_get_tcbInReleaseQueue(tcb->tcbState) == false);
+    assert(thread_state_get_tcbQueued(tcb->tcbState) == false);
+
+    tcb_queue_t queue;
+
+    queue = NODE_STATE_ON_CORE(ksReleaseQueue, tcb->tcbAffinity);
+
+    tcb->tcbSchedNext = NULL;
+    tcb->tcbSchedPrev = NULL;
+    tcb->tcbReleaseChild = NULL;
+    if (tcb_queue_empty(queue)) {
+        NODE_STATE_ON_CORE(ksReleaseQueue, tcb->tcbAffinity).head = tcb;
+    } else {
+        NODE_STATE_ON_CORE(ksReleaseQueue, tcb->tcbAffinity).head = release_heap_meld(queue.head, tcb);
+    }
+
+    thread_state_ptr_set_tcbInReleaseQueue(&tcb->tcbState, true);
+
+    if (queue.head != NODE_STATE_ON_CORE(ksReleaseQueue, tcb->tcbAffinity).head) {
+        NODE_STATE_ON_CORE(ksReprogram, tcb->tcbAffinity) = true;
+    }
+}
+#else
+void tcbReleaseRemove(tcb_t *tcb)
+{
+    if (likely(thread_state_get_tcbInReleaseQueue(tcb->tcbState))) {
+        tcb_queue_t queue = NODE_STATE_ON_CORE(ksReleaseQueue, tcb->tcbAffinity);
+
+        if (queue.head == tcb) {
+            NODE_STATE_ON_CORE(ksReprogram, tcb->tcbAffinity) = true;
+        }
+
+        NODE_STATE_ON_CORE(ksReleaseQueue, tcb->tcbAffinity) = tcb_queue_remove(queue, tcb);
+
+        thread_state_ptr_set_tcbInReleaseQueue(&tcb->tcbState, false);
+    }
 }
 
 static inline bool_t PURE time_after(tcb_t *tcb, ticks_t new_time)
@@ -336,6 +462,7 @@ void tcbReleaseEnqueue(tcb_t *tcb)
         NODE_STATE_ON_CORE(ksReprogram, tcb->tcbAffinity) = true;
     }
 }
+#endif /* CONFIG_RELEASE_QUEUE_HEAP */
 #endif
 
 cptr_t PURE getExtraCPtr(word_t *bufferPtr, word_t i)
@@ -841,6 +968,24 @@ static exception_t decodeSetFlags(cap_t cap, word_t length, bool_t call, word_t
     return EXCEPTION_NONE;
 }
 
+#ifdef CONFIG_FAST_REVOKE
+static exception_t decodeGetRevokeProgress(cap_t cap, bool_t call)
+{
+    tcb_t *thread = TCB_PTR(cap_thread_cap_get_capTCBPtr(cap));
+    tcb_t *cur_thread = NODE_STATE(ksCurThread);
+
+    if (call) {
+        word_t *ipcBuffer = lookupIPCBuffer(true, cur_thread);
+        setRegister(cur_thread, badgeRegister, 0);
+        unsigned int length = setMR(cur_thread, ipcBuffer, 0, thread->tcbRevokeProgress);
+        setRegister(cur_thread, msgInfoRegister, wordFromMessageInfo(
+                        seL4_MessageInfo_new(0, 0, 0, length)));
+    }
+    setThreadState(cur_thread, ThreadState_Running);
+    return EXCEPTION_NONE;
+}
+#endif /* CONFIG_FAST_REVOKE */
+
 /* The following functions sit in the syscall error monad, but include the
  * exception cases for the preemptible bottom end, as they call the invoke
  * functions directly.  This is a significant deviation from the Haskell
@@ -937,6 +1082,11 @@ exception_t decodeTCBInvocation(word_t invLabel, word_t length, cap_t cap,
     case TCBSetFlags:
         return decodeSetFlags(cap, length, call, buffer);
 
+#ifdef CONFIG_FAST_REVOKE
+    case TCBGetRevokeProgress:
+        return decodeGetRevokeProgress(cap, call);
+#endif
+
     default:
         /* Haskell: "throw IllegalOperation" */
         userError("TCB: Illegal operation.");
@@ -1918,6 +2068,11 @@ exception_t invokeTCB_CopyRegisters(tcb_t *dest, tcb_t *tcb_src,
 
         pc = getRestartPC(dest);
         setNextPC(dest, pc);
+#ifdef CONFIG_FAST_REVOKE
+        /* A revoke the target was preempted in is not restarted */
+        dest->tcbRevokeProgress = 0;
+        dest->tcbRevokeSlot = NULL;
+#endif
     }
 
     if (transferInteger) {
@@ -2042,6 +2197,11 @@ exception_t invokeTCB_WriteRegisters(tcb_t *dest, bool_t resumeTarget,
 
     pc = getRestartPC(dest);
     setNextPC(dest, pc);
+#ifdef CONFIG_FAST_REVOKE
+    /* A revoke the target was preempted in is not restarted */
+    dest->tcbRevokeProgress = 0;
+    dest->tcbRevokeSlot = NULL;
+#endif
 
     Arch_postModifyRegisters(dest);
 
@@ -14,8 +14,12 @@
 #include <object/untyped.h>
 #include <object/objecttype.h>
 #include <object/cnode.h>
+#include <object/tcb.h>
 #include <kernel/cspace.h>
 #include <kernel/thread.h>
+#include <machine/interrupt.h>
+#include <model/statedata.h>
+#include <smp/lock.h>
 #include <util.h>
 
 static word_t alignUp(word_t baseValue, word_t alignment)
@@ -23,6 +27,179 @@ static word_t alignUp(word_t baseValue, word_t alignment)
     return (baseValue + (BIT(alignment) - 1)) & ~MASK(alignment);
 }
 
+#ifdef CONFIG_UNTYPED_BACKGROUND_RESET
+static word_t untypedResetQueueFind(cte_t *slot)
+{
+    word_t i;
+
+    for (i = 0; i < UNTYPED_RESET_QUEUE_SIZE; i++) {
+        if (ksUntypedResetQueue[i] == slot) {
+            break;
+        }
+    }
+    return i;
+}
+
+void untypedResetSwapSlots(cte_t *slot1, cte_t *slot2)
+{
+    for (word_t i = 0; i < UNTYPED_RESET_QUEUE_SIZE; i++) {
+        if (ksUntypedResetQueue[i] == slot1) {
+            ksUntypedResetQueue[i] = slot2;
+        } else if (ksUntypedResetQueue[i] == slot2) {
+            ksUntypedResetQueue[i] = slot1;
+        }
+    }
+}
+
+void untypedResetCancel(cte_t *slot)
+{
+    word_t i = untypedResetQueueFind(slot);
+
+    if (i < UNTYPED_RESET_QUEUE_SIZE) {
+        ksUntypedResetQueue[i] = NULL;
+    }
+}
+
+static void invokeUntyped_QueueReset(cte_t *slot, bool_t call)
+{
+    tcb_t *thread = NODE_STATE(ksCurThread);
+    word_t freeIndex = cap_untyped_cap_get_capFreeIndex(slot->cap);
+
+    /* Device memory is not cleared, so it can be reset right away */
+    if (cap_untyped_cap_get_capIsDevice(slot->cap)) {
+        freeIndex = 0;
+        slot->cap = cap_untyped_cap_set_capFreeIndex(slot->cap, 0);
+    } else if (freeIndex != 0 && untypedResetQueueFind(slot) == UNTYPED_RESET_QUEUE_SIZE) {
+        ksUntypedResetQueue[untypedResetQueueFind(NULL)] = slot;
+    }
+
+    if (call) {
+        word_t *ipcBuffer = lookupIPCBuffer(true, thread);
+        setRegister(thread, badgeRegister, 0);
+        unsigned int length = setMR(thread, ipcBuffer, 0, FREE_INDEX_TO_OFFSET(freeIndex));
+        setRegister(thread, msgInfoRegister, wordFromMessageInfo(
+                        seL4_MessageInfo_new(0, 0, 0, length)));
+    }
+    setThreadState(thread, ThreadState_Running);
+}
+
+static exception_t decodeUntypedQueueReset(cte_t *slot, bool_t call)
+{
+    cap_t cap = slot->cap;
+    exception_t status;
+
+    status = ensureNoChildren(slot);
+    if (status != EXCEPTION_NONE) {
+        userError("Untyped QueueReset: Untyped has children.");
+        current_syscall_error.type = seL4_RevokeFirst;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    if (!cap_untyped_cap_get_capIsDevice(cap) && cap_untyped_cap_get_capFreeIndex(cap) != 0
+        && untypedResetQueueFind(slot) == UNTYPED_RESET_QUEUE_SIZE
+        && untypedResetQueueFind(NULL) == UNTYPED_RESET_QUEUE_SIZE) {
+        userError("Untyped QueueReset: Reset queue is full.");
+        current_syscall_error.type = seL4_NotEnoughMemory;
+        current_syscall_error.memoryLeft = 0;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    invokeUntyped_QueueReset(slot, call);
+    return EXCEPTION_NONE;
+}
+
+static bool_t untypedBackgroundResetPreempted(void)
+{
+#ifdef ENABLE_SMP_SUPPORT
+    /* Do not keep other nodes waiting for the lock */
+    if (clh_is_lock_contended()) {
+        return true;
+    }
+#endif
+    return isIRQPending();
+}
+
+/* Clear queued untyped objects chunk by chunk from the top, like
+ * resetUntypedCap, until they are clear or there is an interrupt to handle.
+ * This is called before switching to the idle thread, so it only uses time
+ * that no thread on this node is ready to use. */
+void untypedBackgroundReset(void)
+{
+    word_t workUnits = 0;
+
+    for (word_t i = 0; i < UNTYPED_RESET_QUEUE_SIZE; i++) {
+        cte_t *slot = ksUntypedResetQueue[i];
+
+        if (slot == NULL) {
+            continue;
+        }
+
+        /* A copy of the cap made since it was queued is a child that may
+         * have been retyped, so its memory is no longer ours to clear. */
+        if (ensureNoChildren(slot) != EXCEPTION_NONE) {
+            ksUntypedResetQueue[i] = NULL;
+            continue;
+        }
+
+        word_t block_size = cap_untyped_cap_get_capBlockSize(slot->cap);
+        void *regionBase = WORD_PTR(cap_untyped_cap_get_capPtr(slot->cap));
+        word_t chunk = CONFIG_RESET_CHUNK_BITS;
+        word_t offset = FREE_INDEX_TO_OFFSET(cap_untyped_cap_get_capFreeIndex(slot->cap));
+
+        while (offset != 0) {
+            if (block_size < chunk) {
+                clearMemory(regionBase, block_size);
+                offset = 0;
+            } else {
+                offset = ROUND_DOWN(offset - 1, chunk);
+                clearMemory_NT(GET_OFFSET_FREE_PTR(regionBase, offset), chunk);
+            }
+            slot->cap = cap_untyped_cap_set_capFreeIndex(slot->cap, OFFSET_TO_FREE_INDEX(offset));
+
+            workUnits++;
+            if (workUnits >= CONFIG_MAX_NUM_WORK_UNITS_PER_PREEMPTION) {
+                workUnits = 0;
+                if (untypedBackgroundResetPreempted()) {
+                    return;
+                }
+            }
+        }
+
+        ksUntypedResetQueue[i] = NULL;
+    }
+}
+#endif /* CONFIG_UNTYPED_BACKGROUND_RESET */
+
+#ifdef CONFIG_BULK_RETYPE
+/* Return the number of objects already created if the current thread was
+ * preempted in this same bulk retype, or 0 to start a new one. */
+static word_t bulkRetypeResume(cte_t *parent, word_t type, word_t userSize,
+                               cte_t *window, word_t length)
+{
+    bulk_retype_t *saved = &NODE_STATE(ksCurThread)->tcbBulkRetype;
+    word_t done = saved->done;
+    cte_t *next;
+
+    if (saved->untyped != parent || saved->window != window || saved->type != type ||
+        saved->userSize != userSize || saved->length != length) {
+        return 0;
+    }
+    saved->untyped = NULL;
+
+    /* New caps are linked after the last created one, which is only possible
+     * if it is still a child of the untyped and has not been copied since. */
+    if (!isMDBParentOf(parent, &window[done - 1])) {
+        return 0;
+    }
+    next = CTE_PTR(mdb_node_get_mdbNext(window[done - 1].cteMDBNode));
+    if (next != NULL && isMDBParentOf(&window[done - 1], next)) {
+        return 0;
+    }
+    return done;
+}
+#endif /* CONFIG_BULK_RETYPE */
+
 exception_t decodeUntypedInvocation(word_t invLabel, word_t length, cte_t *slot,
                                     cap_t cap, bool_t call, word_t *buffer)
 {
@@ -39,6 +216,16 @@ exception_t decodeUntypedInvocation(word_t invLabel, word_t length, cte_t *slot,
     word_t freeIndex;
     bool_t deviceMemory;
     bool_t reset;
+#ifdef CONFIG_BULK_RETYPE
+    bool_t bulk;
+    word_t done = 0;
+#endif
+
+#ifdef CONFIG_UNTYPED_BACKGROUND_RESET
+    if (invLabel == UntypedQueueReset) {
+        return decodeUntypedQueueReset(slot, call);
+    }
+#endif
 
     /* Ensure operation is valid. */
     if (invLabel != UntypedRetype) {
@@ -141,6 +328,17 @@ exception_t decodeUntypedInvocation(word_t invLabel, word_t length, cte_t *slot,
         current_syscall_error.rangeErrorMax = nodeSize - 1;
         return EXCEPTION_SYSCALL_ERROR;
     }
+#ifdef CONFIG_BULK_RETYPE
+    /* Windows larger than the fan-out limit are created preemptibly */
+    if (nodeWindow < 1) {
+        userError("Untyped Retype: Number of requested objects (%d) too small.",
+                  (int)nodeWindow);
+        current_syscall_error.type = seL4_RangeError;
+        current_syscall_error.rangeErrorMin = 1;
+        current_syscall_error.rangeErrorMax = nodeSize - nodeOffset;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+#else
     if (nodeWindow < 1 || nodeWindow > CONFIG_RETYPE_FAN_OUT_LIMIT) {
         userError("Untyped Retype: Number of requested objects (%d) too small or large.",
                   (int)nodeWindow);
@@ -149,6 +347,7 @@ exception_t decodeUntypedInvocation(word_t invLabel, word_t length, cte_t *slot,
         current_syscall_error.rangeErrorMax = CONFIG_RETYPE_FAN_OUT_LIMIT;
         return EXCEPTION_SYSCALL_ERROR;
     }
+#endif
     if (nodeWindow > nodeSize - nodeOffset) {
         userError("Untyped Retype: Requested destination window overruns size of node.");
         current_syscall_error.type = seL4_RangeError;
@@ -157,9 +356,23 @@ exception_t decodeUntypedInvocation(word_t invLabel, word_t length, cte_t *slot,
         return EXCEPTION_SYSCALL_ERROR;
     }
 
-    /* Ensure that the destination slots are all empty. */
     destCNode = CTE_PTR(cap_cnode_cap_get_capCNodePtr(nodeCap));
+
+#ifdef CONFIG_BULK_RETYPE
+    /* A bulk retype that was preempted continues after the objects it has
+     * already created, and only their slots may be occupied. */
+    bulk = nodeWindow > CONFIG_RETYPE_FAN_OUT_LIMIT;
+    if (bulk) {
+        done = bulkRetypeResume(slot, newType, userObjSize, destCNode + nodeOffset, nodeWindow);
+    }
+#endif
+
+    /* Ensure that the destination slots are all empty. */
+#ifdef CONFIG_BULK_RETYPE
+    for (i = nodeOffset + done; i < nodeOffset + nodeWindow; i++) {
+#else
     for (i = nodeOffset; i < nodeOffset + nodeWindow; i++) {
+#endif
         status = ensureEmptySlot(destCNode + i);
         if (status != EXCEPTION_NONE) {
             userError("Untyped Retype: Slot #%d in destination window non-empty.",
@@ -200,7 +413,11 @@ exception_t decodeUntypedInvocation(word_t invLabel, word_t length, cte_t *slot,
     untypedFreeBytes = BIT(cap_untyped_cap_get_capBlockSize(cap)) -
                        FREE_INDEX_TO_OFFSET(freeIndex);
 
+#ifdef CONFIG_BULK_RETYPE
+    if ((untypedFreeBytes >> objectSize) < nodeWindow - done) {
+#else
     if ((untypedFreeBytes >> objectSize) < nodeWindow) {
+#endif
         userError("Untyped Retype: Insufficient memory "
                   "(%lu * %lu bytes needed, %lu bytes available).",
                   (word_t)nodeWindow,
@@ -226,6 +443,12 @@ exception_t decodeUntypedInvocation(word_t invLabel, word_t length, cte_t *slot,
 
     /* Perform the retype. */
     setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+#ifdef CONFIG_BULK_RETYPE
+    if (bulk) {
+        return invokeUntyped_RetypeBulk(slot, reset, (void *)alignedFreeRef, newType, userObjSize,
+                                        destCNode + nodeOffset, nodeWindow, done, deviceMemory);
+    }
+#endif
     return invokeUntyped_Retype(slot, reset,
                                 (void *)alignedFreeRef, newType, userObjSize,
                                 destCNode, nodeOffset, nodeWindow, deviceMemory);
@@ -258,7 +481,9 @@ static exception_t resetUntypedCap(cte_t *srcSlot)
     } else {
         for (offset = ROUND_DOWN(offset - 1, chunk);
              offset != - BIT(chunk); offset -= BIT(chunk)) {
-            clearMemory(GET_OFFSET_FREE_PTR(regionBase, offset), chunk);
+            /* Most of a large region is not used right away, so keep it
+             * out of the cache. */
+            clearMemory_NT(GET_OFFSET_FREE_PTR(regionBase, offset), chunk);
             srcSlot->cap = cap_untyped_cap_set_capFreeIndex(prev_cap, OFFSET_TO_FREE_INDEX(offset));
             status = preemptionPoint();
             if (status != EXCEPTION_NONE) {
@@ -285,6 +510,9 @@ exception_t invokeUntyped_Retype(cte_t *srcSlot,
         if (status != EXCEPTION_NONE) {
             return status;
         }
+#ifdef CONFIG_UNTYPED_BACKGROUND_RESET
+        untypedResetCancel(srcSlot);
+#endif
     }
 
     /* Update the amount of free space left in this untyped cap.
@@ -303,3 +531,59 @@ exception_t invokeUntyped_Retype(cte_t *srcSlot,
 
     return EXCEPTION_NONE;
 }
+
+#ifdef CONFIG_BULK_RETYPE
+exception_t invokeUntyped_RetypeBulk(cte_t *srcSlot,
+                                     bool_t reset, void *retypeBase,
+                                     object_t newType, word_t userSize,
+                                     cte_t *destSlots, word_t destLength, word_t done,
+                                     bool_t deviceMemory)
+{
+    word_t objectSize = getObjectSize(newType, userSize);
+    void *regionBase = WORD_PTR(cap_untyped_cap_get_capPtr(srcSlot->cap));
+    cte_t *insertAfter = done > 0 ? &destSlots[done - 1] : srcSlot;
+    exception_t status;
+
+    if (reset) {
+        status = resetUntypedCap(srcSlot);
+        if (status != EXCEPTION_NONE) {
+            return status;
+        }
+#ifdef CONFIG_UNTYPED_BACKGROUND_RESET
+        untypedResetCancel(srcSlot);
+#endif
+    }
+
+    /* The memory is already clear, so each object only needs its non-zero
+     * fields set up. The caps are linked in slot order after insertAfter, and
+     * the free index always covers the objects created so far. When
+     * preempted, the retype is recorded in the current thread so that it is
+     * continued when the invocation is restarted. */
+    for (word_t i = done; i < destLength; i++) {
+        void *object = (void *)((word_t)retypeBase + ((i - done) << objectSize));
+        cap_t cap;
+
+        srcSlot->cap = cap_untyped_cap_set_capFreeIndex(srcSlot->cap,
+                                                        GET_FREE_INDEX(regionBase, (word_t)object + BIT(objectSize)));
+        cap = createObject(newType, object, userSize, deviceMemory);
+        insertNewCap(insertAfter, &destSlots[i], cap);
+        insertAfter = &destSlots[i];
+
+        if (i + 1 < destLength) {
+            status = preemptionPoint();
+            if (status != EXCEPTION_NONE) {
+                bulk_retype_t *saved = &NODE_STATE(ksCurThread)->tcbBulkRetype;
+                saved->untyped = srcSlot;
+                saved->window = destSlots;
+                saved->type = newType;
+                saved->userSize = userSize;
+                saved->length = destLength;
+                saved->done = i + 1;
+                return status;
+            }
+        }
+    }
+
+    return EXCEPTION_NONE;
+}
+#endif /* CONFIG_BULK_RETYPE */
@@ -42,6 +42,18 @@ enum acpi_table_dmar_struct_type {
     DMAR_ATSR = 2,
 };
 
+/* DMA Remapping Hardware unit Definition flags */
+#define DMAR_DRHD_INCLUDE_PCI_ALL BIT(0)
+
+/* Device Scope Types */
+enum acpi_table_dmar_devscope_type {
+    DMAR_DEVSCOPE_PCI_ENDPOINT = 1,
+    DMAR_DEVSCOPE_PCI_SUB_HIERARCHY = 2,
+    DMAR_DEVSCOPE_IOAPIC = 3,
+    DMAR_DEVSCOPE_HPET = 4,
+    DMAR_DEVSCOPE_ACPI_NAMESPACE = 5,
+};
+
 /* DMA Remapping Hardware unit Definition */
 typedef struct acpi_dmar_drhd {
     acpi_dmar_header_t header;
@@ -464,7 +476,8 @@ BOOT_CODE void acpi_dmar_scan(
     paddr_t     *drhu_list,
     uint32_t    *num_drhu,
     uint32_t     max_drhu_list_len,
-    acpi_rmrr_list_t *rmrr_list
+    acpi_rmrr_list_t *rmrr_list,
+    acpi_drhd_list_t *drhd_list
 )
 {
     word_t i;
@@ -473,9 +486,11 @@ BOOT_CODE void acpi_dmar_scan(
     uint32_t reg_basel, reg_baseh;
     int rmrr_count;
     dev_id_t dev_id;
+    bool_t drhd_scopes_known = true;
 
     acpi_dmar_t          *acpi_dmar;
     acpi_dmar_header_t   *acpi_dmar_header;
+    acpi_dmar_drhd_t     *acpi_dmar_drhd;
     acpi_dmar_rmrr_t     *acpi_dmar_rmrr;
     acpi_dmar_devscope_t *acpi_dmar_devscope;
 
@@ -486,6 +501,8 @@ BOOT_CODE void acpi_dmar_scan(
 
     *num_drhu = 0;
     rmrr_count = 0;
+    drhd_list->num = 0;
+    drhd_list->include_all = -1;
 
     assert(acpi_rsdt_mapped->header.length >= sizeof(acpi_header_t));
     entries = (acpi_rsdt_mapped->header.length - sizeof(acpi_header_t)) / sizeof(uint32_t);
@@ -519,6 +536,42 @@ BOOT_CODE void acpi_dmar_scan(
                         return;
                     }
                     drhu_list[*num_drhu] = (paddr_t)reg_basel;
+
+                    /* record which PCI devices this IOMMU translates, so that
+                     * invalidations only go to the IOMMU of a device */
+                    acpi_dmar_drhd = (acpi_dmar_drhd_t *)acpi_dmar_header;
+                    if (acpi_dmar_drhd->flags & DMAR_DRHD_INCLUDE_PCI_ALL) {
+                        drhd_list->include_all = *num_drhu;
+                    } else {
+                        acpi_dmar_devscope = (acpi_dmar_devscope_t *)(acpi_dmar_drhd + 1);
+                        while ((char *)acpi_dmar_devscope < (char *)acpi_dmar_header + acpi_dmar_header->length) {
+                            if (acpi_dmar_devscope->length < sizeof(acpi_dmar_devscope_t)) {
+                                drhd_scopes_known = false;
+                                break;
+                            }
+                            if (acpi_dmar_devscope->type == DMAR_DEVSCOPE_IOAPIC ||
+                                acpi_dmar_devscope->type == DMAR_DEVSCOPE_HPET) {
+                                /* only relevant for interrupt remapping */
+                            } else if (acpi_dmar_devscope->type != DMAR_DEVSCOPE_PCI_ENDPOINT ||
+                                       acpi_dmar_devscope->length > sizeof(acpi_dmar_devscope_t) ||
+                                       drhd_list->num == CONFIG_MAX_DRHD_SCOPE_ENTRIES) {
+                                /* devices behind bridges or beyond the recorded
+                                 * entries are not known */
+                                drhd_scopes_known = false;
+                            } else {
+                                drhd_list->entries[drhd_list->num].device =
+                                    get_dev_id(
+                                        acpi_dmar_devscope->start_bus,
+                                        acpi_dmar_devscope->path_0.dev,
+                                        acpi_dmar_devscope->path_0.fun
+                                    );
+                                drhd_list->entries[drhd_list->num].drhu = *num_drhu;
+                                drhd_list->num++;
+                            }
+                            acpi_dmar_devscope = (acpi_dmar_devscope_t *)((char *)acpi_dmar_devscope +
+                                                                          acpi_dmar_devscope->length);
+                        }
+                    }
                     (*num_drhu)++;
                     break;
 
@@ -586,5 +639,9 @@ BOOT_CODE void acpi_dmar_scan(
         }
     }
     rmrr_list->num = rmrr_count;
+    if (!drhd_scopes_known) {
+        printf("ACPI: IOMMU device scopes not fully recorded, invalidating all IOMMUs\n");
+        drhd_list->include_all = -1;
+    }
     printf("ACPI: %d IOMMUs detected\n", *num_drhu);
 }
@@ -30,6 +30,9 @@
 #define FEADDR_REG  0x40
 #define FEUADDR_REG 0x44
 #define CAP_REG     0x08
+#define IQT_REG     0x88
+#define IQA_REG     0x90
+#define IVA_REG     0x00 /* relative to the IOTLB register offset */
 
 /* Bit Positions within Registers */
 #define SRTP        30  /* Set Root Table Pointer */
@@ -72,6 +75,14 @@
 #define WBFS        27
 #define DID         8
 #define RW          0x3
+#define PSI         (39 - 32) /* Page Selective Invalidation, high word of CAP_REG */
+#define SLLPS       (34 - 32) /* Second Level Large Page Support, high word of CAP_REG */
+#define SLLPS_MASK  0xf
+#define MAMV        (48 - 32) /* Maximum Address Mask Value, high word of CAP_REG */
+#define MAMV_MASK   0x3f
+#define QI          1   /* Queued Invalidation support, in ECAP_REG */
+#define QIE         26  /* Queued Invalidation Enable */
+#define QIES        26  /* Queued Invalidation Enable Status */
 
 #define SAGAW         8
 #define SAGAW_2_LEVEL 0x01
@@ -82,14 +93,32 @@
 
 #define CONTEXT_GLOBAL_INVALIDATE 0x1
 #define IOTLB_GLOBAL_INVALIDATE   0x1
+#define IOTLB_DOMAIN_INVALIDATE   0x2
+#define IOTLB_PAGE_INVALIDATE     0x3
 
 #define DMA_TLB_READ_DRAIN  BIT(17)
 #define DMA_TLB_WRITE_DRAIN BIT(16)
 
+/* Invalidation queue descriptors */
+#define INV_DESC_SIZE_BITS  4
+#define INV_QUEUE_LEN       BIT(PAGE_BITS - INV_DESC_SIZE_BITS) /* one page, QS = 0 */
+#define INV_DESC_IOTLB      0x2
+#define INV_DESC_WAIT       0x5
+#define INV_DESC_GRAN       4   /* Granularity */
+#define INV_DESC_DW         BIT(6) /* Drain Writes */
+#define INV_DESC_DR         BIT(7) /* Drain Reads */
+#define INV_DESC_DID        16
+#define INV_WAIT_SW         BIT(5) /* Status Write */
+#define INV_WAIT_FN         BIT(6) /* Fence */
+#define INV_WAIT_DATA       32
+
 #define N_VTD_CONTEXTS 256
 
 typedef uint32_t drhu_id_t;
 
+/* The IOMMU of a device is not known, so all IOMMUs need to be invalidated */
+#define DRHU_ALL ((drhu_id_t) -1)
+
 static inline uint32_t vtd_read32(drhu_id_t drhu_id, uint32_t offset)
 {
     return *(volatile uint32_t *)(PPTR_DRHU_START + (drhu_id << PAGE_BITS) + offset);
@@ -160,43 +189,133 @@ void invalidate_context_cache(void)
     }
 }
 
-void invalidate_iotlb(void)
+static drhu_id_t vtd_get_drhu(uint32_t pci_request_id)
 {
-    /* FIXME - bugzilla bug 172
-     * 1. Instead of assuming global invalidation, this function should
-     *    accept a parameter to control the granularity of invalidation
-     *    request.
-     * 2. Instead of doing invalidation for all the IOMMUs, it should
-     *    only do it for the IOMMU responsible for the requesting PCI
-     *    device.
-     */
+    for (int i = 0; i < x86KSvtdDrhdList.num; i++) {
+        if (x86KSvtdDrhdList.entries[i].device == pci_request_id) {
+            return x86KSvtdDrhdList.entries[i].drhu;
+        }
+    }
 
-    uint8_t   invalidate_command = IOTLB_GLOBAL_INVALIDATE;
-    uint32_t  iotlb_reg_upper;
-    uint32_t  ivo_offset;
-    drhu_id_t i;
+    if (x86KSvtdDrhdList.include_all < 0) {
+        return DRHU_ALL;
+    }
+    return x86KSvtdDrhdList.include_all;
+}
 
-    for (i = 0; i < x86KSnumDrhu; i++) {
-        ivo_offset = get_ivo(i);
+static void vtd_register_invalidate_iotlb(drhu_id_t i, uint32_t granularity, uint16_t domain_id, word_t io_address,
+                                          word_t address_mask)
+{
+    uint32_t iotlb_reg_upper;
+    uint32_t ivo_offset = get_ivo(i);
 
-        /* Wait till IVT bit is clear */
-        while ((vtd_read32(i, ivo_offset + IOTLB_REG + 4) >> IVT) & 1);
+    /* Wait till IVT bit is clear */
+    while ((vtd_read32(i, ivo_offset + IOTLB_REG + 4) >> IVT) & 1);
 
-        /* Program IIRG for Global Invalidation by setting bit 60 which
-         * will be bit 28 in upper 32 bits of IOTLB_REG
-         */
-        iotlb_reg_upper = invalidate_command << IIRG;
+    if (granularity == IOTLB_PAGE_INVALIDATE) {
+        /* Invalidate the 2^address_mask pages starting at io_address */
+        vtd_write64(i, ivo_offset + IVA_REG, (io_address & ~MASK(PAGE_BITS)) | address_mask);
+    }
 
-        /* Invalidate IOTLB */
-        iotlb_reg_upper |= BIT(IVT);
-        iotlb_reg_upper |= DMA_TLB_READ_DRAIN | DMA_TLB_WRITE_DRAIN;
+    /* Program IIRG, which is at bit 60 and so becomes bit 28 in the
+     * upper 32 bits of IOTLB_REG, and the domain ID in bits 47 to 32 */
+    iotlb_reg_upper = granularity << IIRG;
+    iotlb_reg_upper |= domain_id;
 
-        vtd_write32(i, ivo_offset + IOTLB_REG, 0);
-        vtd_write32(i, ivo_offset + IOTLB_REG + 4, iotlb_reg_upper);
+    /* Invalidate IOTLB */
+    iotlb_reg_upper |= BIT(IVT);
+    iotlb_reg_upper |= DMA_TLB_READ_DRAIN | DMA_TLB_WRITE_DRAIN;
 
-        /* Wait for the invalidation to complete */
-        while ((vtd_read32(i, ivo_offset + IOTLB_REG + 4) >> IVT) & 1);
+    vtd_write32(i, ivo_offset + IOTLB_REG, 0);
+    vtd_write32(i, ivo_offset + IOTLB_REG + 4, iotlb_reg_upper);
+
+    /* Wait for the invalidation to complete */
+    while ((vtd_read32(i, ivo_offset + IOTLB_REG + 4) >> IVT) & 1);
+}
+
+static void vtd_queue_submit(drhu_id_t i, uint64_t lo, uint64_t hi)
+{
+    vtd_inv_queue_t *queue = &x86KSvtdInvQueues[i];
+    vtd_inv_desc_t *desc = &queue->desc[queue->tail];
+
+    desc->lo = lo;
+    desc->hi = hi;
+    flushCacheRange(desc, INV_DESC_SIZE_BITS);
+    queue->tail = (queue->tail + 1) % INV_QUEUE_LEN;
+}
+
+/* Queue a wait descriptor behind all previously queued descriptors and hand
+ * the queue to the IOMMU. Completion is observed with vtd_queue_wait. */
+static void vtd_queue_flush(drhu_id_t i)
+{
+    vtd_inv_queue_t *queue = &x86KSvtdInvQueues[i];
+
+    queue->status = 0;
+    vtd_queue_submit(i,
+                     INV_DESC_WAIT | INV_WAIT_SW | INV_WAIT_FN | ((uint64_t)1 << INV_WAIT_DATA),
+                     pptr_to_paddr((void *)&queue->status));
+    vtd_write64(i, IQT_REG, queue->tail << INV_DESC_SIZE_BITS);
+}
+
+static void vtd_queue_wait(drhu_id_t i)
+{
+    while (x86KSvtdInvQueues[i].status == 0);
+}
+
+static void vtd_invalidate_iotlb(drhu_id_t drhu_id, uint32_t granularity, uint16_t domain_id, word_t io_address,
+                                 word_t address_mask)
+{
+    drhu_id_t first = drhu_id;
+    drhu_id_t end = drhu_id + 1;
+    drhu_id_t i;
+
+    if (drhu_id == DRHU_ALL) {
+        first = 0;
+        end = x86KSnumDrhu;
     }
+
+    for (i = first; i < end; i++) {
+        uint32_t i_granularity = granularity;
+        if (granularity == IOTLB_PAGE_INVALIDATE &&
+            (!((vtd_read32(i, CAP_REG + 4) >> PSI) & 1) ||
+             ((vtd_read32(i, CAP_REG + 4) >> MAMV) & MAMV_MASK) < address_mask)) {
+            i_granularity = IOTLB_DOMAIN_INVALIDATE;
+        }
+
+        if (x86KSvtdInvQueues == NULL) {
+            vtd_register_invalidate_iotlb(i, i_granularity, domain_id, io_address, address_mask);
+        } else {
+            vtd_queue_submit(i,
+                             INV_DESC_IOTLB | (i_granularity << INV_DESC_GRAN) | INV_DESC_DW | INV_DESC_DR |
+                             ((uint64_t)domain_id << INV_DESC_DID),
+                             i_granularity == IOTLB_PAGE_INVALIDATE ?
+                             (io_address & ~MASK(PAGE_BITS)) | address_mask : 0);
+            vtd_queue_flush(i);
+        }
+    }
+
+    /* All IOMMUs work on their queues in parallel */
+    if (x86KSvtdInvQueues != NULL) {
+        for (i = first; i < end; i++) {
+            vtd_queue_wait(i);
+        }
+    }
+}
+
+void invalidate_iotlb(void)
+{
+    vtd_invalidate_iotlb(DRHU_ALL, IOTLB_GLOBAL_INVALIDATE, 0, 0, 0);
+}
+
+void invalidate_iotlb_domain(uint32_t pci_request_id, uint16_t domain_id)
+{
+    vtd_invalidate_iotlb(vtd_get_drhu(pci_request_id), IOTLB_DOMAIN_INVALIDATE, domain_id, 0, 0);
+}
+
+void invalidate_iotlb_page(uint32_t pci_request_id, uint16_t domain_id, word_t io_address, word_t page_bits)
+{
+    vtd_invalidate_iotlb(vtd_get_drhu(pci_request_id), IOTLB_PAGE_INVALIDATE, domain_id, io_address,
+                         page_bits - PAGE_BITS);
 }
 
 static void vtd_clear_fault(drhu_id_t i, word_t fr_reg)
@@ -265,6 +384,21 @@ void vtd_handle_fault(void)
     }
 }
 
+BOOT_CODE static bool_t vtd_queued_invalidation_supported(void)
+{
+    if (!config_set(CONFIG_IOMMU_QUEUED_INVALIDATION) ||
+        x86KSnumDrhu > BIT(seL4_PageTableBits) / sizeof(vtd_inv_queue_t)) {
+        return false;
+    }
+
+    for (drhu_id_t i = 0; i < x86KSnumDrhu; i++) {
+        if (!((vtd_read32(i, ECAP_REG) >> QI) & 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 BOOT_CODE word_t vtd_get_n_paging(acpi_rmrr_list_t *rmrr_list)
 {
     if (x86KSnumDrhu == 0) {
@@ -276,6 +410,11 @@ BOOT_CODE word_t vtd_get_n_paging(acpi_rmrr_list_t *rmrr_list)
     size += N_VTD_CONTEXTS; /* one for each context */
     size += rmrr_list->num; /* one for each device */
 
+    if (vtd_queued_invalidation_supported()) {
+        size += 1; /* one for the queue bookkeeping */
+        size += x86KSnumDrhu; /* one for each invalidation queue */
+    }
+
     if (rmrr_list->num == 0) {
         return size;
     }
@@ -352,14 +491,14 @@ BOOT_CODE static void vtd_map_reserved_page(vtd_cte_t *vtd_context_table, int co
         vtd_pte_slot = iopt + iopt_index;
         if (i == 0) {
             /* Now put the mapping in */
-            *vtd_pte_slot = vtd_pte_new(addr, 1, 1);
+            *vtd_pte_slot = vtd_pte_new(addr, 0, 1, 1);
             flushCacheRange(vtd_pte_slot, VTD_PTE_SIZE_BITS);
         } else {
             if (!vtd_pte_ptr_get_write(vtd_pte_slot)) {
                 iopt = (vtd_pte_t *) it_alloc_paging();
                 flushCacheRange(iopt, seL4_IOPageTableBits);
 
-                *vtd_pte_slot = vtd_pte_new(pptr_to_paddr(iopt), 1, 1);
+                *vtd_pte_slot = vtd_pte_new(pptr_to_paddr(iopt), 0, 1, 1);
                 flushCacheRange(vtd_pte_slot, VTD_PTE_SIZE_BITS);
             } else {
                 iopt = (vtd_pte_t *)paddr_to_pptr(vtd_pte_ptr_get_addr(vtd_pte_slot));
@@ -392,6 +531,37 @@ BOOT_CODE static void vtd_create_context_table(uint8_t bus, acpi_rmrr_list_t *rm
     }
 }
 
+BOOT_CODE static void vtd_enable_queued_invalidation(void)
+{
+    drhu_id_t i;
+    uint32_t status;
+
+    if (!vtd_queued_invalidation_supported()) {
+        return;
+    }
+
+    x86KSvtdInvQueues = (vtd_inv_queue_t *) it_alloc_paging();
+    for (i = 0; i < x86KSnumDrhu; i++) {
+        x86KSvtdInvQueues[i].desc = (vtd_inv_desc_t *) it_alloc_paging();
+        x86KSvtdInvQueues[i].tail = 0;
+
+        /* Set the queue address, a queue size of 0 is one page */
+        vtd_write64(i, IQT_REG, 0);
+        vtd_write64(i, IQA_REG, pptr_to_paddr(x86KSvtdInvQueues[i].desc));
+
+        status = vtd_read32(i, GSTS_REG);
+        status |= BIT(QIE);
+        /* Enable queued invalidation by setting QIE bit in GCMD_REG */
+        vtd_write32(i, GCMD_REG, status);
+
+        /* Wait for queued invalidation to be enabled by polling
+         * QIES bit from GSTS_REG
+         */
+        while (!((vtd_read32(i, GSTS_REG) >> QIES) & 1));
+    }
+    printf("IOMMU: using queued invalidation\n");
+}
+
 BOOT_CODE static bool_t vtd_enable(cpu_id_t cpu_id)
 {
     drhu_id_t i;
@@ -419,6 +589,10 @@ BOOT_CODE static bool_t vtd_enable(cpu_id_t cpu_id)
     /* Globally invalidate IOTLB of all IOMMUs */
     invalidate_iotlb();
 
+    /* Register based invalidation is not allowed from here on if the
+     * invalidation queues are used */
+    vtd_enable_queued_invalidation();
+
     for (i = 0; i < x86KSnumDrhu; i++) {
         uint32_t data, addr;
 
@@ -467,11 +641,13 @@ BOOT_CODE bool_t vtd_init_num_iopts(uint32_t num_drhu)
     }
 
     uint32_t aw_bitmask = 0xffffffff;
+    uint32_t sllps_bitmask = SLLPS_MASK;
     /* Start the number of domains at 16 bits */
     uint32_t  num_domain_id_bits = 16;
     for (drhu_id_t i = 0; i < x86KSnumDrhu; i++) {
         uint32_t bits_supported = 4 + 2 * (vtd_read32(i, CAP_REG) & 7);
         aw_bitmask &= vtd_read32(i, CAP_REG) >> SAGAW;
+        sllps_bitmask &= vtd_read32(i, CAP_REG + 4) >> SLLPS;
         printf("IOMMU 0x%x: %d-bit domain IDs supported\n", i, bits_supported);
         if (bits_supported < num_domain_id_bits) {
             num_domain_id_bits = bits_supported;
@@ -511,16 +687,27 @@ BOOT_CODE bool_t vtd_init_num_iopts(uint32_t num_drhu)
     }
 
     printf("IOMMU: Using %d page-table levels (max. supported: %d)\n", x86KSnumIOPTLevels, max_num_iopt_levels);
+
+    /* Bit n of SLLPS is set if pages can be mapped n + 1 levels above the last
+     * level, which is only used if the smaller sizes are supported as well */
+    x86KSnumIOSuperPageLevels = 0;
+    while (x86KSnumIOSuperPageLevels < x86KSnumIOPTLevels - 1 &&
+           (sllps_bitmask & BIT(x86KSnumIOSuperPageLevels))) {
+        x86KSnumIOSuperPageLevels++;
+    }
+    printf("IOMMU: Using %d large page levels\n", x86KSnumIOSuperPageLevels);
     return true;
 }
 
 
-BOOT_CODE bool_t vtd_init(cpu_id_t  cpu_id, acpi_rmrr_list_t *rmrr_list)
+BOOT_CODE bool_t vtd_init(cpu_id_t  cpu_id, acpi_rmrr_list_t *rmrr_list, acpi_drhd_list_t *drhd_list)
 {
     if (x86KSnumDrhu == 0) {
         return true;
     }
 
+    x86KSvtdDrhdList = *drhd_list;
+
     x86KSvtdRootTable = (vtd_rte_t *) it_alloc_paging();
     for (uint32_t bus = 0; bus < N_VTD_CONTEXTS; bus++) {
         vtd_create_context_table(bus, rmrr_list);
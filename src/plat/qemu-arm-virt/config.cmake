@@ -79,6 +79,17 @@ if(KernelPlatformQEMUArmVirt)
     set(KernelArmGicV3 ON)
   endif()
 
+  # QEMU emulates an SMMUv3 in front of the PCIe host bridge if the machine is
+  # created with 'iommu=smmuv3'. Stream IDs are PCI requester IDs.
+  if(QEMU_SMMU_VERSION EQUAL 3)
+    if(NOT KernelSel4ArchAarch64)
+      message(FATAL_ERROR "QEMU_SMMU_VERSION 3 requires AARCH64")
+    endif()
+    set(KernelArmSMMUv3 ON)
+  else()
+    set(KernelArmSMMUv3 OFF)
+  endif()
+
   # If neither QEMU_DTS nor QEMU_DTB is set explicitly, the device tree is
   # extracted from QEMU. This keeps it nicely up to date with the the actual
   # QEMU versions that is used, and it's quite convenient for development.
@@ -122,6 +133,9 @@ if(KernelPlatformQEMUArmVirt)
           list(APPEND QEMU_MACHINE "highmem=off")
         endif()
         list(APPEND QEMU_MACHINE "gic-version=${QEMU_GIC_VERSION}")
+        if(QEMU_SMMU_VERSION EQUAL 3)
+          list(APPEND QEMU_MACHINE "iommu=smmuv3")
+        endif()
         list(APPEND QEMU_MACHINE "dumpdtb=${QEMU_DTB}")
 
         # Lists are just strings with ";" as item separator, so we can
@@ -223,9 +237,14 @@ if(KernelPlatformQEMUArmVirt)
     set(GicHeader arch/machine/gic_v2.h)
   endif()
 
+  if(QEMU_SMMU_VERSION EQUAL 3)
+    set(SmmuHeaders SMMU drivers/smmu/smmuv3.h MAX_SID 256 MAX_CB 64)
+  endif()
+
   declare_default_headers(
     TIMER_FREQUENCY 62500000 MAX_IRQ 159 NUM_PPI 32 TIMER drivers/timer/arm_generic.h
-    INTERRUPT_CONTROLLER ${GicHeader} CLK_MAGIC 4611686019llu CLK_SHIFT 58u KERNEL_WCET 10u)
+    INTERRUPT_CONTROLLER ${GicHeader} CLK_MAGIC 4611686019llu CLK_SHIFT 58u KERNEL_WCET 10u
+    ${SmmuHeaders})
 
 endif()
 
@@ -127,6 +127,10 @@ void handleIPI(irq_t irq, bool_t irqPath)
         rescheduleRequired();
 #ifdef CONFIG_ARCH_RISCV
         ifence_local();
+#endif
+#ifdef CONFIG_ARM_VCPU_INJECT_FASTPATH
+    } else if (IRQT_TO_IRQ(irq) == irq_vcpu_inject_ipi) {
+        handleVCPUInjectPendingIPI();
 #endif
     } else {
         fail("Invalid IPI");
@@ -13,6 +13,28 @@ compile_assert(BKL_not_padded, sizeof(big_kernel_lock) % EXCL_RES_GRANULE_SIZE =
 
 clh_lock_t big_kernel_lock;
 
+#ifdef CONFIG_FINE_GRAINED_LOCKING
+object_lock_t object_locks[BIT(OBJECT_LOCK_STRIPE_BITS)];
+#endif
+
+#ifdef CONFIG_BENCHMARK_LOCK_CONTENTION
+clh_lock_stats_t clh_lock_stats[CONFIG_MAX_NUM_NODES];
+
+void clh_lock_stats_reset(void)
+{
+    for (int i = 0; i < CONFIG_MAX_NUM_NODES; i++) {
+        clh_lock_stats_t *stats = &clh_lock_stats[i];
+        for (int j = 0; j < BENCHMARK_LOCK_NUM_ENTRY_TYPES; j++) {
+            stats->acquisitions[j] = 0;
+            stats->wait_cycles[j] = 0;
+            stats->hold_cycles[j] = 0;
+        }
+        stats->ipis = 0;
+        stats->ipi_cycles = 0;
+    }
+}
+#endif /* CONFIG_BENCHMARK_LOCK_CONTENTION */
+
 BOOT_CODE void clh_lock_init(void)
 {
     /* Check if linker honoured alignment */
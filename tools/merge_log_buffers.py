@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+#
+# Copyright 2026, UNSW
+#
+# SPDX-License-Identifier: GPL-2.0-only
+#
+
+# Merge the kernel log buffers of several nodes into a single log sorted by
+# start time, for kernels built with KernelLogBufferPerNode.
+#
+# Each input is a binary dump of the log buffer of one node, given in node
+# order. An input may be followed by ':<count>' to only read the first <count>
+# entries, as returned for that node by seL4_BenchmarkFinalizeLog. The merged
+# log is written as CSV to standard output.
+#
+# Timestamps are only comparable between nodes if the cycle counters of all
+# nodes are synchronised, which is the case for the generic timer on Arm, the
+# invariant TSC on x86 and the time CSR on RISC-V.
+
+from __future__ import annotations
+
+import argparse
+import heapq
+import struct
+import sys
+from typing import Iterator
+
+
+# struct benchmark_tracepoint_log_entry: id, duration, start_time
+def tracepoint_format(word_size: int) -> tuple[str, list[str]]:
+    word = 'Q' if word_size == 8 else 'I'
+    return ('<' + word + word + 'Q', ['id', 'duration', 'start_time'])
+
+
+# struct benchmark_syscall_log_entry: start_time, duration, entry
+def kernel_entry_format(word_size: int) -> tuple[str, list[str]]:
+    return ('<QII', ['start_time', 'duration', 'entry'])
+
+
+FORMATS = {
+    'tracepoints': tracepoint_format,
+    'kernel_entries': kernel_entry_format,
+}
+
+ENTRY_PATHS = ['Unknown', 'Interrupt', 'UnknownSyscall', 'UserLevelFault',
+               'DebugFault', 'VMFault', 'Syscall', 'ArchFault']
+
+
+def read_log(path: str, count: int | None, fmt: str, fields: list[str],
+             node: int) -> Iterator[dict]:
+    size = struct.calcsize(fmt)
+    with open(path, 'rb') as f:
+        data = f.read()
+    available = len(data) // size
+    if count is None:
+        count = available
+    elif count > available:
+        print('%s: only %d of %d entries present, log buffer overflowed?' %
+              (path, available, count), file=sys.stderr)
+        count = available
+    for i in range(count):
+        entry = dict(zip(fields, struct.unpack_from(fmt, data, i * size)))
+        entry['node'] = node
+        yield entry
+
+
+def format_entry(entry: dict, log_format: str) -> str:
+    if log_format == 'tracepoints':
+        return '%d,%d,%d,%d' % (entry['start_time'], entry['node'],
+                                entry['duration'], entry['id'])
+    path = entry['entry'] & 0x7
+    return '%d,%d,%d,%s,0x%x' % (entry['start_time'], entry['node'],
+                                 entry['duration'], ENTRY_PATHS[path], entry['entry'] >> 3)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(
+        description='Merge per-node kernel log buffers by start time.')
+    parser.add_argument('--format', choices=FORMATS.keys(), required=True,
+                        help='The kernel benchmark mode that wrote the logs.')
+    parser.add_argument('--word-size', type=int, choices=[4, 8], default=8,
+                        help='The size of seL4_Word in bytes.')
+    parser.add_argument('logs', nargs='+', metavar='FILE[:COUNT]',
+                        help='The log buffer of each node, in node order.')
+    args = parser.parse_args()
+
+    fmt, fields = FORMATS[args.format](args.word_size)
+    logs = []
+    for node, log in enumerate(args.logs):
+        path, sep, count = log.rpartition(':')
+        if not sep or not count.isdigit():
+            path, count = log, None
+        else:
+            count = int(count)
+        # Each log is in order of completion, so sort it before merging
+        logs.append(sorted(read_log(path, count, fmt, fields, node),
+                           key=lambda e: e['start_time']))
+
+    if args.format == 'tracepoints':
+        print('start_time,node,duration,id')
+    else:
+        print('start_time,node,duration,path,info')
+    for entry in heapq.merge(*logs, key=lambda e: e['start_time']):
+        print(format_entry(entry, args.format))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())